@@ -1,4 +1,5 @@
 #include <rtthread.h>
+#include <rthw.h>
 #include <dfs_posix.h>
 
 #ifdef RT_USING_MP3_DECODE
@@ -8,12 +9,20 @@
 #include "board.h"
 #include "netbuffer.h"
 #include "codec_wm8978_i2c.h"
+#include "mp3.h"
+#include "mp3_index.h"
 
 #define MP3_AUDIO_BUF_SZ    (5 * 1024)
 #ifndef MIN
 #define MIN(x, y)			((x) < (y)? (x) : (y))
 #endif
 
+/* samples of decoder delay, the LAME encoder delay doesn't count it */
+#define MP3_DECODER_DELAY	529
+#define MP3_SAMPLES_UNLIMITED	0xffffffff
+/* open the next file of playlist when the bytes left in this one are less than it */
+#define MP3_PREOPEN_BYTES	(2 * MP3_AUDIO_BUF_SZ)
+
 rt_uint8_t mp3_fd_buffer[MP3_AUDIO_BUF_SZ];
 int current_sample_rate = 0;
 
@@ -26,23 +35,43 @@ struct mp3_decoder
 
     /* mp3 file descriptor */
 	rt_size_t (*fetch_data)(void* parameter, rt_uint8_t *buffer, rt_size_t length);
+	/* seek the data source to offset, RT_NULL for a stream */
+	int (*seek_data)(void* parameter, rt_uint32_t offset);
 	void* fetch_parameter;
 
+	/* seek index of a local file */
+	struct mp3_index* index;
+
+	/* gapless playback, in samples of one channel */
+	rt_uint32_t skip_samples;
+	rt_uint32_t samples_left;
+
     /* mp3 read session */
     rt_uint8_t *read_buffer, *read_ptr;
     rt_int32_t  read_offset;
     rt_uint32_t bytes_left, bytes_left_before_decoding;
+	/* no more data from source, the frames left in buffer are decoded */
+	rt_bool_t eof;
 
 	/* audio device */
 	rt_device_t snd_device;
 };
 
-static rt_err_t mp3_decoder_tx_done(rt_device_t dev, void *buffer)
+/* the slots of PCM ring in sound device, the frames decoded ahead */
+static rt_uint16_t _pcm_ring_depth = MP3_RING_DEPTH_DEFAULT;
+
+void mp3_set_ring_depth(int depth)
 {
-	/* release memory block */
-	sbuf_release(buffer);
+	if (depth < CODEC_PCM_SLOTS_MIN) depth = CODEC_PCM_SLOTS_MIN;
+	if (depth > MP3_RING_DEPTH_MAX) depth = MP3_RING_DEPTH_MAX;
 
-	return RT_EOK;
+	/* take effect on the next decoder */
+	_pcm_ring_depth = depth;
+}
+
+int mp3_get_ring_depth(void)
+{
+	return _pcm_ring_depth;
 }
 
 void mp3_decoder_init(struct mp3_decoder* decoder)
@@ -52,7 +81,12 @@ void mp3_decoder_init(struct mp3_decoder* decoder)
 	/* init read session */
 	decoder->read_ptr = RT_NULL;
 	decoder->bytes_left_before_decoding = decoder->bytes_left = 0;
+	decoder->eof = RT_FALSE;
 	decoder->frames = 0;
+	decoder->seek_data = RT_NULL;
+	decoder->index = RT_NULL;
+	decoder->skip_samples = 0;
+	decoder->samples_left = MP3_SAMPLES_UNLIMITED;
 
     // decoder->read_buffer = rt_malloc(MP3_AUDIO_BUF_SZ);
     decoder->read_buffer = &mp3_fd_buffer[0];
@@ -60,13 +94,16 @@ void mp3_decoder_init(struct mp3_decoder* decoder)
 
     decoder->decoder = MP3InitDecoder();
 
+	/* decode mono into stereo PCM slots of sound device directly */
+	MP3SetStereoOutput(decoder->decoder, 1);
+
 	/* open audio device */
 	decoder->snd_device = rt_device_find("snd");
 	if (decoder->snd_device != RT_NULL)
 	{
-		/* set tx complete call back function */
-		rt_device_set_tx_complete(decoder->snd_device, mp3_decoder_tx_done);
-		rt_device_open(decoder->snd_device, RT_DEVICE_OFLAG_WRONLY);
+		rt_device_control(decoder->snd_device, CODEC_CMD_PCM_SLOTS, &_pcm_ring_depth);
+		if (rt_device_open(decoder->snd_device, RT_DEVICE_OFLAG_WRONLY) != RT_EOK)
+			decoder->snd_device = RT_NULL;
 	}
 }
 
@@ -75,6 +112,7 @@ void mp3_decoder_detach(struct mp3_decoder* decoder)
     RT_ASSERT(decoder != RT_NULL);
 
 	/* close audio device */
+	/* the data in PCM ring is played out */
 	if (decoder->snd_device != RT_NULL)
 		rt_device_close(decoder->snd_device);
 
@@ -107,6 +145,7 @@ void mp3_decoder_delete(struct mp3_decoder* decoder)
 }
 
 rt_uint32_t current_offset = 0;
+static void mp3_decoder_sync_end(struct mp3_decoder* decoder);
 static rt_int32_t mp3_decoder_fill_buffer(struct mp3_decoder* decoder)
 {
 	rt_size_t bytes_read;
@@ -134,25 +173,151 @@ static rt_int32_t mp3_decoder_fill_buffer(struct mp3_decoder* decoder)
 	}
 	else
 	{
+		decoder->eof = RT_TRUE;
+
+		/* decode the frames left in buffer */
+		if (decoder->bytes_left > 0)
+		{
+			decoder->read_ptr = decoder->read_buffer;
+			decoder->read_offset = 0;
+			mp3_decoder_sync_end(decoder);
+			return 0;
+		}
+
 		rt_kprintf("can't read more data\n");
 		return -1;
 	}
 }
 
+/* set the samples to skip and to play from frame, by the encoder delay and padding */
+static void mp3_decoder_set_gapless(struct mp3_decoder* decoder, rt_uint32_t frame)
+{
+	struct mp3_index* index = decoder->index;
+	rt_uint32_t delay, total, valid, position;
+
+	decoder->skip_samples = 0;
+	decoder->samples_left = MP3_SAMPLES_UNLIMITED;
+	if (index == RT_NULL || index->gapless == RT_FALSE || index->frames == 0)
+		return;
+
+	delay = index->enc_delay + MP3_DECODER_DELAY;
+	total = index->frames * index->frame_samples;
+	if (total <= delay)
+		return;
+
+	/* the padding may be shorter than the decoder delay */
+	valid = total - delay;
+	if (index->enc_padding > MP3_DECODER_DELAY)
+		valid -= index->enc_padding - MP3_DECODER_DELAY;
+
+	position = frame * index->frame_samples;
+	if (position < delay)
+	{
+		decoder->skip_samples = delay - position;
+		decoder->samples_left = valid;
+	}
+	else if (position - delay < valid)
+		decoder->samples_left = valid - (position - delay);
+	else
+		decoder->samples_left = 0;
+}
+
+/*
+ * correct the frame position by the frames left in buffer at the end of file.
+ * The position after a seek by Xing/VBRI TOC is approximate, and the padding
+ * at the end is only dropped exactly with the right position.
+ */
+static void mp3_decoder_sync_end(struct mp3_decoder* decoder)
+{
+	struct mp3_index* index = decoder->index;
+	rt_uint32_t frames;
+
+	if (index == RT_NULL || index->gapless == RT_FALSE || decoder->skip_samples > 0)
+		return;
+
+	frames = mp3_index_count_frames(decoder->decoder, decoder->read_ptr, decoder->bytes_left);
+	if (frames == 0 || frames > index->frames)
+		return;
+
+	decoder->frames = index->frames - frames;
+	mp3_decoder_set_gapless(decoder, decoder->frames);
+}
+
+/* a frame decodes to nothing, its samples are counted as played */
+static void mp3_decoder_drop_frame(struct mp3_decoder* decoder)
+{
+	rt_uint32_t samples, skip;
+
+	if (decoder->index == RT_NULL || decoder->samples_left == MP3_SAMPLES_UNLIMITED)
+		return;
+
+	samples = decoder->index->frame_samples;
+	skip = MIN(decoder->skip_samples, samples);
+	decoder->skip_samples -= skip;
+	samples -= skip;
+	decoder->samples_left -= MIN(samples, decoder->samples_left);
+}
+
+/*
+ * seek to the point of index nearest before ms, return the time of the
+ * point in ms, or -1 if the source can't seek.
+ */
+int mp3_decoder_seek(struct mp3_decoder* decoder, rt_uint32_t ms)
+{
+	rt_uint32_t offset, frame;
+
+	RT_ASSERT(decoder != RT_NULL);
+
+	if (decoder->index == RT_NULL || decoder->index->count == 0 || decoder->seek_data == RT_NULL)
+		return -1;
+
+	offset = mp3_index_lookup(decoder->index, ms, &frame);
+	if (decoder->seek_data(decoder->fetch_parameter, offset) != 0)
+		return -1;
+
+	/*
+	 * drop the data read ahead and the bit reservoir of the old position. The
+	 * first frames after the point refer to main data before it, they fail as
+	 * ERR_MP3_MAINDATA_UNDERFLOW and are not played.
+	 */
+	MP3ResetDecoder(decoder->decoder);
+	decoder->read_ptr = RT_NULL;
+	decoder->bytes_left_before_decoding = decoder->bytes_left = 0;
+	decoder->eof = RT_FALSE;
+	decoder->frames = frame;
+	current_offset = offset;
+	mp3_decoder_set_gapless(decoder, frame);
+
+	return (rt_uint32_t)((unsigned long long)frame * decoder->index->frame_samples * 1000 /
+		decoder->index->samprate);
+}
+
 int mp3_decoder_run(struct mp3_decoder* decoder)
 {
 	int err;
-	rt_uint16_t* buffer;
 	rt_uint32_t  delta;
+	struct codec_pcm_slot slot;
+	MP3FrameInfo next_info;
 
     RT_ASSERT(decoder != RT_NULL);
 
-	if ((decoder->read_ptr == RT_NULL) || decoder->bytes_left < 2*MAINBUF_SIZE)
+	if (decoder->snd_device == RT_NULL)
+	{
+		rt_kprintf("no sound device\n");
+		return -1;
+	}
+
+	if ((decoder->read_ptr == RT_NULL) ||
+		(decoder->bytes_left < 2*MAINBUF_SIZE && decoder->eof == RT_FALSE))
 	{
 		if(mp3_decoder_fill_buffer(decoder) != 0)
 			return -1;
 	}
 
+	/* all the frames of source are decoded */
+	if (decoder->bytes_left == 0)
+		return -1;
+
 	// rt_kprintf("read offset: 0x%08x\n", decoder->read_ptr - decoder->read_buffer);
 	decoder->read_offset = MP3FindSyncWord(decoder->read_ptr, decoder->bytes_left);
 	if (decoder->read_offset < 0)
@@ -167,19 +332,36 @@ int mp3_decoder_run(struct mp3_decoder* decoder)
 	decoder->read_ptr += decoder->read_offset;
 	delta = decoder->read_offset;
 	decoder->bytes_left -= decoder->read_offset;
-	if (decoder->bytes_left < 1024)
+	if (decoder->bytes_left < 1024 && decoder->eof == RT_FALSE)
 	{
 		/* fill more data */
 		if(mp3_decoder_fill_buffer(decoder) != 0)
 			return -1;
 	}
 
-    /* get a decoder buffer */
-    buffer = (rt_uint16_t*)sbuf_alloc();
+	/* get a slot of PCM ring as large as the stereo output of this frame,
+	 * wait when the ring is full */
+	slot.size = CODEC_PCM_SLOT_SIZE;
+	if (MP3GetNextFrameInfo(decoder->decoder, &next_info, decoder->read_ptr) == ERR_MP3_NONE)
+	{
+		slot.size = next_info.outputSamps * sizeof(rt_uint16_t);
+
+		/* set sample rate only when it changes, the PCM of old rate is played out first */
+		if (next_info.samprate != current_sample_rate)
+		{
+			rt_device_control(decoder->snd_device, CODEC_CMD_PCM_DRAIN, RT_NULL);
+			current_sample_rate = next_info.samprate;
+			rt_device_control(decoder->snd_device, CODEC_CMD_SAMPLERATE, &current_sample_rate);
+		}
+	}
+	slot.timeout = RT_WAITING_FOREVER;
+	if (rt_device_control(decoder->snd_device, CODEC_CMD_PCM_RESERVE, &slot) != RT_EOK)
+		return -1;
+
 	decoder->bytes_left_before_decoding = decoder->bytes_left;
 
 	err = MP3Decode(decoder->decoder, &decoder->read_ptr,
-        (int*)&decoder->bytes_left, (short*)buffer, 0);
+        (int*)&decoder->bytes_left, (short*)slot.data, 0);
 	delta += (decoder->bytes_left_before_decoding - decoder->bytes_left);
 
 	current_offset += delta;
@@ -191,19 +373,22 @@ int mp3_decoder_run(struct mp3_decoder* decoder)
 		switch (err)
 		{
 		case ERR_MP3_INDATA_UNDERFLOW:
+			/* the last frame of source is truncated */
+			if (decoder->eof == RT_TRUE)
+				return -1;
+
 			rt_kprintf("ERR_MP3_INDATA_UNDERFLOW\n");
 			decoder->bytes_left = 0;
 			if(mp3_decoder_fill_buffer(decoder) != 0)
-			{
-				/* release this memory block */
-				sbuf_release(buffer);
 				return -1;
-			}
 			break;
 
 		case ERR_MP3_MAINDATA_UNDERFLOW:
-			/* do nothing - next call to decode will provide more mainData */
+			/* next call to decode will provide more mainData, e.g. after seek */
 			rt_kprintf("ERR_MP3_MAINDATA_UNDERFLOW\n");
+			mp3_decoder_drop_frame(decoder);
+			if (decoder->samples_left == 0)
+				return -1;
 			break;
 
 		default:
@@ -223,44 +408,40 @@ int mp3_decoder_run(struct mp3_decoder* decoder)
 			break;
 		}
 
-		/* release this memory block */
-		sbuf_release(buffer);
+		/* the reserved slot is not committed */
 	}
 	else
 	{
-		int outputSamps;
+		rt_uint32_t samples, skip;
 		/* no error */
 		MP3GetLastFrameInfo(decoder->decoder, &decoder->frame_info);
 
-        /* set sample rate */
-		if (decoder->frame_info.samprate != current_sample_rate)
+		/* drop the encoder delay and padding, mono is decoded as stereo */
+		samples = decoder->frame_info.outputSamps / 2;
+		if (decoder->skip_samples > 0)
 		{
-			current_sample_rate = decoder->frame_info.samprate;
-			rt_device_control(decoder->snd_device, CODEC_CMD_SAMPLERATE, &current_sample_rate);
+			skip = MIN(decoder->skip_samples, samples);
+			decoder->skip_samples -= skip;
+			samples -= skip;
+			if (samples > 0)
+				rt_memmove(slot.data, slot.data + skip * 2, samples * 2 * sizeof(rt_uint16_t));
 		}
-
-		/* write to sound device */
-		outputSamps = decoder->frame_info.outputSamps;
-		if (outputSamps > 0)
+		if (decoder->samples_left != MP3_SAMPLES_UNLIMITED)
 		{
-			if (decoder->frame_info.nChans == 1)
-			{
-				int i;
-				for (i = outputSamps - 1; i >= 0; i--)
-				{
-					buffer[i * 2] = buffer[i];
-					buffer[i * 2 + 1] = buffer[i];
-				}
-				outputSamps *= 2;
-			}
-
-			rt_device_write(decoder->snd_device, 0, buffer, outputSamps * sizeof(rt_uint16_t));
+			samples = MIN(samples, decoder->samples_left);
+			decoder->samples_left -= samples;
 		}
-		else
+
+		/* commit the PCM to sound device */
+		if (samples > 0)
 		{
-			/* no output */
-			sbuf_release(buffer);
+			slot.size = samples * 2 * sizeof(rt_uint16_t);
+			rt_device_control(decoder->snd_device, CODEC_CMD_PCM_COMMIT, &slot);
 		}
+
+		/* the end of gapless stream */
+		if (decoder->samples_left == 0)
+			return -1;
 	}
 
 	return 0;
@@ -278,30 +459,431 @@ rt_size_t fd_fetch(void* parameter, rt_uint8_t *buffer, rt_size_t length)
 	return read_bytes;
 }
 
-void mp3(char* filename)
+int fd_seek(void* parameter, rt_uint32_t offset)
+{
+	int fd = (int)parameter;
+
+	if (lseek(fd, offset, SEEK_SET) != offset) return -1;
+
+	return 0;
+}
+
+/* a local mp3 file, opened and buffered ahead of playing */
+struct mp3_file
 {
 	int fd;
+	struct mp3_index* index;
+
+	/* the data read ahead from the first audio frame */
+	rt_uint8_t buffer[MP3_AUDIO_BUF_SZ];
+	rt_uint32_t bytes;
+};
+
+static struct mp3_file* mp3_file_open(const char* filename, HMP3Decoder decoder, rt_bool_t scan)
+{
+	struct mp3_file* file;
+	int length;
+
+	file = (struct mp3_file*) rt_malloc(sizeof(struct mp3_file));
+	if (file == RT_NULL)
+		return RT_NULL;
+
+	file->fd = open(filename, O_RDONLY, 0);
+	if (file->fd < 0)
+	{
+		rt_free(file);
+		return RT_NULL;
+	}
+
+	/* the index is built on the decoder between two frames of playing */
+	file->index = mp3_index_create(filename, decoder, scan);
+	if (file->index == RT_NULL || fd_seek((void*)file->fd, file->index->audio_start) != 0)
+		goto __error;
+
+	length = read(file->fd, (char*)file->buffer, MP3_AUDIO_BUF_SZ & ~(512 - 1));
+	file->bytes = (length > 0)? length : 0;
+
+	return file;
+
+__error:
+	if (file->index != RT_NULL)
+		mp3_index_delete(file->index);
+	close(file->fd);
+	rt_free(file);
+
+	return RT_NULL;
+}
+
+static void mp3_file_close(struct mp3_file* file)
+{
+	mp3_index_delete(file->index);
+	close(file->fd);
+	rt_free(file);
+}
+
+/*
+ * play file on the decoder from its first audio frame. The decoder state of
+ * last stream is cleared, and the sound device keeps playing.
+ */
+static void mp3_decoder_switch(struct mp3_decoder* decoder, struct mp3_file* file)
+{
+	MP3ResetDecoder(decoder->decoder);
+
+	rt_memcpy(decoder->read_buffer, file->buffer, file->bytes);
+	decoder->read_ptr = decoder->read_buffer;
+	decoder->read_offset = 0;
+	decoder->bytes_left_before_decoding = decoder->bytes_left = file->bytes;
+	decoder->eof = RT_FALSE;
+	decoder->frames = 0;
+
+	decoder->fetch_data = fd_fetch;
+	decoder->seek_data = fd_seek;
+	decoder->fetch_parameter = (void*)file->fd;
+	decoder->index = file->index;
+
+	current_offset = file->index->audio_start;
+	mp3_decoder_set_gapless(decoder, 0);
+}
+
+/* the position in ms requested by mp3_seek, -1 if there is no request */
+static rt_int32_t _seek_request = -1;
+
+/*
+ * seek the file being played by mp3_from or playlist to ms, it's called in
+ * another thread (e.g. UI) and done by the playing thread between two frames.
+ */
+void mp3_seek(rt_uint32_t ms)
+{
+	_seek_request = ms;
+}
+
+static void mp3_decoder_seek_request(struct mp3_decoder* decoder)
+{
+	rt_base_t level;
+	rt_int32_t ms;
+
+	if (_seek_request < 0)
+		return;
+
+	level = rt_hw_interrupt_disable();
+	ms = _seek_request;
+	_seek_request = -1;
+	rt_hw_interrupt_enable(level);
+
+	if (mp3_decoder_seek(decoder, ms) < 0)
+		rt_kprintf("can't seek to %d ms\n", ms);
+}
+
+/* play a local file from ms */
+void mp3_from(char* filename, rt_uint32_t ms)
+{
 	struct mp3_decoder* decoder;
+	struct mp3_file* file;
 
-	fd = open(filename, O_RDONLY, 0);
-	if (fd >= 0)
+	decoder = mp3_decoder_create();
+	if (decoder != RT_NULL)
+	{
+		file = mp3_file_open(filename, decoder->decoder, RT_TRUE);
+		if (file != RT_NULL)
+		{
+			mp3_decoder_switch(decoder, file);
+			if (ms > 0)
+				mp3_decoder_seek(decoder, ms);
+
+			_seek_request = -1;
+			while (mp3_decoder_run(decoder) != -1)
+				mp3_decoder_seek_request(decoder);
+
+			decoder->index = RT_NULL;
+			mp3_file_close(file);
+		}
+
+		/* delete decoder object */
+		mp3_decoder_delete(decoder);
+	}
+}
+
+/*
+ * playlist of local files. They are played on one decoder and sound device
+ * without gap: the next file is opened and buffered before this one ends,
+ * and the encoder delay and padding in LAME tag are dropped.
+ */
+static char* _playlist[MP3_PLAYLIST_MAX];
+static rt_uint16_t _playlist_count = 0;
+
+int mp3_playlist_add(const char* filename)
+{
+	if (_playlist_count >= MP3_PLAYLIST_MAX)
+		return -1;
+
+	_playlist[_playlist_count] = rt_strdup(filename);
+	if (_playlist[_playlist_count] == RT_NULL)
+		return -1;
+	_playlist_count ++;
+
+	return 0;
+}
+
+void mp3_playlist_clear(void)
+{
+	while (_playlist_count > 0)
 	{
-		decoder = mp3_decoder_create();
-		if (decoder != RT_NULL)
+		_playlist_count --;
+		rt_free(_playlist[_playlist_count]);
+	}
+}
+
+void mp3_playlist_play(void)
+{
+	struct mp3_decoder* decoder;
+	struct mp3_file *file, *next;
+	rt_bool_t next_opened;
+	int index;
+
+	decoder = mp3_decoder_create();
+	if (decoder == RT_NULL)
+		return;
+
+	next = RT_NULL;
+	next_opened = RT_FALSE;
+	for (index = 0; index < _playlist_count; index ++)
+	{
+		/* the file is not scanned for seek points, a scan would stop the sound */
+		if (next_opened == RT_TRUE) file = next;
+		else file = mp3_file_open(_playlist[index], decoder->decoder, RT_FALSE);
+		next = RT_NULL;
+		next_opened = RT_FALSE;
+
+		if (file == RT_NULL)
 		{
-			decoder->fetch_data = fd_fetch;
-			decoder->fetch_parameter = (void*)fd;
+			rt_kprintf("can't play %s\n", _playlist[index]);
+			continue;
+		}
 
-			current_offset = 0;
-			while (mp3_decoder_run(decoder) != -1);
+		mp3_decoder_switch(decoder, file);
+		_seek_request = -1;
+		while (mp3_decoder_run(decoder) != -1)
+		{
+			/* the file is seekable only if it has a Xing/VBRI TOC or a cached index */
+			mp3_decoder_seek_request(decoder);
 
-			/* delete decoder object */
-			mp3_decoder_delete(decoder);
+			/* open and buffer the next file when this one is about to end */
+			if (next_opened == RT_FALSE && index + 1 < _playlist_count &&
+				current_offset + MP3_PREOPEN_BYTES >= file->index->file_size)
+			{
+				next = mp3_file_open(_playlist[index + 1], decoder->decoder, RT_FALSE);
+				next_opened = RT_TRUE;
+			}
 		}
-		close(fd);
+
+		decoder->index = RT_NULL;
+		mp3_file_close(file);
 	}
+
+	/* delete decoder object, the last file is played out */
+	mp3_decoder_delete(decoder);
+}
+
+void mp3(char* filename)
+{
+	mp3_from(filename, 0);
 }
 FINSH_FUNCTION_EXPORT(mp3, mp3 decode test);
+FINSH_FUNCTION_EXPORT(mp3_from, mp3 decode test from a time in ms);
+FINSH_FUNCTION_EXPORT(mp3_seek, seek the playing mp3 file to a time in ms);
+FINSH_FUNCTION_EXPORT(mp3_set_ring_depth, set the frames decoded ahead of sound output);
+FINSH_FUNCTION_EXPORT(mp3_playlist_add, add a mp3 file to playlist);
+FINSH_FUNCTION_EXPORT(mp3_playlist_clear, clear playlist);
+FINSH_FUNCTION_EXPORT(mp3_playlist_play, play the files of playlist without gap);
+
+/*
+ * decode a whole mp3 file as fast as possible without the sound device,
+ * check the PCM output against a golden file (raw 16-bit PCM, the samples
+ * as MP3Decode outputs them) when it's given, and print the result as one
+ * line of JSON. Build the decoder with RT_MP3_PROFILE to get the cycles of
+ * each decoding stage.
+ */
+static const char* mp3_stage_name[MP3_NSTAGES] =
+{
+	"header", "scalefact", "huffman", "dequant", "imdct", "subband"
+};
+
+void mp3_bench(const char* filename, const char* golden)
+{
+	int fd, golden_fd;
+	int err, index;
+	int bytes_left, frame_bytes;
+	rt_uint8_t *read_buffer, *read_ptr;
+	short *pcm, *ref;
+	HMP3Decoder decoder;
+	MP3FrameInfo frame_info;
+	MP3ProfileInfo profile;
+	rt_uint32_t frames, errors, mismatches, first_mismatch;
+	rt_uint32_t samples, bytes, tick;
+	unsigned long long total;
+	rt_bool_t eof;
+
+	fd = open(filename, O_RDONLY, 0);
+	if (fd < 0)
+	{
+		rt_kprintf("{\"file\":\"%s\",\"error\":\"open failed\"}\n", filename);
+		return;
+	}
+
+	golden_fd = -1;
+	if (golden != RT_NULL && golden[0] != '\0')
+	{
+		golden_fd = open(golden, O_RDONLY, 0);
+		if (golden_fd < 0)
+		{
+			rt_kprintf("{\"file\":\"%s\",\"error\":\"open golden failed\"}\n", filename);
+			close(fd);
+			return;
+		}
+	}
+
+	frame_bytes = MAX_NGRAN * MAX_NCHAN * MAX_NSAMP * sizeof(short);
+	read_buffer = (rt_uint8_t*) rt_malloc(MP3_AUDIO_BUF_SZ);
+	pcm = (short*) rt_malloc(frame_bytes);
+	ref = (short*) rt_malloc(frame_bytes);
+	decoder = MP3InitDecoder();
+	if (read_buffer == RT_NULL || pcm == RT_NULL || ref == RT_NULL || decoder == 0)
+	{
+		rt_kprintf("{\"file\":\"%s\",\"error\":\"out of memory\"}\n", filename);
+		goto __exit;
+	}
+
+#ifdef RT_MP3_PROFILE
+	/* enable the DWT cycle counter used by the decoder profiling */
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+
+	frames = errors = mismatches = samples = bytes = 0;
+	first_mismatch = 0;
+	rt_memset(&frame_info, 0, sizeof(frame_info));
+	read_ptr = read_buffer;
+	bytes_left = 0;
+	eof = RT_FALSE;
+	tick = rt_tick_get();
+	while (1)
+	{
+		int offset, read_bytes;
+
+		/* keep at least two main data buffers in the read buffer */
+		if (bytes_left < 2 * MAINBUF_SIZE && eof == RT_FALSE)
+		{
+			rt_memmove(read_buffer, read_ptr, bytes_left);
+			read_ptr = read_buffer;
+			read_bytes = read(fd, (char*)read_buffer + bytes_left,
+				(MP3_AUDIO_BUF_SZ - bytes_left) & ~(512 - 1));
+			if (read_bytes > 0) bytes_left += read_bytes;
+			else eof = RT_TRUE;
+		}
+		if (bytes_left == 0) break;
+
+		offset = MP3FindSyncWord(read_ptr, bytes_left);
+		if (offset < 0)
+		{
+			if (eof == RT_TRUE) break;
+
+			/* keep the last byte, it may be the first byte of a sync word */
+			read_ptr += bytes_left - 1;
+			bytes_left = 1;
+			continue;
+		}
+		else if (offset > 0)
+		{
+			/* skip the garbage and refill the read buffer */
+			read_ptr += offset;
+			bytes_left -= offset;
+			continue;
+		}
+
+		read_bytes = bytes_left;
+		err = MP3Decode(decoder, &read_ptr, &bytes_left, pcm, 0);
+		bytes += read_bytes - bytes_left;
+		if (err == ERR_MP3_INDATA_UNDERFLOW)
+		{
+			/* the last frame is truncated */
+			break;
+		}
+		else if (err != ERR_MP3_NONE)
+		{
+			errors ++;
+			if (err != ERR_MP3_MAINDATA_UNDERFLOW && bytes_left > 0)
+			{
+				/* skip this frame */
+				bytes_left --;
+				read_ptr ++;
+			}
+			continue;
+		}
+
+		MP3GetLastFrameInfo(decoder, &frame_info);
+		frames ++;
+		samples += frame_info.outputSamps / frame_info.nChans;
+
+		if (golden_fd >= 0)
+		{
+			read_bytes = frame_info.outputSamps * sizeof(short);
+			if (read(golden_fd, (char*)ref, read_bytes) != read_bytes ||
+				memcmp(pcm, ref, read_bytes) != 0)
+			{
+				if (mismatches == 0) first_mismatch = frames;
+				mismatches ++;
+			}
+		}
+	}
+	tick = rt_tick_get() - tick;
+
+	/* the golden file must not have more samples than decoded */
+	if (golden_fd >= 0 && read(golden_fd, (char*)ref, sizeof(short)) > 0)
+	{
+		if (mismatches == 0) first_mismatch = frames + 1;
+		mismatches ++;
+	}
+
+	rt_kprintf("{\"file\":\"%s\",\"frames\":%d,\"errors\":%d,\"samprate\":%d,\"chans\":%d,"
+		"\"version\":%d,\"kbps\":%d,\"ms\":%d",
+		filename, frames, errors, frame_info.samprate, frame_info.nChans,
+		frame_info.version, samples? (rt_uint32_t)((unsigned long long)bytes * 8 * frame_info.samprate / samples / 1000) : 0,
+		tick * 1000 / RT_TICK_PER_SECOND);
+	if (golden_fd >= 0)
+		rt_kprintf(",\"pcm_match\":%s,\"mismatch_frames\":%d,\"first_mismatch\":%d",
+			mismatches == 0? "true" : "false", mismatches, first_mismatch);
+
+	if (MP3GetProfileInfo(decoder, &profile) == ERR_MP3_NONE && profile.frames > 0)
+	{
+		total = 0;
+		rt_kprintf(",\"cycles_per_frame\":{");
+		for (index = 0; index < MP3_NSTAGES; index ++)
+		{
+			total += profile.cycles[index];
+			rt_kprintf("%s\"%s\":%d", index? "," : "", mp3_stage_name[index],
+				(rt_uint32_t)(profile.cycles[index] / profile.frames));
+		}
+		rt_kprintf(",\"total\":%d}", (rt_uint32_t)(total / profile.frames));
+
+		/* decoding load in MHz: cycles per second of audio */
+		if (samples > 0)
+		{
+			total = total * frame_info.samprate / samples / 1000;
+			rt_kprintf(",\"mhz\":%d.%03d", (rt_uint32_t)(total / 1000), (rt_uint32_t)(total % 1000));
+		}
+	}
+	rt_kprintf("}\n");
+
+__exit:
+	if (decoder != 0) MP3FreeDecoder(decoder);
+	if (ref != RT_NULL) rt_free(ref);
+	if (pcm != RT_NULL) rt_free(pcm);
+	if (read_buffer != RT_NULL) rt_free(read_buffer);
+	if (golden_fd >= 0) close(golden_fd);
+	close(fd);
+}
+FINSH_FUNCTION_EXPORT(mp3_bench, mp3 decoder benchmark and conformance check);
 
 #if STM32_EXT_SRAM
 /* http mp3 */
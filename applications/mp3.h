@@ -1,6 +1,26 @@
 #ifndef __MP3_H__
 #define __MP3_H__
 
+/* the frames decoded ahead of the sound output */
+#define MP3_RING_DEPTH_DEFAULT	6
+#define MP3_RING_DEPTH_MAX		32
+
+/* the max files in playlist */
+#define MP3_PLAYLIST_MAX		32
+
+struct mp3_decoder;
+
 void mp3(char* filename);
+void mp3_from(char* filename, rt_uint32_t ms);
+void mp3_seek(rt_uint32_t ms);
+
+int mp3_playlist_add(const char* filename);
+void mp3_playlist_clear(void);
+void mp3_playlist_play(void);
+
+int mp3_decoder_seek(struct mp3_decoder* decoder, rt_uint32_t ms);
+
+void mp3_set_ring_depth(int depth);
+int mp3_get_ring_depth(void);
 
 #endif
@@ -0,0 +1,593 @@
+/*
+ * seek index of local mp3 file
+ *
+ * The index maps a play time to the file offset of a frame. It's taken from
+ * the Xing or VBRI header when the encoder wrote one, otherwise the frame
+ * headers of whole file are scanned without decoding, and the sparse index
+ * is cached in a sidecar file for the next time.
+ */
+#include <rtthread.h>
+#include <dfs_posix.h>
+
+#ifdef RT_USING_MP3_DECODE
+#include <string.h>
+
+#include "mp3_index.h"
+
+#define MP3_INDEX_BUF_SZ	4096
+#define MP3_INDEX_MAGIC		0x5844494d	/* "MIDX" */
+
+/* header of the sidecar file, followed by the offsets */
+struct mp3_index_file
+{
+	rt_uint32_t magic;
+	rt_uint32_t file_size;
+	rt_uint32_t data_start, data_size;
+	rt_uint32_t frames;
+	rt_uint32_t samprate;
+	rt_uint16_t frame_samples;
+	rt_uint16_t step;
+	rt_uint16_t count;
+	rt_uint16_t reserved;
+};
+
+static rt_uint32_t mp3_index_be32(const rt_uint8_t* ptr)
+{
+	return ((rt_uint32_t)ptr[0] << 24) | ((rt_uint32_t)ptr[1] << 16) |
+		((rt_uint32_t)ptr[2] << 8) | ptr[3];
+}
+
+static rt_uint16_t mp3_index_be16(const rt_uint8_t* ptr)
+{
+	return (ptr[0] << 8) | ptr[1];
+}
+
+/* the bytes of a layer 3 frame */
+static rt_uint32_t mp3_index_frame_size(const MP3FrameInfo* info, const rt_uint8_t* header)
+{
+	rt_uint32_t samples;
+
+	samples = (info->version == MPEG1)? 1152 : 576;
+	return samples / 8 * info->bitrate / info->samprate + ((header[2] >> 1) & 0x01);
+}
+
+/* check the frame header at ptr (6 bytes at least), return the bytes of frame or 0 */
+static rt_uint32_t mp3_index_frame(HMP3Decoder decoder, rt_uint8_t* ptr, MP3FrameInfo* info)
+{
+	if (ptr[0] != 0xff || (ptr[1] & 0xe0) != 0xe0)
+		return 0;
+	/* free format is not supported */
+	if ((ptr[2] >> 4) == 0)
+		return 0;
+	if (MP3GetNextFrameInfo(decoder, info, ptr) != ERR_MP3_NONE)
+		return 0;
+
+	return mp3_index_frame_size(info, ptr);
+}
+
+/*
+ * the Xing/Info header is after the side information of first frame, the
+ * LAME tag follows it.
+ */
+static int mp3_index_parse_xing(struct mp3_index* index, rt_uint8_t* frame, int length,
+	const MP3FrameInfo* info)
+{
+	rt_uint8_t *ptr, *end, *toc;
+	rt_uint32_t flags;
+	int side, i;
+
+	if (info->version == MPEG1) side = (info->nChans == 2)? 32 : 17;
+	else side = (info->nChans == 2)? 17 : 9;
+
+	ptr = frame + 4 + side;
+	end = frame + length;
+	if (ptr + 8 + 4 + 4 + 100 + 4 > end)
+		return -1;
+	if (memcmp(ptr, "Xing", 4) != 0 && memcmp(ptr, "Info", 4) != 0)
+		return -1;
+
+	flags = mp3_index_be32(ptr + 4);
+	ptr += 8;
+	if (flags & 0x01)
+	{
+		index->frames = mp3_index_be32(ptr);
+		ptr += 4;
+	}
+	if (flags & 0x02)
+	{
+		if (mp3_index_be32(ptr) != 0)
+			index->data_size = mp3_index_be32(ptr);
+		ptr += 4;
+	}
+	toc = RT_NULL;
+	if (flags & 0x04)
+	{
+		toc = ptr;
+		ptr += 100;
+	}
+	/* quality */
+	if (flags & 0x08)
+		ptr += 4;
+
+	/* encoder delay and padding are 12 bits each at the offset 21 of LAME tag */
+	if (ptr + 24 <= end && memcmp(ptr, "LAME", 4) == 0)
+	{
+		index->gapless = RT_TRUE;
+		index->enc_delay = (ptr[21] << 4) | (ptr[22] >> 4);
+		index->enc_padding = ((ptr[22] & 0x0f) << 8) | ptr[23];
+	}
+
+	/* the Xing frame is silence, play from the next frame */
+	index->audio_start = index->data_start + mp3_index_frame_size(info, frame);
+
+	if (toc == RT_NULL || index->frames == 0)
+		return 0;
+
+	index->offsets = (rt_uint32_t*) rt_malloc(100 * sizeof(rt_uint32_t));
+	if (index->offsets == RT_NULL)
+		return 0;
+
+	/* the TOC entry i is the position at i% of duration, in 1/256 of data */
+	for (i = 0; i < 100; i ++)
+		index->offsets[i] = index->data_start +
+			(rt_uint32_t)(((unsigned long long)toc[i] * index->data_size) >> 8);
+
+	index->type = MP3_INDEX_XING;
+	index->step = 0;
+	index->count = 100;
+
+	return 0;
+}
+
+/* the VBRI header is 32 bytes after the first frame header */
+static int mp3_index_parse_vbri(struct mp3_index* index, rt_uint8_t* frame, int length,
+	const MP3FrameInfo* info)
+{
+	rt_uint8_t *ptr;
+	rt_uint16_t entries, scale, entry_size, step;
+	rt_uint32_t entry;
+	int i, j;
+
+	ptr = frame + 4 + 32;
+	if (4 + 32 + 26 > length || memcmp(ptr, "VBRI", 4) != 0)
+		return -1;
+
+	entries = mp3_index_be16(ptr + 18);
+	scale = mp3_index_be16(ptr + 20);
+	entry_size = mp3_index_be16(ptr + 22);
+	step = mp3_index_be16(ptr + 24);
+	if (mp3_index_be32(ptr + 14) == 0 || entries == 0 || entries >= MP3_INDEX_ENTRIES_MAX ||
+		entry_size == 0 || entry_size > 4 || step == 0 ||
+		4 + 32 + 26 + entries * entry_size > length)
+		return -1;
+
+	index->frames = mp3_index_be32(ptr + 14);
+	if (mp3_index_be32(ptr + 10) != 0)
+		index->data_size = mp3_index_be32(ptr + 10);
+	ptr += 26;
+
+	/* the VBRI frame is silence, play from the next frame */
+	index->audio_start = index->data_start + mp3_index_frame_size(info, frame);
+
+	index->offsets = (rt_uint32_t*) rt_malloc((entries + 1) * sizeof(rt_uint32_t));
+	if (index->offsets == RT_NULL)
+		return -1;
+
+	/* the TOC entry is the bytes of every step frames */
+	index->offsets[0] = index->data_start;
+	for (i = 0; i < entries; i ++)
+	{
+		entry = 0;
+		for (j = 0; j < entry_size; j ++)
+			entry = (entry << 8) | *ptr++;
+
+		index->offsets[i + 1] = index->offsets[i] + entry * scale;
+	}
+
+	index->type = MP3_INDEX_VBRI;
+	index->step = step;
+	index->count = entries + 1;
+
+	return 0;
+}
+
+/* scan the frame headers, take the offset of every step frames */
+static int mp3_index_scan(struct mp3_index* index, int fd, rt_uint8_t* buffer,
+	HMP3Decoder decoder)
+{
+	MP3FrameInfo info;
+	rt_uint32_t pos, base, data_end, frame_size;
+	rt_uint16_t step, count;
+	rt_uint8_t *ptr;
+	int length, offset, i;
+
+	index->offsets = (rt_uint32_t*) rt_malloc(MP3_INDEX_ENTRIES_MAX * sizeof(rt_uint32_t));
+	if (index->offsets == RT_NULL)
+		return -1;
+
+	/* the step doubles when the index is full, it ends with 1/2 ~ 1 of the max points */
+	step = 1;
+	count = 0;
+
+	data_end = index->data_start + index->data_size;
+	pos = base = index->audio_start;
+	length = 0;
+	index->frames = 0;
+	while (pos + 4 <= data_end)
+	{
+		/* read on when the frame header is out of buffer */
+		if (pos + 6 > base + length)
+		{
+			if (lseek(fd, pos, SEEK_SET) != pos)
+				break;
+			length = read(fd, (char*)buffer, MP3_INDEX_BUF_SZ);
+			if (length < 6)
+				break;
+			base = pos;
+		}
+
+		ptr = buffer + (pos - base);
+		frame_size = mp3_index_frame(decoder, ptr, &info);
+		if (frame_size == 0 || info.samprate != index->samprate)
+		{
+			/* lost sync, search the next frame */
+			offset = MP3FindSyncWord(ptr + 1, base + length - pos - 1);
+			if (offset < 0)
+				pos = base + length - 1;
+			else
+				pos += 1 + offset;
+			continue;
+		}
+
+		if (index->frames % step == 0)
+		{
+			if (count == MP3_INDEX_ENTRIES_MAX)
+			{
+				/* keep every other point */
+				for (i = 0; i < MP3_INDEX_ENTRIES_MAX / 2; i ++)
+					index->offsets[i] = index->offsets[i * 2];
+				count = MP3_INDEX_ENTRIES_MAX / 2;
+				step <<= 1;
+			}
+			index->offsets[count ++] = pos;
+		}
+
+		index->frames ++;
+		pos += frame_size;
+	}
+
+	if (index->frames == 0)
+		return -1;
+
+	index->type = MP3_INDEX_SCAN;
+	index->step = step;
+	index->count = count;
+
+	return 0;
+}
+
+static char* mp3_index_sidecar(const char* filename)
+{
+	char* path;
+
+	path = (char*) rt_malloc(strlen(filename) + sizeof(MP3_INDEX_SUFFIX));
+	if (path != RT_NULL)
+	{
+		strcpy(path, filename);
+		strcat(path, MP3_INDEX_SUFFIX);
+	}
+
+	return path;
+}
+
+static int mp3_index_load(struct mp3_index* index, const char* filename)
+{
+	struct mp3_index_file header;
+	char* path;
+	int fd, length;
+
+	path = mp3_index_sidecar(filename);
+	if (path == RT_NULL)
+		return -1;
+	fd = open(path, O_RDONLY, 0);
+	rt_free(path);
+	if (fd < 0)
+		return -1;
+
+	/* the index is out of date when the mp3 file changes */
+	length = read(fd, (char*)&header, sizeof(header));
+	if (length != sizeof(header) || header.magic != MP3_INDEX_MAGIC ||
+		header.file_size != index->file_size || header.data_start != index->data_start ||
+		header.samprate != index->samprate || header.frames == 0 ||
+		header.step == 0 || header.count == 0 || header.count > MP3_INDEX_ENTRIES_MAX)
+		goto __error;
+
+	index->offsets = (rt_uint32_t*) rt_malloc(header.count * sizeof(rt_uint32_t));
+	if (index->offsets == RT_NULL)
+		goto __error;
+	length = read(fd, (char*)index->offsets, header.count * sizeof(rt_uint32_t));
+	if (length != header.count * sizeof(rt_uint32_t))
+	{
+		rt_free(index->offsets);
+		index->offsets = RT_NULL;
+		goto __error;
+	}
+	close(fd);
+
+	index->type = MP3_INDEX_SCAN;
+	index->data_size = header.data_size;
+	index->frames = header.frames;
+	index->step = header.step;
+	index->count = header.count;
+
+	return 0;
+
+__error:
+	close(fd);
+	return -1;
+}
+
+static void mp3_index_save(struct mp3_index* index, const char* filename)
+{
+	struct mp3_index_file header;
+	char* path;
+	int fd;
+
+	path = mp3_index_sidecar(filename);
+	if (path == RT_NULL)
+		return;
+	fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0);
+	rt_free(path);
+	/* the file system may be read only, scan it again next time */
+	if (fd < 0)
+		return;
+
+	header.magic = MP3_INDEX_MAGIC;
+	header.file_size = index->file_size;
+	header.data_start = index->data_start;
+	header.data_size = index->data_size;
+	header.frames = index->frames;
+	header.samprate = index->samprate;
+	header.frame_samples = index->frame_samples;
+	header.step = index->step;
+	header.count = index->count;
+	header.reserved = 0;
+
+	write(fd, (char*)&header, sizeof(header));
+	write(fd, (char*)index->offsets, index->count * sizeof(rt_uint32_t));
+	close(fd);
+}
+
+/*
+ * create the seek index of a mp3 file, the decoder is used to parse the
+ * frame headers only. When scan is RT_FALSE, a file without TOC or sidecar
+ * file gets no seek point, and it may have no duration.
+ */
+struct mp3_index* mp3_index_create(const char* filename, HMP3Decoder decoder, rt_bool_t scan)
+{
+	struct stat file_stat;
+	struct mp3_index* index;
+	MP3FrameInfo info;
+	rt_uint8_t *buffer;
+	rt_uint32_t data_end, first_size;
+	int fd, length, offset;
+
+	RT_ASSERT(filename != RT_NULL);
+	RT_ASSERT(decoder != RT_NULL);
+
+	if (stat(filename, &file_stat) != 0)
+		return RT_NULL;
+	fd = open(filename, O_RDONLY, 0);
+	if (fd < 0)
+		return RT_NULL;
+
+	buffer = (rt_uint8_t*) rt_malloc(MP3_INDEX_BUF_SZ);
+	index = (struct mp3_index*) rt_malloc(sizeof(struct mp3_index));
+	if (buffer == RT_NULL || index == RT_NULL)
+		goto __error;
+	rt_memset(index, 0, sizeof(struct mp3_index));
+	index->file_size = file_stat.st_size;
+
+	/* ID3v1 tag at the end of file */
+	data_end = index->file_size;
+	if (data_end > 128 && lseek(fd, data_end - 128, SEEK_SET) == data_end - 128 &&
+		read(fd, (char*)buffer, 3) == 3 && memcmp(buffer, "TAG", 3) == 0)
+		data_end -= 128;
+
+	/* skip ID3v2 tag, the size is a syncsafe integer */
+	lseek(fd, 0, SEEK_SET);
+	if (read(fd, (char*)buffer, 10) == 10 && memcmp(buffer, "ID3", 3) == 0)
+	{
+		index->data_start = 10 + (((buffer[6] & 0x7f) << 21) | ((buffer[7] & 0x7f) << 14) |
+			((buffer[8] & 0x7f) << 7) | (buffer[9] & 0x7f));
+		/* footer present */
+		if (buffer[5] & 0x10)
+			index->data_start += 10;
+	}
+
+	/* find the first frame */
+	if (lseek(fd, index->data_start, SEEK_SET) != index->data_start)
+		goto __error;
+	length = read(fd, (char*)buffer, MP3_INDEX_BUF_SZ);
+	offset = 0;
+	first_size = 0;
+	while (length - offset >= 6)
+	{
+		int sync;
+
+		sync = MP3FindSyncWord(buffer + offset, length - offset);
+		if (sync < 0 || length - offset - sync < 6)
+			break;
+		offset += sync;
+
+		first_size = mp3_index_frame(decoder, buffer + offset, &info);
+		if (first_size != 0)
+			break;
+		offset ++;
+	}
+	if (first_size == 0)
+		goto __error;
+
+	index->data_start += offset;
+	if (index->data_start >= data_end)
+		goto __error;
+	index->data_size = data_end - index->data_start;
+	index->audio_start = index->data_start;
+	index->samprate = info.samprate;
+	index->frame_samples = (info.version == MPEG1)? 1152 : 576;
+
+	if (mp3_index_parse_xing(index, buffer + offset, length - offset, &info) != 0)
+		mp3_index_parse_vbri(index, buffer + offset, length - offset, &info);
+
+	/* no TOC in file, take the points from sidecar file or a scan */
+	if (index->count == 0 && mp3_index_load(index, filename) != 0 && scan == RT_TRUE)
+	{
+		if (mp3_index_scan(index, fd, buffer, decoder) != 0)
+			goto __error;
+
+		mp3_index_save(index, filename);
+	}
+
+	close(fd);
+	rt_free(buffer);
+
+	index->duration = (rt_uint32_t)((unsigned long long)index->frames *
+		index->frame_samples * 1000 / index->samprate);
+	if (index->duration > 0)
+		index->bitrate = (rt_uint32_t)((unsigned long long)index->data_size * 8000 /
+			index->duration);
+
+	return index;
+
+__error:
+	close(fd);
+	if (buffer != RT_NULL) rt_free(buffer);
+	if (index != RT_NULL) mp3_index_delete(index);
+
+	return RT_NULL;
+}
+
+void mp3_index_delete(struct mp3_index* index)
+{
+	RT_ASSERT(index != RT_NULL);
+
+	if (index->offsets != RT_NULL)
+		rt_free(index->offsets);
+	rt_free(index);
+}
+
+/*
+ * get the file offset to play from ms, the frame number of the seek point
+ * is returned in frame.
+ */
+rt_uint32_t mp3_index_lookup(struct mp3_index* index, rt_uint32_t ms, rt_uint32_t *frame)
+{
+	rt_uint32_t target, entry;
+
+	RT_ASSERT(index != RT_NULL);
+
+	if (index->count == 0 || index->frames == 0)
+	{
+		/* no seek point, play from the start */
+		if (frame != RT_NULL)
+			*frame = 0;
+		return index->audio_start;
+	}
+
+	target = (rt_uint32_t)((unsigned long long)ms * index->samprate /
+		(1000 * index->frame_samples));
+	if (target >= index->frames)
+		target = index->frames - 1;
+
+	if (index->step == 0)
+	{
+		/* Xing TOC, a point at every 1% of duration */
+		entry = (rt_uint32_t)((unsigned long long)target * 100 / index->frames);
+		if (entry >= index->count) entry = index->count - 1;
+		target = (rt_uint32_t)((unsigned long long)entry * index->frames / 100);
+	}
+	else
+	{
+		entry = target / index->step;
+		if (entry >= index->count) entry = index->count - 1;
+		target = entry * index->step;
+	}
+
+	if (frame != RT_NULL)
+		*frame = target;
+
+	return index->offsets[entry];
+}
+
+/* count the whole frames in buffer, from the first frame in it */
+rt_uint32_t mp3_index_count_frames(HMP3Decoder decoder, rt_uint8_t* buffer, rt_uint32_t length)
+{
+	MP3FrameInfo info;
+	rt_uint32_t frames, size;
+	int offset;
+
+	offset = MP3FindSyncWord(buffer, length);
+	if (offset < 0)
+		return 0;
+	buffer += offset;
+	length -= offset;
+
+	frames = 0;
+	while (length >= 6)
+	{
+		size = mp3_index_frame(decoder, buffer, &info);
+		if (size == 0 || size > length)
+			break;
+
+		frames ++;
+		buffer += size;
+		length -= size;
+	}
+
+	return frames;
+}
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+static const char* mp3_index_type_name[] = {"none", "xing", "vbri", "scan"};
+
+void mp3_info(const char* filename)
+{
+	struct mp3_index* index;
+	HMP3Decoder decoder;
+	rt_uint32_t tick;
+
+	decoder = MP3InitDecoder();
+	if (decoder == 0)
+	{
+		rt_kprintf("out of memory\n");
+		return;
+	}
+
+	tick = rt_tick_get();
+	index = mp3_index_create(filename, decoder, RT_TRUE);
+	tick = rt_tick_get() - tick;
+	MP3FreeDecoder(decoder);
+
+	if (index == RT_NULL)
+	{
+		rt_kprintf("no mp3 frame in %s\n", filename);
+		return;
+	}
+
+	rt_kprintf("duration: %d.%03d s, bitrate: %d bps, %d Hz\n",
+		index->duration / 1000, index->duration % 1000, index->bitrate, index->samprate);
+	rt_kprintf("frames: %d, data: %d bytes at 0x%08x\n", index->frames,
+		index->data_size, index->data_start);
+	rt_kprintf("index: %s, %d points, step %d frames, built in %d ms\n",
+		mp3_index_type_name[index->type], index->count, index->step,
+		tick * 1000 / RT_TICK_PER_SECOND);
+	if (index->gapless == RT_TRUE)
+		rt_kprintf("encoder delay: %d, padding: %d samples\n",
+			index->enc_delay, index->enc_padding);
+
+	mp3_index_delete(index);
+}
+FINSH_FUNCTION_EXPORT(mp3_info, show the duration and seek index of mp3 file);
+#endif
+#endif
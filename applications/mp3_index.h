@@ -0,0 +1,53 @@
+#ifndef __MP3_INDEX_H__
+#define __MP3_INDEX_H__
+
+#include <rtthread.h>
+#include <mp3dec.h>
+
+/* where the seek points of index come from */
+#define MP3_INDEX_XING			1	/* TOC of Xing/Info header */
+#define MP3_INDEX_VBRI			2	/* TOC of Fraunhofer VBRI header */
+#define MP3_INDEX_SCAN			3	/* frame header scan, cached in a sidecar file */
+
+/* the max seek points of a scanned index */
+#define MP3_INDEX_ENTRIES_MAX	512
+/* the sidecar file of scanned index is named as "<mp3 file>.idx" */
+#define MP3_INDEX_SUFFIX		".idx"
+
+struct mp3_index
+{
+	rt_uint8_t type;
+
+	/* the audio frames in file, after the Xing/VBRI frame if any */
+	rt_uint32_t file_size;
+	rt_uint32_t data_start, data_size;
+	rt_uint32_t audio_start;
+	rt_uint32_t frames;
+	rt_uint32_t samprate;
+	rt_uint16_t frame_samples;
+
+	/* duration in ms and average bitrate in bps */
+	rt_uint32_t duration;
+	rt_uint32_t bitrate;
+
+	/* samples added by the encoder at the start and the end, from LAME tag */
+	rt_bool_t gapless;
+	rt_uint16_t enc_delay, enc_padding;
+
+	/*
+	 * seek points, offsets[i] is the file offset of frame i * step. The
+	 * points of Xing TOC are at every 1% of duration, step is 0 for it.
+	 * There is no point (count is 0) if the file is not scanned.
+	 */
+	rt_uint16_t step;
+	rt_uint16_t count;
+	rt_uint32_t *offsets;
+};
+
+struct mp3_index* mp3_index_create(const char* filename, HMP3Decoder decoder, rt_bool_t scan);
+void mp3_index_delete(struct mp3_index* index);
+
+rt_uint32_t mp3_index_lookup(struct mp3_index* index, rt_uint32_t ms, rt_uint32_t *frame);
+rt_uint32_t mp3_index_count_frames(HMP3Decoder decoder, rt_uint8_t* buffer, rt_uint32_t length);
+
+#endif
@@ -4,11 +4,6 @@
 #include <rtthread.h>
 #include "board.h"
 
-/* SRAM buffer pool routine */
-rt_size_t sbuf_get_size(void);
-void* sbuf_alloc(void);
-void sbuf_release(void* ptr);
-
 /* netbuffer API */
 rt_size_t net_buf_read(rt_uint8_t* buffer, rt_size_t length);
 int net_buf_start_job(rt_size_t (*fetch)(rt_uint8_t* ptr, rt_size_t len, void* parameter),
@@ -6,6 +6,7 @@
 #include <rtgui/driver.h>
 
 #include "setup.h"
+#include "mp3.h"
 #include "appmgr.h"
 #include "statusbar.h"
 
@@ -26,6 +27,10 @@ rt_bool_t cali_setup(void)
         device = rt_device_find("touch");
         if(device != RT_NULL)
             rt_device_control(device, RT_TOUCH_CALIBRATION_DATA, &data);
+
+#ifdef RT_USING_MP3_DECODE
+        mp3_set_ring_depth(setup.mp3_ring_depth);
+#endif
         return RT_TRUE;
     }
     return RT_FALSE;
@@ -38,6 +43,11 @@ void cali_store(struct calibration_data *data)
     setup.touch_max_x = data->max_x;
     setup.touch_min_y = data->min_y;
     setup.touch_max_y = data->max_y;
+#ifdef RT_USING_MP3_DECODE
+    setup.mp3_ring_depth = mp3_get_ring_depth();
+#else
+    setup.mp3_ring_depth = MP3_RING_DEPTH_DEFAULT;
+#endif
     setup_save(&setup);
 }
 
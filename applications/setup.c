@@ -1,6 +1,7 @@
 #include <rtthread.h>
 #include <dfs_posix.h>
 #include "setup.h"
+#include "mp3.h"
 #include <stdlib.h>
 
 #define setup_fn    "/setup.ini"
@@ -9,6 +10,7 @@ static const char* kn_touch_min_x = "touch_min_x";
 static const char* kn_touch_max_x = "touch_max_x";
 static const char* kn_touch_min_y = "touch_min_y";
 static const char* kn_touch_max_y = "touch_max_y";
+static const char* kn_mp3_ring_depth = "mp3_ring_depth";
 
 static rt_uint32_t read_line(int fd, char* line, rt_uint32_t line_size)
 {
@@ -51,6 +53,7 @@ static void setup_load_default(void)
     setup.touch_max_x = 0x20;
     setup.touch_min_y = 0x53;
     setup.touch_max_y = 0x79b;
+    setup.mp3_ring_depth = MP3_RING_DEPTH_DEFAULT;
 
     setup_save(&setup);
 }
@@ -62,6 +65,9 @@ rt_err_t setup_load(struct setup_items* setup)
 
     rt_kprintf("setup_load\n");
 
+    /* the items added later are optional */
+    setup->mp3_ring_depth = MP3_RING_DEPTH_DEFAULT;
+
     fd = open(setup_fn, O_RDONLY, 0);
     if (fd >= 0)
     {
@@ -129,6 +135,15 @@ rt_err_t setup_load(struct setup_items* setup)
                 begin++;
                 setup->touch_max_y = atoi(begin);
             }
+
+            // mp3_ring_depth
+            length = read_line(fd, line, sizeof(line));
+            if (length > 0 && strncmp(line, kn_mp3_ring_depth, strlen(kn_mp3_ring_depth)) == 0)
+            {
+                begin = strchr(line, '=');
+                begin++;
+                setup->mp3_ring_depth = atoi(begin);
+            }
         }
         else
         {
@@ -179,6 +194,9 @@ rt_err_t setup_save(struct setup_items* setup)
 
         size = sprintf(p_str, "%s=%d\r\n", kn_touch_max_y, setup->touch_max_y); //touch_max_y
         p_str += size;
+
+        size = sprintf(p_str, "%s=%d\r\n", kn_mp3_ring_depth, setup->mp3_ring_depth); //mp3_ring_depth
+        p_str += size;
     }
 
     size = write(fd, buf, p_str - buf);
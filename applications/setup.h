@@ -6,6 +6,9 @@ struct setup_items
     rt_uint16_t touch_max_x;
     rt_uint16_t touch_min_y;
     rt_uint16_t touch_max_y;        
+
+    /* the frames of mp3 decoded ahead of sound output */
+    rt_uint16_t mp3_ring_depth;
 };
 
 rt_err_t setup_load(struct setup_items* setup);
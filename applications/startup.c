@@ -69,7 +69,7 @@ void rtthread_startup(void)
 
 #if STM32_EXT_SRAM
     rt_system_heap_init((void*)STM32_EXT_SRAM_BEGIN,
-                        (void*)STM32_EXT_SRAM_END);
+                        (void*)STM32_EXT_SRAM_HEAP_END);
 #else
     rt_system_heap_init((void*)STM32_SRAM_BEGIN, (void*)STM32_SRAM_END);
 #endif /* STM32_EXT_SRAM */
@@ -2,6 +2,10 @@
 #include <rtgui/widgets/panel.h>
 #include <rtgui/widgets/notebook.h>
 #include <rtgui/widgets/listbox.h>
+#include <rtgui/image_container.h>
+#ifdef RTGUI_NOTEBOOK_IMAGE_FILE
+#include <dfs_posix.h>
+#endif
 
 #include "apps_list.h"
 #include "block_panel.h"
@@ -10,6 +14,46 @@
 #include "xpm/home.xpm"
 #include "xpm/home_gray.xpm"
 
+#ifdef RTGUI_IMAGE_CONTAINER
+/* the built-in icons are shared in image container */
+static struct rtgui_image *app_mgr_icon(const void *xpm, rt_uint32_t length)
+{
+    rtgui_image_item_t *item;
+
+    item = rtgui_image_container_get_memref("xpm", (const rt_uint8_t*)xpm, length);
+    if (item == RT_NULL) return RT_NULL;
+
+    return item->image;
+}
+#else
+#define app_mgr_icon(xpm, length) \
+    rtgui_image_create_from_mem("xpm", (const rt_uint8_t*)(xpm), (length), RT_FALSE)
+#endif
+
+#ifdef RTGUI_NOTEBOOK_IMAGE_FILE
+#define APP_MGR_ICON_PATH   "/resource/appmgr"
+
+/*
+ * the tab icons are taken from <label>.png and <label>_gray.png of icon path
+ * when there are, the built-in icons are used otherwise.
+ */
+static void app_mgr_add_page(struct rtgui_notebook *notebook, const char *label, struct rtgui_widget *page,
+                             struct rtgui_image *pressed_image, struct rtgui_image *unpressed_image)
+{
+    char pressed_fn[48], unpressed_fn[48];
+    struct stat s;
+
+    rt_snprintf(pressed_fn, sizeof(pressed_fn), "%s/%s.png", APP_MGR_ICON_PATH, label);
+    rt_snprintf(unpressed_fn, sizeof(unpressed_fn), "%s/%s_gray.png", APP_MGR_ICON_PATH, label);
+    if (stat(pressed_fn, &s) == 0 && stat(unpressed_fn, &s) == 0)
+        rtgui_notebook_add_image_file(notebook, label, page, pressed_fn, unpressed_fn);
+    else
+        rtgui_notebook_add_image(notebook, label, page, pressed_image, unpressed_image);
+}
+#else
+#define app_mgr_add_page    rtgui_notebook_add_image
+#endif
+
 rt_bool_t event_handler(struct rtgui_object* object, rtgui_event_t* event)
 {
     rt_bool_t result;
@@ -47,10 +91,14 @@ void app_mgr_win_init(void)
     /* create main window of Application Manager */
     win = rtgui_mainwin_create(RT_NULL, "AppMgr", RTGUI_WIN_STYLE_MAINWIN);
     RTGUI_WIDGET_BACKGROUND(win) = RTGUI_RGB(241, 241, 241);
+#if defined(RTGUI_USING_WIN_BUFFER) && defined(RTGUI_WIN_BUFFER_MEMHEAP)
+    /* paint the pages in back buffer, it draws to screen directly if no memory */
+    rtgui_win_set_buffered(win, RT_TRUE);
+#endif
 
     /* create icon image */
-    pressed_image = rtgui_image_create_from_mem("xpm", (const rt_uint8_t*)home_xpm, sizeof(home_xpm), RT_FALSE);
-    unpressed_image = rtgui_image_create_from_mem("xpm", (const rt_uint8_t*)home_gray_xpm, sizeof(home_gray_xpm), RT_FALSE);
+    pressed_image = app_mgr_icon(home_xpm, sizeof(home_xpm));
+    unpressed_image = app_mgr_icon(home_gray_xpm, sizeof(home_gray_xpm));
     rtgui_font_get_metrics(RTGUI_WIDGET_FONT(win), "AppMgr", &rect);
     font_size = rtgui_rect_height(rect);
 
@@ -65,7 +113,7 @@ void app_mgr_win_init(void)
     /* create navigation */
     block = block_panel_create(angle_y + notebook->tab_h/2, &rect);
     RTGUI_WIDGET_BACKGROUND(block) = RTGUI_RGB(241, 241, 241);
-    rtgui_notebook_add_image(notebook, "Programs", RTGUI_WIDGET(block),
+    app_mgr_add_page(notebook, "Programs", RTGUI_WIDGET(block),
         pressed_image, unpressed_image);
     program_create(RTGUI_PANEL(block));
     angle_y += notebook->tab_h;
@@ -73,14 +121,14 @@ void app_mgr_win_init(void)
     rtgui_notebook_get_client_rect(notebook, &rect);
     block = block_panel_create(angle_y + notebook->tab_h/2, &rect);
     RTGUI_WIDGET_BACKGROUND(block) = RTGUI_RGB(241, 241, 241);
-    rtgui_notebook_add_image(notebook, "Task", RTGUI_WIDGET(block),
+    app_mgr_add_page(notebook, "Task", RTGUI_WIDGET(block),
         pressed_image, unpressed_image);
     apps_list_create(RTGUI_PANEL(block));
     angle_y += notebook->tab_h;
 
     block = block_panel_create(angle_y + notebook->tab_h/2, &rect);
     RTGUI_WIDGET_BACKGROUND(block) = RTGUI_RGB(241, 241, 241);
-    rtgui_notebook_add_image(notebook, "Setting", RTGUI_WIDGET(block), 
+    app_mgr_add_page(notebook, "Setting", RTGUI_WIDGET(block), 
         pressed_image, unpressed_image);
     angle_y += notebook->tab_h;
 
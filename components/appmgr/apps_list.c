@@ -1,6 +1,7 @@
 #include "apps_list.h"
 #include <rtgui/rtgui_app.h>
 #include <rtgui/widgets/listctrl.h>
+#include <rtgui/image_container.h>
 
 #include "xpm/exec.xpm"
 #include "xpm/close.xpm"
@@ -224,6 +225,22 @@ struct rtgui_panel* apps_list_create(struct rtgui_panel* panel)
 
 	RT_ASSERT(panel != RT_NULL);
 
+#ifdef RTGUI_IMAGE_CONTAINER
+	if (app_default_icon == RT_NULL)
+	{
+		rtgui_image_item_t *item;
+
+		item = rtgui_image_container_get_memref("xpm", (const rt_uint8_t*)exec_xpm, sizeof(exec_xpm));
+		if (item != RT_NULL) app_default_icon = item->image;
+	}
+	if (app_close == RT_NULL)
+	{
+		rtgui_image_item_t *item;
+
+		item = rtgui_image_container_get_memref("xpm", (const rt_uint8_t *)close_xpm, sizeof(close_xpm));
+		if (item != RT_NULL) app_close = item->image;
+	}
+#else
 	if (app_default_icon == RT_NULL)
 	{
 		app_default_icon = rtgui_image_create_from_mem("xpm", (const rt_uint8_t*)exec_xpm, sizeof(exec_xpm), RT_FALSE);
@@ -232,6 +249,7 @@ struct rtgui_panel* apps_list_create(struct rtgui_panel* panel)
 	{
 		app_close = rtgui_image_create_from_mem("xpm", (const rt_uint8_t *)close_xpm, sizeof(close_xpm), RT_FALSE);
 	}
+#endif
 
 	rtgui_widget_get_extent(RTGUI_WIDGET(panel), &rect);
 
@@ -6,6 +6,7 @@
 #include <rtgui/widgets/list_view.h>
 #include <rtgui/rtgui_xml.h>
 #include <rtgui/widgets/panel.h>
+#include <rtgui/image_container.h>
 
 #include <dfs_posix.h>
 #define PATH_SEPARATOR      '/'
@@ -52,7 +53,17 @@ static int xml_event_handler(rt_uint8_t event, const char* text, rt_size_t len,
             break;
         case READ_ICON:
             rt_snprintf(fn, sizeof(fn), "%s/%s", APP_PATH, text);
+#if defined(RTGUI_IMAGE_CONTAINER) && defined(RTGUI_USING_DFS_FILERW)
+            {
+                /* the programs with the same icon share one image */
+                rtgui_image_item_t *item;
+
+                item = rtgui_image_container_get(fn);
+                items[pos].image = (item != RT_NULL) ? item->image : RT_NULL;
+            }
+#else
             items[pos].image = rtgui_image_create(fn, RT_TRUE);
+#endif
             if(items[pos].image == RT_NULL) rt_kprintf("image create failed\n");
             break;
         case READ_AUTHOR:
@@ -1,6 +1,7 @@
 #include "statusbar.h"
 #include <rtgui/dc.h>
 #include <rtgui/image.h>
+#include <rtgui/image_container.h>
 #include "xpm/start.xpm"
 
 static const rtgui_color_t _status_bar_pixels[] = 
@@ -96,22 +97,33 @@ rt_bool_t statusbar_event_handler(struct rtgui_object* object, struct rtgui_even
 			struct rtgui_dc *dc;
 			struct rtgui_rect rect;
 			struct rtgui_image *image;
+#ifdef RTGUI_IMAGE_CONTAINER
+			rtgui_image_item_t *item;
 
+			/* take start image from container, which is decoded only once */
+			item = rtgui_image_container_get_memref("xpm", (const rt_uint8_t*)start_xpm, sizeof(start_xpm));
+			image = (item != RT_NULL) ? item->image : RT_NULL;
+#else
 			/* create start image */
 			image = rtgui_image_create_from_mem("xpm", (const rt_uint8_t*)start_xpm, sizeof(start_xpm), RT_FALSE);
+#endif
 			rtgui_widget_get_rect(RTGUI_WIDGET(object), &rect);
 
 			dc = rtgui_dc_begin_drawing(RTGUI_WIDGET(object));
 			dc_draw_bar(dc, _status_bar_pixels, &rect, RTGUI_HORIZONTAL);
 
 			rect.x1 += 15;
-			rtgui_image_blit(image, dc, &rect);
+			if (image != RT_NULL) rtgui_image_blit(image, dc, &rect);
 
 			/* dispatch event */
 			rtgui_container_dispatch_event(RTGUI_CONTAINER(object), event);
 
 			rtgui_dc_end_drawing(dc);
+#ifdef RTGUI_IMAGE_CONTAINER
+			if (item != RT_NULL) rtgui_image_container_put(item);
+#else
 			rtgui_image_destroy(image);
+#endif
 		}
 		break;
 
@@ -88,6 +88,36 @@ void MP3FreeDecoder(HMP3Decoder hMP3Decoder)
 	FreeBuffers(mp3DecInfo);
 }
 
+/**************************************************************************************
+ * Function:    MP3ResetDecoder
+ *
+ * Description: clear the decoding state for a new stream, without freeing and
+ *                allocating the memory again
+ *
+ * Inputs:      valid MP3 decoder instance pointer (HMP3Decoder)
+ *
+ * Outputs:     none
+ *
+ * Return:      none
+ *
+ * Notes:       the bit reservoir and the overlap of last stream are dropped, the
+ *                settings (MP3SetStereoOutput) and profile info are kept
+ **************************************************************************************/
+void MP3ResetDecoder(HMP3Decoder hMP3Decoder)
+{
+	MP3DecInfo *mp3DecInfo = (MP3DecInfo *)hMP3Decoder;
+
+	if (!mp3DecInfo)
+		return;
+
+	ResetBuffers(mp3DecInfo);
+
+	mp3DecInfo->freeBitrateFlag = 0;
+	mp3DecInfo->freeBitrateSlots = 0;
+	mp3DecInfo->mainDataBegin = 0;
+	mp3DecInfo->mainDataBytes = 0;
+}
+
 /**************************************************************************************
  * Function:    MP3FindSyncWord
  *
@@ -198,7 +228,7 @@ void MP3GetLastFrameInfo(HMP3Decoder hMP3Decoder, MP3FrameInfo *mp3FrameInfo)
 		mp3FrameInfo->nChans = mp3DecInfo->nChans;
 		mp3FrameInfo->samprate = mp3DecInfo->samprate;
 		mp3FrameInfo->bitsPerSample = 16;
-		mp3FrameInfo->outputSamps = mp3DecInfo->nChans * (int)samplesPerFrameTab[mp3DecInfo->version][mp3DecInfo->layer - 1];
+		mp3FrameInfo->outputSamps = MP3_OUTPUT_CHANS(mp3DecInfo) * (int)samplesPerFrameTab[mp3DecInfo->version][mp3DecInfo->layer - 1];
 		mp3FrameInfo->layer = mp3DecInfo->layer;
 		mp3FrameInfo->version = mp3DecInfo->version;
 	}
@@ -252,7 +282,7 @@ static void MP3ClearBadFrame(MP3DecInfo *mp3DecInfo, short *outbuf)
 	if (!mp3DecInfo)
 		return;
 
-	for (i = 0; i < mp3DecInfo->nGrans * mp3DecInfo->nGranSamps * mp3DecInfo->nChans; i++)
+	for (i = 0; i < mp3DecInfo->nGrans * mp3DecInfo->nGranSamps * MP3_OUTPUT_CHANS(mp3DecInfo); i++)
 		outbuf[i] = 0;
 }
 
@@ -270,6 +300,7 @@ static void MP3ClearBadFrame(MP3DecInfo *mp3DecInfo, short *outbuf)
  *
  * Outputs:     PCM data in outbuf, interleaved LRLRLR... if stereo
  *                number of output samples = nGrans * nGranSamps * nChans
+ *                (mono is output as stereo if MP3SetStereoOutput is enabled)
  *              updated inbuf pointer, updated bytesLeft
  *
  * Return:      error code, defined in mp3dec.h (0 means no error, < 0 means error)
@@ -283,10 +314,14 @@ int MP3Decode(HMP3Decoder hMP3Decoder, unsigned char **inbuf, int *bytesLeft, sh
 	int prevBitOffset, sfBlockBits, huffBlockBits;
 	unsigned char *mainPtr;
 	MP3DecInfo *mp3DecInfo = (MP3DecInfo *)hMP3Decoder;
+#ifdef MP3_PROFILE
+	unsigned int t;
+#endif
 
 	if (!mp3DecInfo)
 		return ERR_MP3_NULL_POINTER;
 
+	MP3_PROFILE_START(t);
 	/* unpack frame header */
 	fhBytes = UnpackFrameHeader(mp3DecInfo, *inbuf);
 	if (fhBytes < 0)	
@@ -301,6 +336,7 @@ int MP3Decode(HMP3Decoder hMP3Decoder, unsigned char **inbuf, int *bytesLeft, sh
 	}
 	*inbuf += siBytes;
 	*bytesLeft -= (fhBytes + siBytes);
+	MP3_PROFILE_STOP(mp3DecInfo, MP3_STAGE_HEADER, t);
 	
 	/* if free mode, need to calculate bitrate and nSlots manually, based on frame size */
 	if (mp3DecInfo->bitrate == 0 || mp3DecInfo->freeBitrateFlag) {
@@ -370,8 +406,10 @@ int MP3Decode(HMP3Decoder hMP3Decoder, unsigned char **inbuf, int *bytesLeft, sh
 	for (gr = 0; gr < mp3DecInfo->nGrans; gr++) {
 		for (ch = 0; ch < mp3DecInfo->nChans; ch++) {
 			/* unpack scale factors and compute size of scale factor block */
+			MP3_PROFILE_START(t);
 			prevBitOffset = bitOffset;
 			offset = UnpackScaleFactors(mp3DecInfo, mainPtr, &bitOffset, mainBits, gr, ch);
+			MP3_PROFILE_STOP(mp3DecInfo, MP3_STAGE_SCALEFACT, t);
 
 			sfBlockBits = 8*offset - prevBitOffset + bitOffset;
 			huffBlockBits = mp3DecInfo->part23Length[gr][ch] - sfBlockBits;
@@ -384,8 +422,10 @@ int MP3Decode(HMP3Decoder hMP3Decoder, unsigned char **inbuf, int *bytesLeft, sh
 			}
 
 			/* decode Huffman code words */
+			MP3_PROFILE_START(t);
 			prevBitOffset = bitOffset;
 			offset = DecodeHuffman(mp3DecInfo, mainPtr, &bitOffset, huffBlockBits, gr, ch);
+			MP3_PROFILE_STOP(mp3DecInfo, MP3_STAGE_HUFFMAN, t);
 			if (offset < 0) {
 				MP3ClearBadFrame(mp3DecInfo, outbuf);
 				return ERR_MP3_INVALID_HUFFCODES;
@@ -395,23 +435,113 @@ int MP3Decode(HMP3Decoder hMP3Decoder, unsigned char **inbuf, int *bytesLeft, sh
 			mainBits -= (8*offset - prevBitOffset + bitOffset);
 		}
 		/* dequantize coefficients, decode stereo, reorder short blocks */
+		MP3_PROFILE_START(t);
 		if (Dequantize(mp3DecInfo, gr) < 0) {
 			MP3ClearBadFrame(mp3DecInfo, outbuf);
 			return ERR_MP3_INVALID_DEQUANTIZE;			
 		}
+		MP3_PROFILE_STOP(mp3DecInfo, MP3_STAGE_DEQUANT, t);
 
 		/* alias reduction, inverse MDCT, overlap-add, frequency inversion */
+		MP3_PROFILE_START(t);
 		for (ch = 0; ch < mp3DecInfo->nChans; ch++)
 			if (IMDCT(mp3DecInfo, gr, ch) < 0) {
 				MP3ClearBadFrame(mp3DecInfo, outbuf);
 				return ERR_MP3_INVALID_IMDCT;			
 			}
+		MP3_PROFILE_STOP(mp3DecInfo, MP3_STAGE_IMDCT, t);
 
 		/* subband transform - if stereo, interleaves pcm LRLRLR */
-		if (Subband(mp3DecInfo, outbuf + gr*mp3DecInfo->nGranSamps*mp3DecInfo->nChans) < 0) {
+		MP3_PROFILE_START(t);
+		if (Subband(mp3DecInfo, outbuf + gr*mp3DecInfo->nGranSamps*MP3_OUTPUT_CHANS(mp3DecInfo)) < 0) {
 			MP3ClearBadFrame(mp3DecInfo, outbuf);
 			return ERR_MP3_INVALID_SUBBAND;			
 		}
+		MP3_PROFILE_STOP(mp3DecInfo, MP3_STAGE_SUBBAND, t);
 	}
+#ifdef MP3_PROFILE
+	mp3DecInfo->profile.frames++;
+#endif
 	return ERR_MP3_NONE;
 }
+
+/**************************************************************************************
+ * Function:    MP3SetStereoOutput
+ *
+ * Description: output mono streams as interleaved stereo, so the PCM can be sent to
+ *                a stereo sink without another pass over the samples
+ *
+ * Inputs:      valid MP3 decoder instance pointer (HMP3Decoder)
+ *              flag indicating whether mono is duplicated into LRLRLR... (1) or not (0)
+ *
+ * Outputs:     none
+ *
+ * Return:      none
+ *
+ * Notes:       outbuf of MP3Decode must be large enough for the stereo output, and
+ *                outputSamps from MP3GetLastFrameInfo counts both channels
+ **************************************************************************************/
+void MP3SetStereoOutput(HMP3Decoder hMP3Decoder, int stereoOutput)
+{
+	MP3DecInfo *mp3DecInfo = (MP3DecInfo *)hMP3Decoder;
+
+	if (!mp3DecInfo)
+		return;
+
+	mp3DecInfo->stereoOutput = stereoOutput ? 1 : 0;
+}
+
+/**************************************************************************************
+ * Function:    MP3GetProfileInfo
+ *
+ * Description: get the cycles spent in each decoding stage since the decoder was
+ *                created or MP3ClearProfileInfo was called
+ *
+ * Inputs:      valid MP3 decoder instance pointer (HMP3Decoder)
+ *              pointer to MP3ProfileInfo struct
+ *
+ * Outputs:     filled-in MP3ProfileInfo struct (zeroed out if profiling is disabled)
+ *
+ * Return:      error code, defined in mp3dec.h (0 means no error, < 0 means error)
+ *
+ * Notes:       the decoder must be built with MP3_PROFILE, otherwise ERR_UNKNOWN is
+ *                returned
+ **************************************************************************************/
+int MP3GetProfileInfo(HMP3Decoder hMP3Decoder, MP3ProfileInfo *mp3ProfileInfo)
+{
+	MP3DecInfo *mp3DecInfo = (MP3DecInfo *)hMP3Decoder;
+
+	if (!mp3DecInfo || !mp3ProfileInfo)
+		return ERR_MP3_NULL_POINTER;
+
+#ifdef MP3_PROFILE
+	memcpy(mp3ProfileInfo, &mp3DecInfo->profile, sizeof(MP3ProfileInfo));
+	return ERR_MP3_NONE;
+#else
+	memset(mp3ProfileInfo, 0, sizeof(MP3ProfileInfo));
+	return ERR_UNKNOWN;
+#endif
+}
+
+/**************************************************************************************
+ * Function:    MP3ClearProfileInfo
+ *
+ * Description: reset the cycle counts of all decoding stages
+ *
+ * Inputs:      valid MP3 decoder instance pointer (HMP3Decoder)
+ *
+ * Outputs:     none
+ *
+ * Return:      none
+ **************************************************************************************/
+void MP3ClearProfileInfo(HMP3Decoder hMP3Decoder)
+{
+	MP3DecInfo *mp3DecInfo = (MP3DecInfo *)hMP3Decoder;
+
+	if (!mp3DecInfo)
+		return;
+
+#ifdef MP3_PROFILE
+	memset(&mp3DecInfo->profile, 0, sizeof(MP3ProfileInfo));
+#endif
+}
@@ -47,6 +47,24 @@
 #include "mp3dec.h"
 #include "statname.h"	/* do name-mangling for static linking */
 
+/* define MP3_PROFILE to count the cycles of each decoding stage, see MP3GetProfileInfo
+ * MP3_PROFILE_CLOCK() reads a free running 32-bit cycle counter, by default the DWT
+ *   cycle counter of Cortex-M3/M4 (which must be enabled by the application)
+ */
+#ifdef MP3_PROFILE
+#ifndef MP3_PROFILE_CLOCK
+#define MP3_PROFILE_CLOCK()				(*(volatile unsigned int *)0xE0001004)
+#endif
+#define MP3_PROFILE_START(t)			((t) = MP3_PROFILE_CLOCK())
+#define MP3_PROFILE_STOP(dec, stage, t)	((dec)->profile.cycles[stage] += (unsigned int)(MP3_PROFILE_CLOCK() - (t)))
+#else
+#define MP3_PROFILE_START(t)
+#define MP3_PROFILE_STOP(dec, stage, t)
+#endif
+
+/* channels of the PCM output */
+#define MP3_OUTPUT_CHANS(dec)	((dec)->stereoOutput ? 2 : (dec)->nChans)
+
 #define MAX_SCFBD		4		/* max scalefactor bands per channel */
 #define NGRANS_MPEG1	2
 #define NGRANS_MPEG2	1
@@ -92,6 +110,12 @@ typedef struct _MP3DecInfo {
 
 	int part23Length[MAX_NGRAN][MAX_NCHAN];
 
+	/* output mono as interleaved stereo, see MP3SetStereoOutput */
+	int stereoOutput;
+
+#ifdef MP3_PROFILE
+	MP3ProfileInfo profile;
+#endif
 } MP3DecInfo;
 
 typedef struct _SFBandTable {
@@ -102,6 +126,7 @@ typedef struct _SFBandTable {
 /* decoder functions which must be implemented for each platform */
 MP3DecInfo *AllocateBuffers(void);
 void FreeBuffers(MP3DecInfo *mp3DecInfo);
+void ResetBuffers(MP3DecInfo *mp3DecInfo);
 int CheckPadBit(MP3DecInfo *mp3DecInfo);
 int UnpackFrameHeader(MP3DecInfo *mp3DecInfo, unsigned char *buf);
 int UnpackSideInfo(MP3DecInfo *mp3DecInfo, unsigned char *buf);
@@ -111,6 +111,23 @@ enum {
 	ERR_UNKNOWN =                  -9999
 };
 
+/* decoding stages measured by the profiling (see MP3_PROFILE in mp3common.h) */
+enum {
+	MP3_STAGE_HEADER =     0,	/* frame header and side info */
+	MP3_STAGE_SCALEFACT =  1,
+	MP3_STAGE_HUFFMAN =    2,
+	MP3_STAGE_DEQUANT =    3,	/* dequantize, stereo processing, reorder */
+	MP3_STAGE_IMDCT =      4,	/* alias reduction, IMDCT, overlap-add */
+	MP3_STAGE_SUBBAND =    5,	/* polyphase synthesis */
+
+	MP3_NSTAGES
+};
+
+typedef struct _MP3ProfileInfo {
+	unsigned int frames;					/* frames decoded without error */
+	unsigned long long cycles[MP3_NSTAGES];	/* cycles spent in each stage */
+} MP3ProfileInfo;
+
 typedef struct _MP3FrameInfo {
 	int bitrate;
 	int nChans;
@@ -124,12 +141,18 @@ typedef struct _MP3FrameInfo {
 /* public API */
 HMP3Decoder MP3InitDecoder(void);
 void MP3FreeDecoder(HMP3Decoder hMP3Decoder);
+void MP3ResetDecoder(HMP3Decoder hMP3Decoder);
 int MP3Decode(HMP3Decoder hMP3Decoder, unsigned char **inbuf, int *bytesLeft, short *outbuf, int useSize);
 
 void MP3GetLastFrameInfo(HMP3Decoder hMP3Decoder, MP3FrameInfo *mp3FrameInfo);
 int MP3GetNextFrameInfo(HMP3Decoder hMP3Decoder, MP3FrameInfo *mp3FrameInfo, unsigned char *buf);
 int MP3FindSyncWord(unsigned char *buf, int nBytes);
 
+void MP3SetStereoOutput(HMP3Decoder hMP3Decoder, int stereoOutput);
+
+int MP3GetProfileInfo(HMP3Decoder hMP3Decoder, MP3ProfileInfo *mp3ProfileInfo);
+void MP3ClearProfileInfo(HMP3Decoder hMP3Decoder);
+
 #ifdef __cplusplus
 }
 #endif
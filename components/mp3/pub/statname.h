@@ -65,6 +65,7 @@
 #define	UnpackSideInfo		STATNAME(UnpackSideInfo)
 #define	AllocateBuffers		STATNAME(AllocateBuffers)
 #define	FreeBuffers			STATNAME(FreeBuffers)
+#define	ResetBuffers		STATNAME(ResetBuffers)
 #define	DecodeHuffman		STATNAME(DecodeHuffman)
 #define	Dequantize			STATNAME(Dequantize)
 #define	IMDCT				STATNAME(IMDCT)
@@ -184,6 +184,32 @@ MP3DecInfo *AllocateBuffers(void)
 }
 
 
+/**************************************************************************************
+ * Function:    ResetBuffers
+ *
+ * Description: clear the decoding state kept from frame to frame (overlap of IMDCT,
+ *                polyphase filter history, etc.) for a new stream
+ *
+ * Inputs:      pointer to initialized MP3DecInfo structure
+ *
+ * Outputs:     cleared platform-specific data structures
+ *
+ * Return:      none
+ **************************************************************************************/
+void ResetBuffers(MP3DecInfo *mp3DecInfo)
+{
+	if (!mp3DecInfo)
+		return;
+
+	ClearBuffer(mp3DecInfo->FrameHeaderPS,     sizeof(FrameHeader));
+	ClearBuffer(mp3DecInfo->SideInfoPS,        sizeof(SideInfo));
+	ClearBuffer(mp3DecInfo->ScaleFactorInfoPS, sizeof(ScaleFactorInfo));
+	ClearBuffer(mp3DecInfo->HuffmanInfoPS,     sizeof(HuffmanInfo));
+	ClearBuffer(mp3DecInfo->DequantInfoPS,     sizeof(DequantInfo));
+	ClearBuffer(mp3DecInfo->IMDCTInfoPS,       sizeof(IMDCTInfo));
+	ClearBuffer(mp3DecInfo->SubbandInfoPS,     sizeof(SubbandInfo));
+}
+
 #ifndef static_buffers
 #define SAFE_FREE(x)	{if (x)	free(x);	(x) = 0;}	/* helper macro */
 #endif
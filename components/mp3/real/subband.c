@@ -45,6 +45,29 @@
 #include "coder.h"
 #include "assembly.h"
 
+/**************************************************************************************
+ * Function:    MonoToStereo
+ *
+ * Description: duplicate NBANDS mono samples into interleaved stereo, in place
+ *
+ * Inputs:      pcm block of 2*NBANDS samples, mono samples in the upper half
+ *
+ * Outputs:     NBANDS stereo samples, LRLRLR...
+ *
+ * Return:      none
+ **************************************************************************************/
+static void MonoToStereo(short *pcm)
+{
+	int i;
+	short *mono = pcm + NBANDS;
+
+	for (i = 0; i < NBANDS; i++) {
+		short s = mono[i];
+		pcm[2*i+0] = s;
+		pcm[2*i+1] = s;
+	}
+}
+
 /**************************************************************************************
  * Function:    Subband
  *
@@ -81,6 +104,17 @@ int Subband(MP3DecInfo *mp3DecInfo, short *pcmBuf)
 			sbi->vindex = (sbi->vindex - (b & 0x01)) & 7;
 			pcmBuf += (2 * NBANDS);
 		}
+	} else if (mp3DecInfo->stereoOutput) {
+		/* mono output as stereo: polyphase into the upper half of the block,
+		 *   then spread forward (never overwrites a sample not yet read)
+		 */
+		for (b = 0; b < BLOCK_SIZE; b++) {
+			FDCT32(mi->outBuf[0][b], sbi->vbuf + 0*32, sbi->vindex, (b & 0x01), mi->gb[0]);
+			PolyphaseMono(pcmBuf + NBANDS, sbi->vbuf + sbi->vindex + VBUF_LENGTH * (b & 0x01), polyCoef);
+			sbi->vindex = (sbi->vindex - (b & 0x01)) & 7;
+			MonoToStereo(pcmBuf);
+			pcmBuf += (2 * NBANDS);
+		}
 	} else {
 		/* mono */
 		for (b = 0; b < BLOCK_SIZE; b++) {
@@ -47,6 +47,7 @@
 
 #include <rtgui/rtgui.h>
 #include <rtgui/blit.h>
+#include <rtgui/rtgui_system.h>
 
 /* Lookup tables to expand partial bytes to the full 0..255 range */
 
@@ -403,6 +404,280 @@ static void rtgui_blit_line_3_4(rt_uint8_t *dst_ptr, rt_uint8_t *src_ptr, int li
     }
 }
 
+#ifdef RTGUI_BLIT_USING_WORD
+/*
+ * Word-at-a-time kernels. They load and store 32-bit words and convert 2 or
+ * 4 pixels per iteration; the head and the tail of a line, or a line whose
+ * buffers can never reach word alignment, are handled pixel by pixel. The
+ * kernels assume a little endian target (Cortex-M).
+ */
+static rt_bool_t _blit_word_enable = RT_TRUE;
+
+#define _IS_WORD_ALIGNED(p)     ((((rt_ubase_t)(p)) & 0x03) == 0)
+#define _PACK_565(r, g, b)      ((((r) & 0xF8) << 8) | (((g) & 0xFC) << 3) | (((b) & 0xFF) >> 3))
+
+/* 3 bpp (B, G, R) to 2 bpp, 4 pixels per iteration */
+static void rtgui_blit_line_3_2_word(rt_uint8_t *dst_ptr, rt_uint8_t *src_ptr, int line)
+{
+    rt_uint16_t *dst;
+    rt_uint32_t *src32, *dst32;
+    rt_uint32_t w0, w1, w2;
+    int head;
+
+    dst = (rt_uint16_t *)dst_ptr;
+    line = line / 3;
+
+    /* src advances 3 bytes and dst 2 bytes per pixel, try to align both */
+    for (head = 0; head < 4 && line && !(_IS_WORD_ALIGNED(src_ptr) && _IS_WORD_ALIGNED(dst)); head ++)
+    {
+        *dst++ = _PACK_565(src_ptr[2], src_ptr[1], src_ptr[0]);
+        src_ptr += 3;
+        line --;
+    }
+
+    if (_IS_WORD_ALIGNED(src_ptr) && _IS_WORD_ALIGNED(dst))
+    {
+        src32 = (rt_uint32_t *)src_ptr;
+        dst32 = (rt_uint32_t *)dst;
+        while (line >= 4)
+        {
+            w0 = src32[0];
+            w1 = src32[1];
+            w2 = src32[2];
+
+            dst32[0] = (((w0 >> 8) & 0xF800) | ((w0 >> 5) & 0x07E0) | ((w0 >> 3) & 0x001F)) |
+                       (((w1 & 0xF800) | ((w1 << 3) & 0x07E0) | (w0 >> 27)) << 16);
+            dst32[1] = (((w2 << 8) & 0xF800) | ((w1 >> 21) & 0x07E0) | ((w1 >> 19) & 0x001F)) |
+                       ((((w2 >> 16) & 0xF800) | ((w2 >> 13) & 0x07E0) | ((w2 >> 11) & 0x001F)) << 16);
+
+            src32 += 3;
+            dst32 += 2;
+            line -= 4;
+        }
+        src_ptr = (rt_uint8_t *)src32;
+        dst = (rt_uint16_t *)dst32;
+    }
+
+    while (line)
+    {
+        *dst++ = _PACK_565(src_ptr[2], src_ptr[1], src_ptr[0]);
+        src_ptr += 3;
+        line --;
+    }
+}
+
+/* 3 bpp (R, G, B) to 2 bpp, 4 pixels per iteration */
+static void rtgui_blit_line_3_2_inv_word(rt_uint8_t *dst_ptr, rt_uint8_t *src_ptr, int line)
+{
+    rt_uint16_t *dst;
+    rt_uint32_t *src32, *dst32;
+    rt_uint32_t w0, w1, w2;
+    int head;
+
+    dst = (rt_uint16_t *)dst_ptr;
+    line = line / 3;
+
+    for (head = 0; head < 4 && line && !(_IS_WORD_ALIGNED(src_ptr) && _IS_WORD_ALIGNED(dst)); head ++)
+    {
+        *dst++ = _PACK_565(src_ptr[0], src_ptr[1], src_ptr[2]);
+        src_ptr += 3;
+        line --;
+    }
+
+    if (_IS_WORD_ALIGNED(src_ptr) && _IS_WORD_ALIGNED(dst))
+    {
+        src32 = (rt_uint32_t *)src_ptr;
+        dst32 = (rt_uint32_t *)dst;
+        while (line >= 4)
+        {
+            w0 = src32[0];
+            w1 = src32[1];
+            w2 = src32[2];
+
+            dst32[0] = _PACK_565(w0, w0 >> 8, w0 >> 16) |
+                       (_PACK_565(w0 >> 24, w1, w1 >> 8) << 16);
+            dst32[1] = _PACK_565(w1 >> 16, w1 >> 24, w2) |
+                       (_PACK_565(w2 >> 8, w2 >> 16, w2 >> 24) << 16);
+
+            src32 += 3;
+            dst32 += 2;
+            line -= 4;
+        }
+        src_ptr = (rt_uint8_t *)src32;
+        dst = (rt_uint16_t *)dst32;
+    }
+
+    while (line)
+    {
+        *dst++ = _PACK_565(src_ptr[0], src_ptr[1], src_ptr[2]);
+        src_ptr += 3;
+        line --;
+    }
+}
+
+/* 4 bpp (R, G, B, A) to 2 bpp, 2 pixels per iteration */
+static void rtgui_blit_line_4_2_word(rt_uint8_t *dst_ptr, rt_uint8_t *src_ptr, int line)
+{
+    rt_uint16_t *dst;
+    rt_uint32_t *src32, *dst32;
+    rt_uint32_t w0, w1;
+
+    dst = (rt_uint16_t *)dst_ptr;
+    line = line / 4;
+
+    if (line && !_IS_WORD_ALIGNED(dst))
+    {
+        *dst++ = _PACK_565(src_ptr[0], src_ptr[1], src_ptr[2]);
+        src_ptr += 4;
+        line --;
+    }
+
+    if (_IS_WORD_ALIGNED(src_ptr) && _IS_WORD_ALIGNED(dst))
+    {
+        src32 = (rt_uint32_t *)src_ptr;
+        dst32 = (rt_uint32_t *)dst;
+        while (line >= 2)
+        {
+            w0 = src32[0];
+            w1 = src32[1];
+
+            *dst32++ = (((w0 & 0xF8) << 8) | ((w0 >> 5) & 0x07E0) | ((w0 >> 19) & 0x001F)) |
+                       ((((w1 & 0xF8) << 8) | ((w1 >> 5) & 0x07E0) | ((w1 >> 19) & 0x001F)) << 16);
+
+            src32 += 2;
+            line -= 2;
+        }
+        src_ptr = (rt_uint8_t *)src32;
+        dst = (rt_uint16_t *)dst32;
+    }
+
+    while (line)
+    {
+        *dst++ = _PACK_565(src_ptr[0], src_ptr[1], src_ptr[2]);
+        src_ptr += 4;
+        line --;
+    }
+}
+
+/* 4 bpp to 3 bpp, 4 pixels per iteration */
+static void rtgui_blit_line_4_3_word(rt_uint8_t *dst_ptr, rt_uint8_t *src_ptr, int line)
+{
+    rt_uint32_t *src32, *dst32;
+    rt_uint32_t w0, w1, w2, w3;
+
+    line = line / 4;
+
+    while (line && !_IS_WORD_ALIGNED(dst_ptr) && _IS_WORD_ALIGNED(src_ptr))
+    {
+        *dst_ptr++ = src_ptr[0];
+        *dst_ptr++ = src_ptr[1];
+        *dst_ptr++ = src_ptr[2];
+        src_ptr += 4;
+        line --;
+    }
+
+    if (_IS_WORD_ALIGNED(src_ptr) && _IS_WORD_ALIGNED(dst_ptr))
+    {
+        src32 = (rt_uint32_t *)src_ptr;
+        dst32 = (rt_uint32_t *)dst_ptr;
+        while (line >= 4)
+        {
+            w0 = src32[0];
+            w1 = src32[1];
+            w2 = src32[2];
+            w3 = src32[3];
+
+            dst32[0] = (w0 & 0x00FFFFFF) | (w1 << 24);
+            dst32[1] = ((w1 >> 8) & 0x0000FFFF) | (w2 << 16);
+            dst32[2] = ((w2 >> 16) & 0x000000FF) | (w3 << 8);
+
+            src32 += 4;
+            dst32 += 3;
+            line -= 4;
+        }
+        src_ptr = (rt_uint8_t *)src32;
+        dst_ptr = (rt_uint8_t *)dst32;
+    }
+
+    while (line)
+    {
+        *dst_ptr++ = src_ptr[0];
+        *dst_ptr++ = src_ptr[1];
+        *dst_ptr++ = src_ptr[2];
+        src_ptr += 4;
+        line --;
+    }
+}
+
+/* swap R and B of RGB565, 2 pixels per iteration */
+static void rtgui_blit_line_2_2_inv_word(rt_uint8_t *dst_ptr, rt_uint8_t *src_ptr, int line)
+{
+    rt_uint16_t *dst, *src;
+    rt_uint32_t *src32, *dst32;
+    rt_uint32_t w;
+
+    dst = (rt_uint16_t *)dst_ptr;
+    src = (rt_uint16_t *)src_ptr;
+    line = line / 2;
+
+    if (line && !_IS_WORD_ALIGNED(dst) && !_IS_WORD_ALIGNED(src))
+    {
+        *dst++ = ((*src << 11) & 0xF800) | (*src & 0x07E0) | ((*src >> 11) & 0x001F);
+        src ++;
+        line --;
+    }
+
+    if (_IS_WORD_ALIGNED(src) && _IS_WORD_ALIGNED(dst))
+    {
+        src32 = (rt_uint32_t *)src;
+        dst32 = (rt_uint32_t *)dst;
+        while (line >= 2)
+        {
+            w = *src32++;
+            *dst32++ = ((w << 11) & 0xF800F800) | (w & 0x07E007E0) | ((w >> 11) & 0x001F001F);
+            line -= 2;
+        }
+        src = (rt_uint16_t *)src32;
+        dst = (rt_uint16_t *)dst32;
+    }
+
+    while (line)
+    {
+        *dst++ = ((*src << 11) & 0xF800) | (*src & 0x07E0) | ((*src >> 11) & 0x001F);
+        src ++;
+        line --;
+    }
+}
+
+static const rtgui_blit_line_func _blit_word_table[5][5] =
+{
+    /* 0_0, 1_0, 2_0, 3_0, 4_0 */
+    {RT_NULL, RT_NULL, RT_NULL, RT_NULL, RT_NULL },
+    /* 0_1, 1_1, 2_1, 3_1, 4_1 */
+    {RT_NULL, RT_NULL, RT_NULL, RT_NULL, RT_NULL },
+    /* 0_2, 1_2, 2_2, 3_2, 4_2 */
+    {RT_NULL, RT_NULL, RT_NULL, rtgui_blit_line_3_2_word, rtgui_blit_line_4_2_word },
+    /* 0_3, 1_3, 2_3, 3_3, 4_3 */
+    {RT_NULL, RT_NULL, RT_NULL, RT_NULL, rtgui_blit_line_4_3_word },
+    /* 0_4, 1_4, 2_4, 3_4, 4_4 */
+    {RT_NULL, RT_NULL, RT_NULL, RT_NULL, RT_NULL },
+};
+
+static const rtgui_blit_line_func _blit_word_table_inv[5][5] =
+{
+    /* 0_0, 1_0, 2_0, 3_0, 4_0 */
+    {RT_NULL, RT_NULL, RT_NULL, RT_NULL, RT_NULL },
+    /* 0_1, 1_1, 2_1, 3_1, 4_1 */
+    {RT_NULL, RT_NULL, RT_NULL, RT_NULL, RT_NULL },
+    /* 0_2, 1_2, 2_2, 3_2, 4_2 */
+    {RT_NULL, RT_NULL, rtgui_blit_line_2_2_inv_word, rtgui_blit_line_3_2_inv_word, rtgui_blit_line_4_2_word },
+    /* 0_3, 1_3, 2_3, 3_3, 4_3 */
+    {RT_NULL, RT_NULL, RT_NULL, RT_NULL, rtgui_blit_line_4_3_word },
+    /* 0_4, 1_4, 2_4, 3_4, 4_4 */
+    {RT_NULL, RT_NULL, RT_NULL, RT_NULL, RT_NULL },
+};
+#endif
+
 static const rtgui_blit_line_func _blit_table[5][5] =
 {
     /* 0_0, 1_0, 2_0, 3_0, 4_0 */
@@ -422,8 +697,14 @@ rtgui_blit_line_func rtgui_blit_line_get(int dst_bpp, int src_bpp)
     RT_ASSERT(dst_bpp > 0 && dst_bpp < 5);
     RT_ASSERT(src_bpp > 0 && src_bpp < 5);
 
+#ifdef RTGUI_BLIT_USING_WORD
+    if (_blit_word_enable && _blit_word_table[dst_bpp][src_bpp] != RT_NULL)
+        return _blit_word_table[dst_bpp][src_bpp];
+#endif
+
     return _blit_table[dst_bpp][src_bpp];
 }
+RTM_EXPORT(rtgui_blit_line_get);
 
 
 static void rtgui_blit_line_3_2_inv(rt_uint8_t *dst_ptr, rt_uint8_t *src_ptr, int line)
@@ -481,6 +762,129 @@ rtgui_blit_line_func rtgui_blit_line_get_inv(int dst_bpp, int src_bpp)
     RT_ASSERT(dst_bpp > 0 && dst_bpp < 5);
     RT_ASSERT(src_bpp > 0 && src_bpp < 5);
 
+#ifdef RTGUI_BLIT_USING_WORD
+    if (_blit_word_enable && _blit_word_table_inv[dst_bpp][src_bpp] != RT_NULL)
+        return _blit_word_table_inv[dst_bpp][src_bpp];
+#endif
+
     return _blit_table_inv[dst_bpp][src_bpp];
 }
+RTM_EXPORT(rtgui_blit_line_get_inv);
+
+/* enable or disable the word-at-a-time kernels, mainly for benchmark */
+void rtgui_blit_line_set_word(rt_bool_t enable)
+{
+#ifdef RTGUI_BLIT_USING_WORD
+    _blit_word_enable = enable;
+#endif
+}
+RTM_EXPORT(rtgui_blit_line_set_word);
+
+/*
+ * copy the pixels of rect to rect + (dx, dy) in the same pixel memory. The
+ * rows are walked against the moving direction, so the overlapped source is
+ * read before it's overwritten.
+ */
+void rtgui_blit_copy_rect(rt_uint8_t *pixels, int pitch, int bpp,
+                          const rtgui_rect_t *rect, int dx, int dy)
+{
+    int y, size;
+    rt_uint8_t *src, *dst;
+
+    if (rect->x1 >= rect->x2 || rect->y1 >= rect->y2) return;
+    if (dx == 0 && dy == 0) return;
+
+    size = (rect->x2 - rect->x1) * bpp;
+    src = pixels + rect->y1 * pitch + rect->x1 * bpp;
+    dst = src + dy * pitch + dx * bpp;
+    if (dy > 0)
+    {
+        /* from the bottom row */
+        src += (rect->y2 - rect->y1 - 1) * pitch;
+        dst += (rect->y2 - rect->y1 - 1) * pitch;
+        pitch = -pitch;
+    }
+
+    for (y = rect->y1; y < rect->y2; y ++)
+    {
+        /* the rows overlap in horizontal scrolling */
+        rt_memmove(dst, src, size);
+        src += pitch;
+        dst += pitch;
+    }
+}
+RTM_EXPORT(rtgui_blit_copy_rect);
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+static rt_uint32_t _blit_bench_one(rtgui_blit_line_func func, rt_uint8_t *dst, rt_uint8_t *src,
+                                   int line, int loops)
+{
+    rt_tick_t tick;
+    int index;
+
+    tick = rt_tick_get();
+    for (index = 0; index < loops; index ++)
+        func(dst, src, line);
+    tick = rt_tick_get() - tick;
+    if (tick == 0) tick = 1;
+
+    /* KB/s of source data */
+    return (rt_uint32_t)(line * loops / 1024) * RT_TICK_PER_SECOND / tick;
+}
+
+void blit_bench(int pixels, int loops)
+{
+    int dst_bpp, src_bpp;
+    rt_uint8_t *src, *dst;
+    rt_uint32_t generic, word;
+    rtgui_blit_line_func func;
+
+    if (pixels <= 0) pixels = 800;
+    if (loops <= 0) loops = 1000;
+
+    src = (rt_uint8_t *)rtgui_malloc(pixels * 4);
+    dst = (rt_uint8_t *)rtgui_malloc(pixels * 4);
+    if (src == RT_NULL || dst == RT_NULL)
+    {
+        rt_kprintf("no memory\n");
+        goto __exit;
+    }
+    for (src_bpp = 0; src_bpp < pixels * 4; src_bpp ++)
+        src[src_bpp] = (rt_uint8_t)src_bpp;
+
+    rt_kprintf("dst src    generic(MB/s)   word(MB/s)  inv generic(MB/s)  inv word(MB/s)\n");
+    for (dst_bpp = 1; dst_bpp < 5; dst_bpp ++)
+    {
+        for (src_bpp = 1; src_bpp < 5; src_bpp ++)
+        {
+            rt_kprintf("%d   %d  ", dst_bpp, src_bpp);
+
+            rtgui_blit_line_set_word(RT_FALSE);
+            func = rtgui_blit_line_get(dst_bpp, src_bpp);
+            generic = _blit_bench_one(func, dst, src, pixels * src_bpp, loops);
+            rtgui_blit_line_set_word(RT_TRUE);
+            func = rtgui_blit_line_get(dst_bpp, src_bpp);
+            word = _blit_bench_one(func, dst, src, pixels * src_bpp, loops);
+            rt_kprintf("  %6d.%03d    %6d.%03d", generic / 1024, (generic % 1024) * 1000 / 1024,
+                       word / 1024, (word % 1024) * 1000 / 1024);
+
+            rtgui_blit_line_set_word(RT_FALSE);
+            func = rtgui_blit_line_get_inv(dst_bpp, src_bpp);
+            generic = _blit_bench_one(func, dst, src, pixels * src_bpp, loops);
+            rtgui_blit_line_set_word(RT_TRUE);
+            func = rtgui_blit_line_get_inv(dst_bpp, src_bpp);
+            word = _blit_bench_one(func, dst, src, pixels * src_bpp, loops);
+            rt_kprintf("       %6d.%03d       %6d.%03d\n", generic / 1024, (generic % 1024) * 1000 / 1024,
+                       word / 1024, (word % 1024) * 1000 / 1024);
+        }
+    }
+
+__exit:
+    if (src != RT_NULL) rtgui_free(src);
+    if (dst != RT_NULL) rtgui_free(dst);
+}
+FINSH_FUNCTION_EXPORT(blit_bench, benchmark blit line: blit_bench(pixels, loops));
+#endif
+
 
@@ -15,7 +15,9 @@
  * 2011-04-25     Bernard      fix fill polygon issue, which found by loveic
  */
 #include <rtgui/dc.h>
+#include <rtgui/blit.h>
 #include <rtgui/rtgui_system.h>
+#include <rtgui/widgets/window.h>
 
 #include <string.h> /* for strlen */
 #include <stdlib.h> /* fir qsort  */
@@ -31,6 +33,61 @@ static int _int_compare(const void *a, const void *b)
     return (*(const int *) a) - (*(const int *) b);
 }
 
+/*
+ * The 2D engine of graphic driver (ext_ops) draws without clip, so a
+ * primitive is routed to it only when its bounding box is covered by the
+ * visible region of owner. Otherwise it's rasterized by software.
+ */
+static rt_uint32_t _dc_accel_routed, _dc_accel_fallback;
+
+/* get the ext_ops for a primitive in rect, which is converted to device */
+static const struct rtgui_graphic_ext_ops *_dc_get_ext_ops(struct rtgui_dc *dc, rtgui_rect_t *rect)
+{
+    rtgui_widget_t *owner;
+    const struct rtgui_graphic_ext_ops *ext_ops;
+
+    /* the driver on the back buffer of window has no ext_ops */
+    ext_ops = rtgui_dc_get_driver(dc)->ext_ops;
+    if (ext_ops == RT_NULL) return RT_NULL;
+
+    if (dc->type == RTGUI_DC_HW)
+        owner = ((struct rtgui_dc_hw *) dc)->owner;
+    else if (dc->type == RTGUI_DC_CLIENT)
+        owner = RTGUI_CONTAINER_OF(dc, struct rtgui_widget, dc_type);
+    else
+        return RT_NULL;
+    if (!RTGUI_WIDGET_IS_DC_VISIBLE(owner)) return RT_NULL;
+
+    if (rect->x1 >= rect->x2 || rect->y1 >= rect->y2) return RT_NULL;
+    rtgui_rect_moveto(rect, owner->extent.x1, owner->extent.y1);
+    if (rtgui_region_contains_rectangle(&(owner->clip), rect) != RTGUI_REGION_IN)
+    {
+        _dc_accel_fallback ++;
+        return RT_NULL;
+    }
+
+    _dc_accel_routed ++;
+    return ext_ops;
+}
+
+const struct rtgui_graphic_driver *rtgui_dc_get_driver(struct rtgui_dc *dc)
+{
+    rtgui_widget_t *owner;
+
+    if (dc->type == RTGUI_DC_HW)
+        return ((struct rtgui_dc_hw *) dc)->hw_driver;
+
+    if (dc->type == RTGUI_DC_CLIENT)
+    {
+        owner = RTGUI_CONTAINER_OF(dc, struct rtgui_widget, dc_type);
+        if (owner->toplevel != RT_NULL && RTGUI_IS_WIN(owner->toplevel))
+            return rtgui_win_get_driver(RTGUI_WIN(owner->toplevel));
+    }
+
+    return rtgui_graphic_driver_get_default();
+}
+RTM_EXPORT(rtgui_dc_get_driver);
+
 void rtgui_dc_destory(struct rtgui_dc *dc)
 {
     if (dc == RT_NULL) return;
@@ -40,6 +97,79 @@ void rtgui_dc_destory(struct rtgui_dc *dc)
 }
 RTM_EXPORT(rtgui_dc_destory);
 
+/*
+ * Scroll the pixels in rect by (dx, dy). The pixels moved out of rect are
+ * dropped, and the part of rect left to be repainted is returned in exposed,
+ * which is initialized by caller. When the pixels can't be moved, e.g. the
+ * rect is partly covered or the device has no block transfer, the whole rect
+ * is exposed and -RT_ERROR is returned.
+ */
+rt_err_t rtgui_dc_scroll(struct rtgui_dc *dc, rtgui_rect_t *rect, int dx, int dy,
+                         rtgui_region_t *exposed)
+{
+    rt_err_t result = -RT_ERROR;
+    rtgui_rect_t src, dst;
+    rtgui_widget_t *owner;
+
+    RT_ASSERT(dc != RT_NULL);
+    RT_ASSERT(rect != RT_NULL);
+
+    /* the destination of moved pixels, which stay in rect */
+    dst = *rect;
+    rtgui_rect_moveto(&dst, dx, dy);
+    rtgui_rect_intersect(rect, &dst);
+    src = dst;
+    rtgui_rect_moveto(&src, -dx, -dy);
+
+    if (dst.x1 < dst.x2 && dst.y1 < dst.y2 && (dx != 0 || dy != 0))
+    {
+        if (dc->type == RTGUI_DC_BUFFER)
+        {
+            struct rtgui_dc_buffer *buffer = (struct rtgui_dc_buffer *) dc;
+
+            if (src.x1 >= 0 && src.y1 >= 0 && dst.x1 >= 0 && dst.y1 >= 0 &&
+                src.x2 <= buffer->width && src.y2 <= buffer->height &&
+                dst.x2 <= buffer->width && dst.y2 <= buffer->height)
+            {
+                rtgui_blit_copy_rect(buffer->pixel, buffer->pitch, sizeof(rtgui_color_t),
+                                     &src, dx, dy);
+                result = RT_EOK;
+            }
+        }
+        else if (dc->type == RTGUI_DC_HW || dc->type == RTGUI_DC_CLIENT)
+        {
+            rtgui_rect_t device;
+
+            if (dc->type == RTGUI_DC_HW)
+                owner = ((struct rtgui_dc_hw *) dc)->owner;
+            else
+                owner = RTGUI_CONTAINER_OF(dc, struct rtgui_widget, dc_type);
+
+            /* both source and destination shall be visible on device */
+            device = *rect;
+            rtgui_rect_moveto(&device, owner->extent.x1, owner->extent.y1);
+            if (RTGUI_WIDGET_IS_DC_VISIBLE(owner) &&
+                rtgui_region_contains_rectangle(&(owner->clip), &device) == RTGUI_REGION_IN)
+            {
+                rtgui_rect_moveto(&src, owner->extent.x1, owner->extent.y1);
+                result = rtgui_graphic_driver_copy_rect(rtgui_dc_get_driver(dc),
+                                                        &src, dx, dy);
+                if (result != RT_EOK) result = -RT_ERROR;
+            }
+        }
+    }
+
+    if (exposed != RT_NULL)
+    {
+        rtgui_region_reset(exposed, rect);
+        if (result == RT_EOK)
+            rtgui_region_subtract_rect(exposed, exposed, &dst);
+    }
+
+    return result;
+}
+RTM_EXPORT(rtgui_dc_scroll);
+
 void rtgui_dc_draw_line(struct rtgui_dc *dc, int x1, int y1, int x2, int y2)
 {
     if (dc == RT_NULL) return;
@@ -56,7 +186,22 @@ void rtgui_dc_draw_line(struct rtgui_dc *dc, int x1, int y1, int x2, int y2)
     {
         int dx, dy, sdx, sdy, dxabs, dyabs, x, y, px, py;
         register rt_base_t i;
-        /* rtgui_rect_t rect; */
+        rtgui_rect_t rect;
+        const struct rtgui_graphic_ext_ops *ext_ops;
+
+        rect.x1 = x1 < x2 ? x1 : x2;
+        rect.x2 = (x1 < x2 ? x2 : x1) + 1;
+        rect.y1 = y1 < y2 ? y1 : y2;
+        rect.y2 = (y1 < y2 ? y2 : y1) + 1;
+        ext_ops = _dc_get_ext_ops(dc, &rect);
+        if (ext_ops != RT_NULL && ext_ops->draw_line != RT_NULL)
+        {
+            /* the rect is moved to device by the offset of owner */
+            dx = rect.x1 - (x1 < x2 ? x1 : x2);
+            dy = rect.y1 - (y1 < y2 ? y1 : y2);
+            ext_ops->draw_line(&RTGUI_DC_FC(dc), x1 + dx, y1 + dy, x2 + dx, y2 + dy);
+            return;
+        }
 
         dx = x2 - x1;       /* the horizontal distance of the line */
         dy = y2 - y1;       /* the vertical distance of the line */
@@ -155,6 +300,17 @@ RTM_EXPORT(rtgui_dc_draw_vertical_line);
 
 void rtgui_dc_draw_rect(struct rtgui_dc *dc, struct rtgui_rect *rect)
 {
+    rtgui_rect_t device;
+    const struct rtgui_graphic_ext_ops *ext_ops;
+
+    device = *rect;
+    ext_ops = _dc_get_ext_ops(dc, &device);
+    if (ext_ops != RT_NULL && ext_ops->draw_rect != RT_NULL)
+    {
+        ext_ops->draw_rect(&RTGUI_DC_FC(dc), device.x1, device.y1, device.x2 - 1, device.y2 - 1);
+        return;
+    }
+
     rtgui_dc_draw_hline(dc, rect->x1, rect->x2, rect->y1);
     rtgui_dc_draw_hline(dc, rect->x1, rect->x2, rect->y2 - 1);
 
@@ -166,6 +322,16 @@ RTM_EXPORT(rtgui_dc_draw_rect);
 void rtgui_dc_fill_rect_forecolor(struct rtgui_dc *dc, struct rtgui_rect *rect)
 {
     int i = 0;
+    rtgui_rect_t device;
+    const struct rtgui_graphic_ext_ops *ext_ops;
+
+    device = *rect;
+    ext_ops = _dc_get_ext_ops(dc, &device);
+    if (ext_ops != RT_NULL && ext_ops->fill_rect != RT_NULL)
+    {
+        ext_ops->fill_rect(&RTGUI_DC_FC(dc), device.x1, device.y1, device.x2 - 1, device.y2 - 1);
+        return;
+    }
 
     rtgui_dc_draw_rect(dc, rect);
     do
@@ -548,6 +714,8 @@ void rtgui_dc_draw_circle(struct rtgui_dc *dc, int x, int y, int r)
     rt_int16_t d_se = -2 * r + 5;
     rt_int16_t xpcx, xmcx, xpcy, xmcy;
     rt_int16_t ypcy, ymcy, ypcx, ymcx;
+    rtgui_rect_t rect;
+    const struct rtgui_graphic_ext_ops *ext_ops;
 
     /*
      * sanity check radius
@@ -557,6 +725,17 @@ void rtgui_dc_draw_circle(struct rtgui_dc *dc, int x, int y, int r)
     /* special case for r=0 - draw a point  */
     if (r == 0) rtgui_dc_draw_point(dc, x, y);
 
+    rect.x1 = x - r;
+    rect.y1 = y - r;
+    rect.x2 = x + r + 1;
+    rect.y2 = y + r + 1;
+    ext_ops = _dc_get_ext_ops(dc, &rect);
+    if (ext_ops != RT_NULL && ext_ops->draw_circle != RT_NULL)
+    {
+        ext_ops->draw_circle(&RTGUI_DC_FC(dc), rect.x1 + r, rect.y1 + r, r);
+        return;
+    }
+
     /*
      * draw circle
      */
@@ -628,6 +807,8 @@ void rtgui_dc_fill_circle(struct rtgui_dc *dc, rt_int16_t x, rt_int16_t y, rt_in
     rt_int16_t d_se = -2 * r + 5;
     rt_int16_t xpcx, xmcx, xpcy, xmcy;
     rt_int16_t ypcy, ymcy, ypcx, ymcx;
+    rtgui_rect_t rect;
+    const struct rtgui_graphic_ext_ops *ext_ops;
 
     /*
      * Sanity check radius
@@ -643,6 +824,17 @@ void rtgui_dc_fill_circle(struct rtgui_dc *dc, rt_int16_t x, rt_int16_t y, rt_in
         return ;
     }
 
+    rect.x1 = x - r;
+    rect.y1 = y - r;
+    rect.x2 = x + r + 1;
+    rect.y2 = y + r + 1;
+    ext_ops = _dc_get_ext_ops(dc, &rect);
+    if (ext_ops != RT_NULL && ext_ops->fill_circle != RT_NULL)
+    {
+        ext_ops->fill_circle(&RTGUI_DC_FC(dc), rect.x1 + r, rect.y1 + r, r);
+        return;
+    }
+
     /*
      * Draw
      */
@@ -1057,6 +1249,8 @@ RTM_EXPORT(rtgui_dc_fill_sector);
 void rtgui_dc_draw_ellipse(struct rtgui_dc *dc, rt_int16_t x, rt_int16_t y, rt_int16_t rx, rt_int16_t ry)
 {
     int ix, iy;
+    rtgui_rect_t rect;
+    const struct rtgui_graphic_ext_ops *ext_ops;
     int h, i, j, k;
     int oh, oi, oj, ok;
     int xmh, xph, ypk, ymk;
@@ -1087,6 +1281,17 @@ void rtgui_dc_draw_ellipse(struct rtgui_dc *dc, rt_int16_t x, rt_int16_t y, rt_i
         return;
     }
 
+    rect.x1 = x - rx;
+    rect.y1 = y - ry;
+    rect.x2 = x + rx + 1;
+    rect.y2 = y + ry + 1;
+    ext_ops = _dc_get_ext_ops(dc, &rect);
+    if (ext_ops != RT_NULL && ext_ops->draw_ellipse != RT_NULL)
+    {
+        ext_ops->draw_ellipse(&RTGUI_DC_FC(dc), rect.x1 + rx, rect.y1 + ry, rx, ry);
+        return;
+    }
+
     /*
      * Init vars
      */
@@ -1208,6 +1413,8 @@ RTM_EXPORT(rtgui_dc_draw_ellipse);
 void rtgui_dc_fill_ellipse(struct rtgui_dc *dc, rt_int16_t x, rt_int16_t y, rt_int16_t rx, rt_int16_t ry)
 {
     int ix, iy;
+    rtgui_rect_t rect;
+    const struct rtgui_graphic_ext_ops *ext_ops;
     int h, i, j, k;
     int oh, oi, oj, ok;
     int xmh, xph;
@@ -1231,6 +1438,17 @@ void rtgui_dc_fill_ellipse(struct rtgui_dc *dc, rt_int16_t x, rt_int16_t y, rt_i
         return;
     }
 
+    rect.x1 = x - rx;
+    rect.y1 = y - ry;
+    rect.x2 = x + rx + 1;
+    rect.y2 = y + ry + 1;
+    ext_ops = _dc_get_ext_ops(dc, &rect);
+    if (ext_ops != RT_NULL && ext_ops->fill_ellipse != RT_NULL)
+    {
+        ext_ops->fill_ellipse(&RTGUI_DC_FC(dc), rect.x1 + rx, rect.y1 + ry, rx, ry);
+        return;
+    }
+
     /*
      * Init vars
      */
@@ -1338,3 +1556,12 @@ void rtgui_dc_fill_ellipse(struct rtgui_dc *dc, rt_int16_t x, rt_int16_t y, rt_i
 }
 RTM_EXPORT(rtgui_dc_fill_ellipse);
 
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+void list_dc_accel(void)
+{
+    rt_kprintf("primitives routed to 2D engine: %d, rasterized for clip: %d\n",
+               _dc_accel_routed, _dc_accel_fallback);
+}
+FINSH_FUNCTION_EXPORT(list_dc_accel, list the routing of primitives to 2D engine);
+#endif
@@ -47,7 +47,6 @@
 #include <rtgui/color.h>
 #include <string.h>
 
-#define hw_driver               (rtgui_graphic_driver_get_default())
 #define _int_swap(x, y)         do {x ^= y; y ^= x; x ^= y;} while (0)
 
 rt_inline rt_uint8_t _dc_get_pixel_format(struct rtgui_dc* dc)
@@ -55,7 +54,7 @@ rt_inline rt_uint8_t _dc_get_pixel_format(struct rtgui_dc* dc)
 	rt_uint8_t pixel_format = 0xff;
 
 	if (dc->type == RTGUI_DC_HW || dc->type == RTGUI_DC_CLIENT)
-		pixel_format = hw_driver->pixel_format;
+		pixel_format = rtgui_dc_get_driver(dc)->pixel_format;
 	else if (dc->type == RTGUI_DC_BUFFER)
 		pixel_format = RTGRAPHIC_PIXEL_FORMAT_ARGB888;
 
@@ -67,7 +66,7 @@ rt_inline rt_uint8_t _dc_get_bits_per_pixel(struct rtgui_dc* dc)
 	rt_uint8_t bits_per_pixel = 0;
 
 	if (dc->type == RTGUI_DC_HW || dc->type == RTGUI_DC_CLIENT)
-		bits_per_pixel = hw_driver->bits_per_pixel;
+		bits_per_pixel = rtgui_dc_get_driver(dc)->bits_per_pixel;
 	else if (dc->type == RTGUI_DC_BUFFER)
 		bits_per_pixel = 32;
 
@@ -79,7 +78,7 @@ rt_inline rt_uint16_t _dc_get_pitch(struct rtgui_dc* dc)
 	rt_uint16_t pitch = 0;
 
 	if (dc->type == RTGUI_DC_HW || dc->type == RTGUI_DC_CLIENT)
-		pitch = hw_driver->pitch;
+		pitch = rtgui_dc_get_driver(dc)->pitch;
 	else if (dc->type == RTGUI_DC_BUFFER)
 	{
 		struct rtgui_dc_buffer *dc_buffer;
@@ -97,6 +96,8 @@ rt_inline rt_uint8_t* _dc_get_pixel(struct rtgui_dc* dc, int x, int y)
 
 	if ((dc->type == RTGUI_DC_HW) || (dc->type == RTGUI_DC_CLIENT))
 	{
+		const struct rtgui_graphic_driver *hw_driver = rtgui_dc_get_driver(dc);
+
 		pixel = (rt_uint8_t*)(hw_driver->framebuffer);
 		pixel = pixel + y * hw_driver->pitch + x * (hw_driver->bits_per_pixel/8);
 	}
@@ -112,6 +113,206 @@ rt_inline rt_uint8_t* _dc_get_pixel(struct rtgui_dc* dc, int x, int y)
 	return pixel;
 }
 
+/*
+ * The span kernels of blend fill. The 565 pixel is spread as
+ * 00000GGGGGG00000RRRRR000000BBBBB, which leaves room above each field for the
+ * multiply of 5 bits alpha, and the pixels are accessed in pairs of 32 bits
+ * word. The ARGB8888 pixel is weighted in two lanes of 0x00FF00FF.
+ */
+#define BLEND_SPREAD_565(p)     ((((rt_uint32_t)(p) << 16) | (p)) & 0x07E0F81F)
+#define BLEND_PACK_565(c)       ((rt_uint16_t)(((c) & 0xF81F) | (((c) >> 16) & 0x07E0)))
+/* half of 32 in each field of spread pixel, to round the blend */
+#define BLEND_ROUND_565         0x02008010
+/* the pixels of a row read from the graphic device without framebuffer */
+#define BLEND_LINE_PIXELS       64
+
+struct _dc_blend_span
+{
+	/* the pixel of color, repeated in both half words for 565 */
+	rt_uint32_t pixel;
+	/* the weighted color and the weight of destination */
+	rt_uint32_t src;
+	rt_uint32_t inva;
+};
+
+typedef void (*BlendSpanFunc)(rt_uint8_t *pixel, int width, const struct _dc_blend_span *span);
+
+rt_inline rt_uint16_t _dc_blend_565(rt_uint16_t pixel, rt_uint32_t src, rt_uint32_t inva)
+{
+	rt_uint32_t dst = BLEND_SPREAD_565(pixel);
+
+	return BLEND_PACK_565(((dst * inva + src) >> 5) & 0x07E0F81F);
+}
+
+/* the pixel of color in the 565 format of graphic driver */
+rt_inline rt_uint16_t _dc_color_to_565(rt_uint8_t pixel_format, rtgui_color_t color)
+{
+	if (pixel_format == RTGRAPHIC_PIXEL_FORMAT_RGB565)
+		return rtgui_color_to_565(color);
+
+	return rtgui_color_to_565p(color);
+}
+
+static void _dc_span_fill_565(rt_uint8_t *pixel, int width, const struct _dc_blend_span *span)
+{
+	rt_uint16_t *ptr = (rt_uint16_t *)pixel;
+
+	if (((rt_ubase_t)ptr & 0x02) && width > 0)
+	{
+		*ptr++ = (rt_uint16_t)span->pixel;
+		width --;
+	}
+	for (; width >= 2; width -= 2, ptr += 2)
+		*(rt_uint32_t *)ptr = span->pixel;
+	if (width > 0)
+		*ptr = (rt_uint16_t)span->pixel;
+}
+
+static void _dc_span_blend_565(rt_uint8_t *pixel, int width, const struct _dc_blend_span *span)
+{
+	rt_uint32_t pair;
+	rt_uint16_t *ptr = (rt_uint16_t *)pixel;
+
+	if (((rt_ubase_t)ptr & 0x02) && width > 0)
+	{
+		*ptr = _dc_blend_565(*ptr, span->src, span->inva);
+		ptr ++;
+		width --;
+	}
+	for (; width >= 2; width -= 2, ptr += 2)
+	{
+		pair = *(rt_uint32_t *)ptr;
+		*(rt_uint32_t *)ptr = _dc_blend_565(pair & 0xFFFF, span->src, span->inva) |
+		                      ((rt_uint32_t)_dc_blend_565(pair >> 16, span->src, span->inva) << 16);
+	}
+	if (width > 0)
+		*ptr = _dc_blend_565(*ptr, span->src, span->inva);
+}
+
+static void _dc_span_fill_8888(rt_uint8_t *pixel, int width, const struct _dc_blend_span *span)
+{
+	rt_uint32_t *ptr = (rt_uint32_t *)pixel;
+
+	while (width-- > 0)
+		*ptr++ = span->pixel;
+}
+
+/* keep the alpha of destination as DRAW_SETPIXEL_BLEND_ARGB8888 */
+static void _dc_span_blend_8888(rt_uint8_t *pixel, int width, const struct _dc_blend_span *span)
+{
+	rt_uint32_t dst, rb, g;
+	rt_uint32_t *ptr = (rt_uint32_t *)pixel;
+
+	while (width-- > 0)
+	{
+		dst = *ptr;
+
+		/* x * inva / 255 with rounding in each lane */
+		rb = (dst & 0x00FF00FF) * span->inva + 0x00800080;
+		rb = ((rb + ((rb >> 8) & 0x00FF00FF)) >> 8) & 0x00FF00FF;
+		g  = ((dst >> 8) & 0xFF) * span->inva + 0x80;
+		g  = ((g + (g >> 8)) >> 8) & 0xFF;
+
+		*ptr++ = (dst & 0xFF000000) | (rb + (span->src & 0x00FF00FF)) |
+		         ((g + ((span->src >> 8) & 0xFF)) << 8);
+	}
+}
+
+/*
+ * Get the span kernel of blend fill for the format of dc, RT_NULL to use the
+ * generic blend operators. The color is not premultiplied.
+ */
+static BlendSpanFunc _dc_blend_span_prepare(struct rtgui_dc *dst, enum RTGUI_BLENDMODE blendMode,
+		rtgui_color_t color, struct _dc_blend_span *span)
+{
+	rt_uint32_t a;
+	rt_uint8_t pixel_format;
+
+	if (blendMode != RTGUI_BLENDMODE_NONE && blendMode != RTGUI_BLENDMODE_BLEND)
+		return RT_NULL;
+
+	a = RTGUI_RGB_A(color);
+	pixel_format = _dc_get_pixel_format(dst);
+	if (pixel_format == RTGRAPHIC_PIXEL_FORMAT_RGB565 ||
+		pixel_format == RTGRAPHIC_PIXEL_FORMAT_RGB565P)
+	{
+		span->pixel = _dc_color_to_565(pixel_format, color);
+		span->pixel |= span->pixel << 16;
+
+		/* the opaque color is filled directly */
+		if (blendMode == RTGUI_BLENDMODE_NONE || a == 0xff)
+			return _dc_span_fill_565;
+
+		a = (a + 4) >> 3;
+		span->src = BLEND_SPREAD_565(span->pixel & 0xFFFF) * a + BLEND_ROUND_565;
+		span->inva = 32 - a;
+		return _dc_span_blend_565;
+	}
+	else if (pixel_format == RTGRAPHIC_PIXEL_FORMAT_ARGB888)
+	{
+		if (blendMode == RTGUI_BLENDMODE_NONE)
+		{
+			ARGB8888_FROM_RGBA(span->pixel, RTGUI_RGB_R(color), RTGUI_RGB_G(color),
+							   RTGUI_RGB_B(color), a);
+			return _dc_span_fill_8888;
+		}
+
+		RGB888_FROM_RGB(span->src, DRAW_MUL(RTGUI_RGB_R(color), a),
+						DRAW_MUL(RTGUI_RGB_G(color), a), DRAW_MUL(RTGUI_RGB_B(color), a));
+		span->inva = 0xff - a;
+		return _dc_span_blend_8888;
+	}
+
+	return RT_NULL;
+}
+
+static void _dc_blend_fill_rect_span(struct rtgui_dc *dst, const rtgui_rect_t *rect,
+		BlendSpanFunc func, const struct _dc_blend_span *span)
+{
+	int x, y, width, count;
+	rt_uint8_t *pixel;
+	rt_uint16_t line[BLEND_LINE_PIXELS];
+	const struct rtgui_graphic_driver *hw_driver = rtgui_dc_get_driver(dst);
+
+	width = rect->x2 - rect->x1;
+	if (width <= 0) return;
+
+	if (_dc_get_pixel(dst, 0, 0) != RT_NULL)
+	{
+		int pitch = _dc_get_pitch(dst);
+
+		pixel = _dc_get_pixel(dst, rect->x1, rect->y1);
+		for (y = rect->y1; y < rect->y2; y ++)
+		{
+			func(pixel, width, span);
+			pixel += pitch;
+		}
+		return;
+	}
+
+	/* the graphic device has no framebuffer, e.g. RA8875. Read the pixels of a
+	 * row, blend them and write back in one burst. */
+	if (_dc_get_bits_per_pixel(dst) != 16 || hw_driver->device == RT_NULL) return;
+	for (y = rect->y1; y < rect->y2; y ++)
+	{
+		for (x = rect->x1; x < rect->x2; x += count)
+		{
+			count = rect->x2 - x;
+			if (count > BLEND_LINE_PIXELS) count = BLEND_LINE_PIXELS;
+
+			if (func != _dc_span_fill_565)
+			{
+				int index;
+
+				for (index = 0; index < count; index ++)
+					rt_graphix_ops(hw_driver->device)->get_pixel((char *)&line[index], x + index, y);
+			}
+			func((rt_uint8_t *)line, count, span);
+			hw_driver->ops->draw_raw_hline((rt_uint8_t *)line, x, x + count, y);
+		}
+	}
+}
+
 
 /* Use the Cohen-Sutherland algorithm for line clipping */
 #define CODE_BOTTOM 1
@@ -288,10 +489,31 @@ _dc_draw_line1(struct rtgui_dc * dst, int x1, int y1, int x2, int y2, rtgui_colo
     }
 }
 
+/* blend a pixel of AA line with the spread color, the weight is 5 bits */
+#define DRAW_SETPIXELXY_BLEND_SPAN565(x, y) \
+do { \
+    rt_uint16_t *_pixel = (rt_uint16_t *)_dc_get_pixel(dst, x, y); \
+    unsigned _a5 = (a + 4) >> 3; (void) r; (void) g; (void) b; \
+    *_pixel = _dc_blend_565(*_pixel, src565 * _a5 + BLEND_ROUND_565, 32 - _a5); \
+} while (0)
+
 static void
 _dc_draw_line2(struct rtgui_dc * dst, int x1, int y1, int x2, int y2, rtgui_color_t color,
               rt_bool_t draw_end)
 {
+    rt_uint8_t _r, _g, _b, _a;
+	rt_uint8_t pixel_format = _dc_get_pixel_format(dst);
+
+	_r = RTGUI_RGB_R(color);
+	_g = RTGUI_RGB_G(color);
+	_b = RTGUI_RGB_B(color);
+	_a = RTGUI_RGB_A(color);
+
+	/* the opaque pixels are written in the format of graphic driver */
+	if (pixel_format == RTGRAPHIC_PIXEL_FORMAT_RGB565 ||
+		pixel_format == RTGRAPHIC_PIXEL_FORMAT_RGB565P)
+		color = _dc_color_to_565(pixel_format, color);
+
     if (y1 == y2) {
         HLINE(rt_uint16_t, DRAW_FASTSETPIXEL2, draw_end);
     } else if (x1 == x2) {
@@ -299,20 +521,16 @@ _dc_draw_line2(struct rtgui_dc * dst, int x1, int y1, int x2, int y2, rtgui_colo
     } else if (ABS(x1 - x2) == ABS(y1 - y2)) {
         DLINE(rt_uint16_t, DRAW_FASTSETPIXEL2, draw_end);
     } else {
-        rt_uint8_t _r, _g, _b, _a;
-
-		_r = RTGUI_RGB_R(color);
-		_g = RTGUI_RGB_G(color);
-		_b = RTGUI_RGB_B(color);
-		_a = RTGUI_RGB_A(color);
-		
-		if (_dc_get_pixel_format(dst) == RTGRAPHIC_PIXEL_FORMAT_RGB565)
+		if (pixel_format == RTGRAPHIC_PIXEL_FORMAT_RGB565 ||
+			pixel_format == RTGRAPHIC_PIXEL_FORMAT_RGB565P)
 		{
+			rt_uint32_t src565 = BLEND_SPREAD_565(color);
+
             AALINE(x1, y1, x2, y2,
-                   DRAW_FASTSETPIXELXY2, DRAW_SETPIXELXY_BLEND_RGB565,
+                   DRAW_FASTSETPIXELXY2, DRAW_SETPIXELXY_BLEND_SPAN565,
                    draw_end);
 		}
-		else if (_dc_get_pixel_format(dst) == RTGRAPHIC_PIXEL_FORMAT_BGR565)
+		else if (pixel_format == RTGRAPHIC_PIXEL_FORMAT_BGR565)
 		{
 			AALINE(x1, y1, x2, y2,
 				DRAW_FASTSETPIXELXY2, DRAW_SETPIXELXY_BLEND_BGR565,
@@ -1499,6 +1717,8 @@ rtgui_dc_blend_fill_rect(struct rtgui_dc* dst, const rtgui_rect_t *rect,
 {
     unsigned r, g, b, a;
 	BlendFillFunc func = RT_NULL;
+	BlendSpanFunc span_func;
+	struct _dc_blend_span span;
 
 	RT_ASSERT(dst != RT_NULL);
 
@@ -1513,6 +1733,10 @@ rtgui_dc_blend_fill_rect(struct rtgui_dc* dst, const rtgui_rect_t *rect,
 	b = RTGUI_RGB_B(color);
 	a = RTGUI_RGB_A(color);
 
+	/* nothing to blend */
+	if (blendMode == RTGUI_BLENDMODE_BLEND && a == 0) return;
+	span_func = _dc_blend_span_prepare(dst, blendMode, color, &span);
+
     if (blendMode == RTGUI_BLENDMODE_BLEND || blendMode == RTGUI_BLENDMODE_ADD) {
         r = DRAW_MUL(r, a);
         g = DRAW_MUL(g, a);
@@ -1536,7 +1760,7 @@ rtgui_dc_blend_fill_rect(struct rtgui_dc* dst, const rtgui_rect_t *rect,
     default:
         break;
     }
-	if (func == RT_NULL)
+	if (func == RT_NULL && span_func == RT_NULL)
 	{
         rt_kprintf("dc_blend_fill_rect(): Unsupported pixel format\n");
 		return ;
@@ -1566,7 +1790,8 @@ rtgui_dc_blend_fill_rect(struct rtgui_dc* dst, const rtgui_rect_t *rect,
 	        if (prect->x2 <= draw_rect.x1 || prect->x1 > draw_rect.x2 ) return ;
 			rtgui_rect_intersect(prect, &draw_rect);
 
-			func(dst, &draw_rect, blendMode, r, g, b, a);
+			if (span_func != RT_NULL) _dc_blend_fill_rect_span(dst, &draw_rect, span_func, &span);
+			else func(dst, &draw_rect, blendMode, r, g, b, a);
 	    }
 	    else
 		{
@@ -1584,13 +1809,15 @@ rtgui_dc_blend_fill_rect(struct rtgui_dc* dst, const rtgui_rect_t *rect,
 				if (prect->x2 <= draw_rect.x1 || prect->x1 > draw_rect.x2 ) continue;
 				rtgui_rect_intersect(prect, &draw_rect);
 
-				func(dst, &draw_rect, blendMode, r, g, b, a);
+				if (span_func != RT_NULL) _dc_blend_fill_rect_span(dst, &draw_rect, span_func, &span);
+			else func(dst, &draw_rect, blendMode, r, g, b, a);
 	        }
 	    }
 	}
 	else
 	{
-		func(dst, rect, blendMode, r, g, b, a);
+		if (span_func != RT_NULL) _dc_blend_fill_rect_span(dst, rect, span_func, &span);
+		else func(dst, rect, blendMode, r, g, b, a);
 	}
 }
 
@@ -1601,6 +1828,8 @@ rtgui_dc_blend_fill_rects(struct rtgui_dc * dst, const rtgui_rect_t *rects, int
     int i;
     rtgui_rect_t rect;
 	BlendFillFunc func = RT_NULL;
+	BlendSpanFunc span_func;
+	struct _dc_blend_span span;
 	rt_uint8_t r, g, b, a;
 	rtgui_widget_t *owner;
 
@@ -1617,6 +1846,10 @@ rtgui_dc_blend_fill_rects(struct rtgui_dc * dst, const rtgui_rect_t *rects, int
 	b = RTGUI_RGB_B(color);
 	a = RTGUI_RGB_A(color);
 
+	/* nothing to blend */
+	if (blendMode == RTGUI_BLENDMODE_BLEND && a == 0) return;
+	span_func = _dc_blend_span_prepare(dst, blendMode, color, &span);
+
 	if (blendMode == RTGUI_BLENDMODE_BLEND || blendMode == RTGUI_BLENDMODE_ADD) {
         r = DRAW_MUL(r, a);
         g = DRAW_MUL(g, a);
@@ -1640,7 +1873,7 @@ rtgui_dc_blend_fill_rects(struct rtgui_dc * dst, const rtgui_rect_t *rects, int
     default:
         break;
     }
-	if (func == RT_NULL)
+	if (func == RT_NULL && span_func == RT_NULL)
 	{
         rt_kprintf("dc_blend_fill_rects(): Unsupported pixel format\n");
 		return;
@@ -1672,11 +1905,12 @@ rtgui_dc_blend_fill_rects(struct rtgui_dc * dst, const rtgui_rect_t *rects, int
 				rtgui_rect_moveto(&draw_rect,owner->extent.x1, owner->extent.y1);
 				
 		        /* calculate rect intersect */
-		        if (prect->y1 > draw_rect.y2  || prect->y2 <= draw_rect.y1) return ;
-		        if (prect->x2 <= draw_rect.x1 || prect->x1 > draw_rect.x2 ) return ;
+		        if (prect->y1 > draw_rect.y2  || prect->y2 <= draw_rect.y1) continue;
+		        if (prect->x2 <= draw_rect.x1 || prect->x1 > draw_rect.x2 ) continue;
 				rtgui_rect_intersect(prect, &draw_rect);
 
-				func(dst, &draw_rect, blendMode, r, g, b, a);
+				if (span_func != RT_NULL) _dc_blend_fill_rect_span(dst, &draw_rect, span_func, &span);
+				else func(dst, &draw_rect, blendMode, r, g, b, a);
 		    }
 		    else
 			{
@@ -1694,13 +1928,15 @@ rtgui_dc_blend_fill_rects(struct rtgui_dc * dst, const rtgui_rect_t *rects, int
 					if (prect->x2 <= draw_rect.x1 || prect->x1 > draw_rect.x2 ) continue;
 					rtgui_rect_intersect(prect, &draw_rect);
 
-					func(dst, &draw_rect, blendMode, r, g, b, a);
+					if (span_func != RT_NULL) _dc_blend_fill_rect_span(dst, &draw_rect, span_func, &span);
+				else func(dst, &draw_rect, blendMode, r, g, b, a);
 		        }
 		    }
 		}
 		else
 		{
-			func(dst, &rect, blendMode, r, g, b, a);
+			if (span_func != RT_NULL) _dc_blend_fill_rect_span(dst, &rect, span_func, &span);
+			else func(dst, &rect, blendMode, r, g, b, a);
 		}		
     }
 }
@@ -40,11 +40,100 @@ static rt_bool_t rtgui_dc_client_fini(struct rtgui_dc *dc);
 static rt_bool_t rtgui_dc_client_get_visible(struct rtgui_dc *dc);
 static void rtgui_dc_client_get_rect(struct rtgui_dc *dc, rtgui_rect_t *rect);
 
-#define hw_driver               (rtgui_graphic_driver_get_default())
+/* the driver of window, which is on the back buffer of a buffered window */
+#define hw_driver               (rtgui_win_get_driver(RTGUI_WIN(owner->toplevel)))
 #define dc_set_foreground(c)    dc->gc.foreground = c
 #define dc_set_background(c)    dc->gc.background = c
 #define _int_swap(x, y)         do {x ^= y; y ^= x; x ^= y;} while (0)
 
+/* the maximal number of spans submitted to driver in one call */
+#define RTGUI_DC_SPAN_BATCH     32
+
+#ifdef RTGUI_USING_WIN_BUFFER
+/*
+ * Back buffer of window
+ *
+ * The dc of a buffered window draws with the framebuffer driver on its back
+ * buffer (see rtgui_win_get_driver), the other windows and server keep drawing
+ * on screen. The damaged part is flushed to screen line by line with
+ * draw_raw_hline of screen driver when the outermost drawing of window ends.
+ */
+static void _win_buffer_flush(struct rtgui_win *win)
+{
+    int index, count, y;
+    rtgui_rect_t rect;
+    rtgui_rect_t *rects;
+    rt_uint8_t *line;
+    struct rtgui_win_buffer *buffer = win->buffer;
+    const struct rtgui_graphic_driver *screen = rtgui_graphic_driver_get_default();
+    const rtgui_rect_t *extent = &(RTGUI_WIDGET(win)->extent);
+
+    if (buffer->dirty.x1 >= buffer->dirty.x2 || buffer->dirty.y1 >= buffer->dirty.y2)
+        return;
+
+    /* only the visible part of window goes to screen */
+    count = rtgui_region_num_rects(&(RTGUI_WIDGET(win)->clip));
+    rects = rtgui_region_rects(&(RTGUI_WIDGET(win)->clip));
+    for (index = 0; index < count; index ++)
+    {
+        rect = buffer->dirty;
+        rtgui_rect_intersect(&rects[index], &rect);
+        if (rect.x1 >= rect.x2 || rect.y1 >= rect.y2) continue;
+
+        line = buffer->pixel + (rect.y1 - extent->y1) * buffer->pitch +
+               (rect.x1 - extent->x1) * screen->bits_per_pixel / 8;
+        for (y = rect.y1; y < rect.y2; y ++)
+        {
+            screen->ops->draw_raw_hline(line, rect.x1, rect.x2, y);
+            line += buffer->pitch;
+        }
+    }
+
+    buffer->dirty = rtgui_empty_rect;
+}
+
+/* the window of owner if it draws in back buffer */
+static struct rtgui_win *_win_buffer_of(rtgui_widget_t *owner)
+{
+    struct rtgui_win *win;
+
+    if (owner->toplevel == RT_NULL || !RTGUI_IS_WIN(owner->toplevel))
+        return RT_NULL;
+
+    win = RTGUI_WIN(owner->toplevel);
+    if (win->buffer == RT_NULL || rtgui_win_get_driver(win) != &(win->buffer->driver))
+        return RT_NULL;
+
+    return win;
+}
+
+/* record the damaged rect of owner in the back buffer */
+static void _win_buffer_damage(rtgui_widget_t *owner)
+{
+    struct rtgui_win *win;
+    struct rtgui_win_buffer *buffer;
+    rtgui_rect_t *damage;
+
+    win = _win_buffer_of(owner);
+    if (win == RT_NULL) return;
+
+    buffer = win->buffer;
+    damage = &(owner->clip.extents);
+    if (damage->x1 >= damage->x2 || damage->y1 >= damage->y2) return;
+    if (buffer->dirty.x1 >= buffer->dirty.x2 || buffer->dirty.y1 >= buffer->dirty.y2)
+    {
+        buffer->dirty = *damage;
+    }
+    else
+    {
+        if (damage->x1 < buffer->dirty.x1) buffer->dirty.x1 = damage->x1;
+        if (damage->y1 < buffer->dirty.y1) buffer->dirty.y1 = damage->y1;
+        if (damage->x2 > buffer->dirty.x2) buffer->dirty.x2 = damage->x2;
+        if (damage->y2 > buffer->dirty.y2) buffer->dirty.y2 = damage->y2;
+    }
+}
+#endif
+
 struct rtgui_dc *rtgui_dc_begin_drawing(rtgui_widget_t *owner)
 {
     struct rtgui_dc *dc;
@@ -58,7 +147,15 @@ struct rtgui_dc *rtgui_dc_begin_drawing(rtgui_widget_t *owner)
     else
         dc = rtgui_dc_client_create(owner);
 
-    if (dc == RT_NULL) rtgui_screen_unlock();
+    if (dc == RT_NULL)
+    {
+        rtgui_screen_unlock();
+        return RT_NULL;
+    }
+
+#ifdef RTGUI_USING_WIN_BUFFER
+    _win_buffer_damage(owner);
+#endif
 
     return dc;
 }
@@ -66,6 +163,24 @@ RTM_EXPORT(rtgui_dc_begin_drawing);
 
 void rtgui_dc_end_drawing(struct rtgui_dc *dc)
 {
+#ifdef RTGUI_USING_WIN_BUFFER
+    rtgui_widget_t *owner = RT_NULL;
+    struct rtgui_win *win;
+
+    if (dc->type == RTGUI_DC_HW)
+        owner = ((struct rtgui_dc_hw *)dc)->owner;
+    else if (dc->type == RTGUI_DC_CLIENT)
+        owner = RTGUI_CONTAINER_OF(dc, struct rtgui_widget, dc_type);
+
+    /* flush back buffer before the outermost drawing of its window ends */
+    if (owner != RT_NULL)
+    {
+        win = _win_buffer_of(owner);
+        if (win != RT_NULL && win->drawing == 1)
+            _win_buffer_flush(win);
+    }
+#endif
+
     dc->engine->fini(dc);
     rtgui_screen_unlock();
 }
@@ -357,8 +472,11 @@ static void rtgui_dc_client_draw_vline(struct rtgui_dc *self, int x, int y1, int
  */
 static void rtgui_dc_client_draw_hline(struct rtgui_dc *self, int x1, int x2, int y)
 {
-    register rt_base_t index;
+    register rt_base_t index, num;
     rtgui_widget_t *owner;
+    rtgui_rect_t *prect;
+    struct rtgui_span spans[RTGUI_DC_SPAN_BATCH];
+    int count;
 
     if (self == RT_NULL) return;
 
@@ -374,8 +492,6 @@ static void rtgui_dc_client_draw_hline(struct rtgui_dc *self, int x1, int x2, in
 
     if (owner->clip.data == RT_NULL)
     {
-        rtgui_rect_t *prect;
-
         prect = &(owner->clip.extents);
 
         /* calculate vline intersect */
@@ -387,36 +503,49 @@ static void rtgui_dc_client_draw_hline(struct rtgui_dc *self, int x1, int x2, in
 
         /* draw hline */
         hw_driver->ops->draw_hline(&(owner->gc.foreground), x1, x2, y);
+        return;
     }
-    else
-	{
-		for (index = 0; index < rtgui_region_num_rects(&(owner->clip)); index ++)
-        {
-            rtgui_rect_t *prect;
-            register rt_base_t draw_x1, draw_x2;
 
-            prect = ((rtgui_rect_t *)(owner->clip.data + index + 1));
-            draw_x1 = x1;
-            draw_x2 = x2;
+    /* the line is out of the whole clip region */
+    prect = &(owner->clip.extents);
+    if (prect->y1 > y  || prect->y2 <= y) return;
+    if (prect->x2 <= x1 || prect->x1 > x2) return;
 
-            /* calculate hline clip */
-            if (prect->y1 > y  || prect->y2 <= y) continue;
-            if (prect->x2 <= x1 || prect->x1 > x2) continue;
+    /* clip hline against region once and draw all spans in batch */
+    count = 0;
+    num = rtgui_region_num_rects(&(owner->clip));
+    prect = (rtgui_rect_t *)(owner->clip.data + 1);
+    for (index = 0; index < num; index ++, prect ++)
+    {
+        /* the rects are sorted by y1 */
+        if (prect->y1 > y) break;
 
-            if (prect->x1 > x1) draw_x1 = prect->x1;
-            if (prect->x2 < x2) draw_x2 = prect->x2;
+        /* calculate hline clip */
+        if (prect->y2 <= y) continue;
+        if (prect->x2 <= x1 || prect->x1 >= x2) continue;
 
-            /* draw hline */
-            hw_driver->ops->draw_hline(&(owner->gc.foreground), draw_x1, draw_x2, y);
+        spans[count].x1 = prect->x1 > x1 ? prect->x1 : x1;
+        spans[count].x2 = prect->x2 < x2 ? prect->x2 : x2;
+        spans[count].y  = y;
+        count ++;
+
+        if (count == RTGUI_DC_SPAN_BATCH)
+        {
+            rtgui_graphic_driver_draw_hspans(hw_driver, &(owner->gc.foreground), spans, count);
+            count = 0;
         }
     }
+
+    rtgui_graphic_driver_draw_hspans(hw_driver, &(owner->gc.foreground), spans, count);
 }
 
 static void rtgui_dc_client_fill_rect(struct rtgui_dc *self, struct rtgui_rect *rect)
 {
-    rtgui_color_t foreground;
-    register rt_base_t index;
+    register rt_base_t index, num;
     rtgui_widget_t *owner;
+    rtgui_rect_t fill, *prect;
+    struct rtgui_span spans[RTGUI_DC_SPAN_BATCH];
+    int count, x1, x2, y1, y2, y;
 
     if (self == RT_NULL) return;
 
@@ -424,20 +553,62 @@ static void rtgui_dc_client_fill_rect(struct rtgui_dc *self, struct rtgui_rect *
     owner = RTGUI_CONTAINER_OF(self, struct rtgui_widget, dc_type);
     if (!RTGUI_WIDGET_IS_DC_VISIBLE(owner)) return;
 
-    /* save foreground color */
-    foreground = owner->gc.foreground;
+    /* convert logic to device */
+    fill.x1 = rect->x1 + owner->extent.x1;
+    fill.x2 = rect->x2 + owner->extent.x1;
+    if (fill.x1 > fill.x2) _int_swap(fill.x1, fill.x2);
+    fill.y1 = rect->y1 + owner->extent.y1;
+    fill.y2 = rect->y2 + owner->extent.y1;
 
-    /* set background color as foreground color */
-    owner->gc.foreground = owner->gc.background;
+    if (owner->clip.data == RT_NULL)
+    {
+        num   = 1;
+        prect = &(owner->clip.extents);
+    }
+    else
+    {
+        num   = rtgui_region_num_rects(&(owner->clip));
+        prect = (rtgui_rect_t *)(owner->clip.data + 1);
+    }
 
-    /* fill rect */
-    for (index = rect->y1; index < rect->y2; index ++)
+    /* clip the rect against region once and draw all spans in batch */
+    count = 0;
+    for (index = 0; index < num; index ++, prect ++)
     {
-        rtgui_dc_client_draw_hline(self, rect->x1, rect->x2, index);
+        /* the rects are sorted by y1 */
+        if (prect->y1 >= fill.y2) break;
+
+        if (prect->y2 <= fill.y1) continue;
+        if (prect->x2 <= fill.x1 || prect->x1 >= fill.x2) continue;
+
+        x1 = prect->x1 > fill.x1 ? prect->x1 : fill.x1;
+        x2 = prect->x2 < fill.x2 ? prect->x2 : fill.x2;
+        y1 = prect->y1 > fill.y1 ? prect->y1 : fill.y1;
+        y2 = prect->y2 < fill.y2 ? prect->y2 : fill.y2;
+
+        /* the rects of region don't overlap, so the order of drawing doesn't matter */
+        if (hw_driver->ext_ops != RT_NULL && hw_driver->ext_ops->fill_rect != RT_NULL)
+        {
+            hw_driver->ext_ops->fill_rect(&(owner->gc.background), x1, y1, x2 - 1, y2 - 1);
+            continue;
+        }
+
+        for (y = y1; y < y2; y ++)
+        {
+            spans[count].x1 = x1;
+            spans[count].x2 = x2;
+            spans[count].y  = y;
+            count ++;
+
+            if (count == RTGUI_DC_SPAN_BATCH)
+            {
+                rtgui_graphic_driver_draw_hspans(hw_driver, &(owner->gc.background), spans, count);
+                count = 0;
+            }
+        }
     }
 
-    /* restore foreground color */
-    owner->gc.foreground = foreground;
+    rtgui_graphic_driver_draw_hspans(hw_driver, &(owner->gc.background), spans, count);
 }
 
 static void rtgui_dc_client_blit_line(struct rtgui_dc *self, int x1, int x2, int y, rt_uint8_t *line_data)
@@ -467,13 +638,14 @@ static void rtgui_dc_client_blit_line(struct rtgui_dc *self, int x1, int x2, int
         if (prect->y1 > y  || prect->y2 <= y) return;
         if (prect->x2 <= x1 || prect->x1 > x2) return;
 
-        if (prect->x1 > x1) x1 = prect->x1;
+        /* the line data starts at x1, skip the part clipped out */
+        if (prect->x1 > x1)
+        {
+            offset = prect->x1 - x1;
+            x1 = prect->x1;
+        }
         if (prect->x2 < x2) x2 = prect->x2;
 
-        /* patch note:
-         * We need to adjust the offset when update widget clip!
-         * Of course at ordinary times for 0. General */
-        offset = owner->clip.extents.x1 - owner->extent.x1;
         offset = offset * hw_driver->bits_per_pixel / 8;
         /* draw hline */
         hw_driver->ops->draw_raw_hline(line_data + offset, x1, x2, y);
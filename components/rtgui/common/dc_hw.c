@@ -91,7 +91,7 @@ struct rtgui_dc *rtgui_dc_hw_create(rtgui_widget_t *owner)
     dc->parent.type = RTGUI_DC_HW;
     dc->parent.engine = &dc_hw_engine;
     dc->owner = owner;
-    dc->hw_driver = rtgui_graphic_driver_get_default();
+    dc->hw_driver = rtgui_win_get_driver(RTGUI_WIN(owner->toplevel));
 
     if (RTGUI_IS_WINTITLE(owner->toplevel))
     {
@@ -298,6 +298,17 @@ static void rtgui_dc_hw_fill_rect(struct rtgui_dc *self, struct rtgui_rect *rect
     x1 = rect->x1 + dc->owner->extent.x1;
     x2 = rect->x2 + dc->owner->extent.x1;
 
+    /* the whole owner is visible in hardware dc */
+    if (dc->hw_driver->ext_ops != RT_NULL && dc->hw_driver->ext_ops->fill_rect != RT_NULL)
+    {
+        if (x1 < x2 && rect->y1 < rect->y2)
+        {
+            dc->hw_driver->ext_ops->fill_rect(&color, x1, dc->owner->extent.y1 + rect->y1,
+                                              x2 - 1, dc->owner->extent.y1 + rect->y2 - 1);
+        }
+        return;
+    }
+
     /* fill rect */
     for (index = dc->owner->extent.y1 + rect->y1; index < dc->owner->extent.y1 + rect->y2; index ++)
     {
@@ -14,6 +14,7 @@
  *                             (which set by theme)
  */
 #include <rtgui/font.h>
+#include <rtgui/font_cache.h>
 #include <rtgui/dc.h>
 
 static rtgui_list_t _rtgui_font_list;
@@ -35,6 +36,9 @@ void rtgui_font_system_init()
     /* set default font to NULL */
     rtgui_default_font = RT_NULL;
 
+    /* init glyph cache */
+    rtgui_font_cache_init();
+
 #ifdef RTGUI_USING_FONT16
     rtgui_font_system_add_font(&rtgui_font_asc16);
 #ifdef RTGUI_USING_FONTHZ
@@ -12,6 +12,7 @@
  * 2010-09-15     Bernard      first version
  */
 #include <rtgui/font.h>
+#include <rtgui/font_cache.h>
 #include <rtgui/dc.h>
 
 /* bitmap font private data */
@@ -26,6 +27,28 @@ const struct rtgui_font_engine bmp_font_engine =
     rtgui_bitmap_font_get_metrics
 };
 
+static rt_bool_t _bitmap_font_load_glyph(const void *data, rt_uint16_t code,
+                                         struct rtgui_glyph_bitmap *bitmap)
+{
+    const struct rtgui_font_bitmap *font = (const struct rtgui_font_bitmap *)data;
+    rt_uint8_t ch = (rt_uint8_t)code;
+
+    if (font->char_width == RT_NULL)
+    {
+        bitmap->pitch = (((font->width - 1) / 8) + 1);
+        bitmap->data = font->bmp + (ch - font->first_char) * bitmap->pitch * font->height;
+    }
+    else
+    {
+        bitmap->pitch = ((font->char_width[ch - font->first_char] - 1) / 8) + 1;
+        bitmap->data = font->bmp + font->offset[ch - font->first_char];
+    }
+    bitmap->width = font->width < bitmap->pitch * 8 ? font->width : bitmap->pitch * 8;
+    bitmap->height = font->height;
+
+    return RT_TRUE;
+}
+
 void rtgui_bitmap_font_draw_char(struct rtgui_font_bitmap *font, struct rtgui_dc *dc, const char ch,
                                  rtgui_rect_t *rect)
 {
@@ -37,6 +60,10 @@ void rtgui_bitmap_font_draw_char(struct rtgui_font_bitmap *font, struct rtgui_dc
     /* check first and last char */
     if (ch < font->first_char || ch > font->last_char) return;
 
+    /* draw with the expanded glyph in cache */
+    if (rtgui_font_cache_draw(dc, font, (rt_uint8_t)ch, _bitmap_font_load_glyph, rect) == RT_TRUE)
+        return;
+
     /* get text style */
     style = rtgui_dc_get_gc(dc)->textstyle;
     bc = rtgui_dc_get_gc(dc)->background;
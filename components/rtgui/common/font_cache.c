@@ -0,0 +1,380 @@
+/*
+ * File      : font_cache.c
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2013, RT-Thread Development Team
+ *
+ * The license and distribution terms for this file may be
+ * found in the file LICENSE in this distribution or at
+ * http://www.rt-thread.org/license/LICENSE
+ */
+
+/*
+ * Glyph cache of bitmap fonts.
+ *
+ * Each glyph is expanded once into a list of foreground runs. The runs do
+ * not depend on the colors, so one cached glyph serves every color and text
+ * style: the background (when RTGUI_TEXTSTYLE_DRAW_BACKGROUND is set) is one
+ * fill_rect and the foreground is one hline for each run, instead of one
+ * draw_point for each pixel.
+ */
+#include <rtgui/dc.h>
+#include <rtgui/font.h>
+#include <rtgui/font_cache.h>
+#include <rtgui/rtgui_system.h>
+
+#define GLYPH_HASH_SIZE     64
+#define GLYPH_SPANS(glyph)  ((struct rtgui_glyph_span *)((glyph) + 1))
+#define GLYPH_SIZE(glyph)   (sizeof(struct rtgui_glyph) + (glyph)->span_count * sizeof(struct rtgui_glyph_span))
+
+static struct rt_mutex _cache_lock;
+static struct rtgui_glyph *_cache_hash[GLYPH_HASH_SIZE];
+/* the most recently used glyph is at the head */
+static struct rtgui_dlist_node _cache_lru;
+static struct rtgui_font_cache_stat _cache_stat;
+
+rt_inline rt_uint32_t _glyph_hash(const void *font, rt_uint16_t code)
+{
+    return (((rt_ubase_t)font >> 2) ^ code ^ (code >> 6)) % GLYPH_HASH_SIZE;
+}
+
+static void _glyph_remove(struct rtgui_glyph *glyph)
+{
+    struct rtgui_glyph **pglyph;
+
+    pglyph = &_cache_hash[_glyph_hash(glyph->font, glyph->code)];
+    while (*pglyph != RT_NULL)
+    {
+        if (*pglyph == glyph)
+        {
+            *pglyph = glyph->hash_next;
+            break;
+        }
+        pglyph = &((*pglyph)->hash_next);
+    }
+
+    rtgui_dlist_remove(&(glyph->lru));
+    _cache_stat.used_size -= GLYPH_SIZE(glyph);
+    rtgui_free(glyph);
+}
+
+static void _glyph_shrink(rt_uint32_t size)
+{
+    struct rtgui_glyph *glyph;
+
+    while (_cache_stat.used_size + size > _cache_stat.max_size &&
+            !rtgui_dlist_isempty(&_cache_lru))
+    {
+        glyph = rtgui_dlist_entry(_cache_lru.prev, struct rtgui_glyph, lru);
+        _glyph_remove(glyph);
+        _cache_stat.evict ++;
+    }
+}
+
+static struct rtgui_glyph *_glyph_find(const void *font, rt_uint16_t code)
+{
+    struct rtgui_glyph *glyph;
+
+    for (glyph = _cache_hash[_glyph_hash(font, code)]; glyph != RT_NULL; glyph = glyph->hash_next)
+    {
+        if (glyph->font == font && glyph->code == code)
+        {
+            /* move to the head of lru list */
+            rtgui_dlist_remove(&(glyph->lru));
+            rtgui_dlist_insert_after(&_cache_lru, &(glyph->lru));
+            return glyph;
+        }
+    }
+
+    return RT_NULL;
+}
+
+static void _glyph_insert(struct rtgui_glyph *glyph)
+{
+    rt_uint32_t hash = _glyph_hash(glyph->font, glyph->code);
+
+    glyph->hash_next = _cache_hash[hash];
+    _cache_hash[hash] = glyph;
+    rtgui_dlist_insert_after(&_cache_lru, &(glyph->lru));
+    _cache_stat.used_size += GLYPH_SIZE(glyph);
+}
+
+static struct rtgui_glyph *_glyph_create(const void *font, rt_uint16_t code,
+                                         struct rtgui_glyph_bitmap *bitmap)
+{
+    int x, y, start;
+    rt_uint32_t size;
+    rt_uint16_t span_count;
+    const rt_uint8_t *row;
+    struct rtgui_glyph *glyph;
+    struct rtgui_glyph_span *span;
+
+    if (bitmap->width > 255 || bitmap->height > 255) return RT_NULL;
+
+#define _BIT(row, x)    ((row)[(x) >> 3] & (0x80 >> ((x) & 0x07)))
+
+    /* count the foreground runs */
+    span_count = 0;
+    for (y = 0; y < bitmap->height; y ++)
+    {
+        row = bitmap->data + y * bitmap->pitch;
+        for (x = 0; x < bitmap->width; x ++)
+        {
+            if (_BIT(row, x) && (x == 0 || !_BIT(row, x - 1)))
+                span_count ++;
+        }
+    }
+
+    size = sizeof(struct rtgui_glyph) + span_count * sizeof(struct rtgui_glyph_span);
+    if (size > _cache_stat.max_size) return RT_NULL;
+
+    _glyph_shrink(size);
+    glyph = (struct rtgui_glyph *)rtgui_malloc(size);
+    if (glyph == RT_NULL) return RT_NULL;
+
+    glyph->font = font;
+    glyph->code = code;
+    glyph->width = bitmap->width;
+    glyph->height = bitmap->height;
+    glyph->span_count = span_count;
+
+    /* expand the runs */
+    span = GLYPH_SPANS(glyph);
+    for (y = 0; y < bitmap->height; y ++)
+    {
+        row = bitmap->data + y * bitmap->pitch;
+        x = 0;
+        while (x < bitmap->width)
+        {
+            if (!_BIT(row, x))
+            {
+                x ++;
+                continue;
+            }
+
+            start = x;
+            while (x < bitmap->width && _BIT(row, x)) x ++;
+
+            span->y  = y;
+            span->x1 = start;
+            span->x2 = x;
+            span ++;
+        }
+    }
+#undef _BIT
+
+    _glyph_insert(glyph);
+
+    return glyph;
+}
+
+/* the runs are decoded into a glyph of the maximal size, which is shrunk then */
+static struct rtgui_glyph *_glyph_decode(const void *font, rt_uint16_t code,
+                                         rt_uint8_t width, rt_uint8_t height,
+                                         rtgui_font_cache_decode_t decode)
+{
+    int count;
+    rt_uint32_t size;
+    struct rtgui_glyph *glyph, *new_glyph;
+
+    size = sizeof(struct rtgui_glyph) +
+           RTGUI_GLYPH_SPAN_MAX(width, height) * sizeof(struct rtgui_glyph_span);
+    if (size > _cache_stat.max_size) return RT_NULL;
+
+    _glyph_shrink(size);
+    glyph = (struct rtgui_glyph *)rtgui_malloc(size);
+    if (glyph == RT_NULL) return RT_NULL;
+
+    count = decode(font, code, GLYPH_SPANS(glyph));
+    if (count < 0)
+    {
+        rtgui_free(glyph);
+        return RT_NULL;
+    }
+
+    glyph->font = font;
+    glyph->code = code;
+    glyph->width = width;
+    glyph->height = height;
+    glyph->span_count = count;
+
+    new_glyph = (struct rtgui_glyph *)rtgui_realloc(glyph, GLYPH_SIZE(glyph));
+    if (new_glyph != RT_NULL) glyph = new_glyph;
+
+    _glyph_insert(glyph);
+
+    return glyph;
+}
+
+void rtgui_glyph_draw_spans(struct rtgui_dc *dc, const struct rtgui_glyph_span *spans, int count,
+                            int width, int height, struct rtgui_rect *rect)
+{
+    int index, w, h, x2;
+    rtgui_rect_t bg_rect;
+    const struct rtgui_glyph_span *span;
+
+    w = (width  + rect->x1 > rect->x2) ? rect->x2 - rect->x1 : width;
+    h = (height + rect->y1 > rect->y2) ? rect->y2 - rect->y1 : height;
+    if (w <= 0 || h <= 0) return;
+
+    if (rtgui_dc_get_gc(dc)->textstyle & RTGUI_TEXTSTYLE_DRAW_BACKGROUND)
+    {
+        bg_rect.x1 = rect->x1;
+        bg_rect.y1 = rect->y1;
+        bg_rect.x2 = rect->x1 + w;
+        bg_rect.y2 = rect->y1 + h;
+        rtgui_dc_fill_rect(dc, &bg_rect);
+    }
+
+    span = spans;
+    for (index = 0; index < count; index ++, span ++)
+    {
+        /* the spans are sorted by row */
+        if (span->y >= h) break;
+        if (span->x1 >= w) continue;
+
+        x2 = span->x2 > w ? w : span->x2;
+        rtgui_dc_draw_hline(dc, rect->x1 + span->x1, rect->x1 + x2, rect->y1 + span->y);
+    }
+}
+
+static void _glyph_draw(struct rtgui_dc *dc, struct rtgui_glyph *glyph, struct rtgui_rect *rect)
+{
+    rtgui_glyph_draw_spans(dc, GLYPH_SPANS(glyph), glyph->span_count,
+                           glyph->width, glyph->height, rect);
+}
+
+void rtgui_font_cache_init(void)
+{
+    rt_mutex_init(&_cache_lock, "glyph", RT_IPC_FLAG_FIFO);
+    rtgui_dlist_init(&_cache_lru);
+    rt_memset(_cache_hash, 0, sizeof(_cache_hash));
+    rt_memset(&_cache_stat, 0, sizeof(_cache_stat));
+
+    _cache_stat.max_size = RTGUI_FONT_CACHE_SIZE;
+}
+
+void rtgui_font_cache_set_size(rt_uint32_t size)
+{
+    rt_mutex_take(&_cache_lock, RT_WAITING_FOREVER);
+    _cache_stat.max_size = size;
+    _glyph_shrink(0);
+    rt_mutex_release(&_cache_lock);
+}
+RTM_EXPORT(rtgui_font_cache_set_size);
+
+/* remove all the glyphs of a font, or all glyphs if font is RT_NULL */
+void rtgui_font_cache_flush(const void *font)
+{
+    struct rtgui_glyph *glyph;
+    struct rtgui_dlist_node *node, *next;
+
+    rt_mutex_take(&_cache_lock, RT_WAITING_FOREVER);
+    for (node = _cache_lru.next; node != &_cache_lru; node = next)
+    {
+        next = node->next;
+        glyph = rtgui_dlist_entry(node, struct rtgui_glyph, lru);
+        if (font == RT_NULL || glyph->font == font)
+            _glyph_remove(glyph);
+    }
+    rt_mutex_release(&_cache_lock);
+}
+RTM_EXPORT(rtgui_font_cache_flush);
+
+void rtgui_font_cache_get_stat(struct rtgui_font_cache_stat *stat)
+{
+    RT_ASSERT(stat != RT_NULL);
+
+    *stat = _cache_stat;
+}
+RTM_EXPORT(rtgui_font_cache_get_stat);
+
+rt_bool_t rtgui_font_cache_lookup(const void *font, rt_uint16_t code)
+{
+    struct rtgui_glyph *glyph;
+
+    if (_cache_stat.max_size == 0) return RT_FALSE;
+
+    rt_mutex_take(&_cache_lock, RT_WAITING_FOREVER);
+    glyph = _glyph_find(font, code);
+    rt_mutex_release(&_cache_lock);
+
+    return glyph != RT_NULL;
+}
+RTM_EXPORT(rtgui_font_cache_lookup);
+
+rt_bool_t rtgui_font_cache_draw(struct rtgui_dc *dc, const void *font, rt_uint16_t code,
+                                rtgui_font_cache_load_t load, struct rtgui_rect *rect)
+{
+    struct rtgui_glyph *glyph;
+    struct rtgui_glyph_bitmap bitmap;
+
+    RT_ASSERT(dc != RT_NULL);
+    RT_ASSERT(load != RT_NULL);
+
+    if (_cache_stat.max_size == 0) return RT_FALSE;
+
+    rt_mutex_take(&_cache_lock, RT_WAITING_FOREVER);
+
+    glyph = _glyph_find(font, code);
+    if (glyph != RT_NULL)
+    {
+        _cache_stat.hit ++;
+    }
+    else
+    {
+        _cache_stat.miss ++;
+        if (load(font, code, &bitmap) == RT_TRUE)
+            glyph = _glyph_create(font, code, &bitmap);
+    }
+
+    if (glyph != RT_NULL)
+        _glyph_draw(dc, glyph, rect);
+
+    rt_mutex_release(&_cache_lock);
+
+    return glyph != RT_NULL;
+}
+RTM_EXPORT(rtgui_font_cache_draw);
+
+rt_bool_t rtgui_font_cache_draw_spans(struct rtgui_dc *dc, const void *font, rt_uint16_t code,
+                                      rt_uint8_t width, rt_uint8_t height,
+                                      rtgui_font_cache_decode_t decode, struct rtgui_rect *rect)
+{
+    struct rtgui_glyph *glyph;
+
+    RT_ASSERT(dc != RT_NULL);
+    RT_ASSERT(decode != RT_NULL);
+
+    if (_cache_stat.max_size == 0) return RT_FALSE;
+
+    rt_mutex_take(&_cache_lock, RT_WAITING_FOREVER);
+
+    glyph = _glyph_find(font, code);
+    if (glyph != RT_NULL)
+    {
+        _cache_stat.hit ++;
+    }
+    else
+    {
+        _cache_stat.miss ++;
+        glyph = _glyph_decode(font, code, width, height, decode);
+    }
+
+    if (glyph != RT_NULL)
+        _glyph_draw(dc, glyph, rect);
+
+    rt_mutex_release(&_cache_lock);
+
+    return glyph != RT_NULL;
+}
+RTM_EXPORT(rtgui_font_cache_draw_spans);
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+void list_fontcache(void)
+{
+    rt_kprintf("glyph cache: %d/%d bytes\n", _cache_stat.used_size, _cache_stat.max_size);
+    rt_kprintf("hit: %d, miss: %d, evict: %d\n", _cache_stat.hit, _cache_stat.miss, _cache_stat.evict);
+}
+FINSH_FUNCTION_EXPORT(list_fontcache, display glyph cache statistics);
+#endif
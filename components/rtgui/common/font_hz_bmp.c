@@ -1,6 +1,7 @@
 
 #include <rtgui/dc.h>
 #include <rtgui/font.h>
+#include <rtgui/font_cache.h>
 
 #ifdef RTGUI_USING_HZ_BMP
 
@@ -14,29 +15,6 @@ const struct rtgui_font_engine hz_bmp_font_engine =
     rtgui_hz_bitmap_font_get_metrics
 };
 
-#ifdef RTGUI_USING_FONT_COMPACT
-extern rt_uint32_t rtgui_font_mph12(const rt_uint16_t key);
-extern rt_uint32_t rtgui_font_mph16(const rt_uint16_t key);
-rt_inline const rt_uint8_t *_rtgui_hz_bitmap_get_font_ptr(struct rtgui_font_bitmap *bmp_font,
-        rt_uint8_t *str,
-        rt_base_t font_bytes)
-{
-    rt_uint16_t cha = *(rt_uint16_t *)str;
-    int idx;
-
-    if (bmp_font->height  == 16)
-        idx = rtgui_font_mph16(cha);
-    else // asume the height is 12
-        idx = rtgui_font_mph12(cha);
-
-    /* don't access beyond the data */
-    if (idx < 0)
-        idx = 0;
-
-    /* get font pixel data */
-    return bmp_font->bmp + idx * font_bytes;
-}
-#else
 rt_inline const rt_uint8_t *_rtgui_hz_bitmap_get_font_ptr(struct rtgui_font_bitmap *bmp_font,
         rt_uint8_t *str,
         rt_base_t font_bytes)
@@ -50,7 +28,23 @@ rt_inline const rt_uint8_t *_rtgui_hz_bitmap_get_font_ptr(struct rtgui_font_bitm
     /* get font pixel data */
     return bmp_font->bmp + (94 * (sect - 1) + (index - 1)) * font_bytes;
 }
-#endif
+
+static rt_bool_t _hz_bitmap_font_load_glyph(const void *data, rt_uint16_t code,
+                                            struct rtgui_glyph_bitmap *bitmap)
+{
+    struct rtgui_font_bitmap *bmp_font = (struct rtgui_font_bitmap *)data;
+    rt_uint8_t str[2];
+
+    str[0] = code & 0xff;
+    str[1] = code >> 8;
+
+    bitmap->pitch  = (bmp_font->width + 7) / 8;
+    bitmap->width  = bmp_font->width;
+    bitmap->height = bmp_font->height;
+    bitmap->data   = _rtgui_hz_bitmap_get_font_ptr(bmp_font, str, bitmap->pitch * bmp_font->height);
+
+    return RT_TRUE;
+}
 
 static void _rtgui_hz_bitmap_font_draw_text(struct rtgui_font_bitmap *bmp_font, struct rtgui_dc *dc, const char *text, rt_ubase_t len, struct rtgui_rect *rect)
 {
@@ -77,6 +71,16 @@ static void _rtgui_hz_bitmap_font_draw_text(struct rtgui_font_bitmap *bmp_font,
         const rt_uint8_t *font_ptr;
         register rt_base_t i, j, k;
 
+        /* draw with the expanded glyph in cache */
+        if (rtgui_font_cache_draw(dc, bmp_font, *str | (*(str + 1) << 8),
+                                  _hz_bitmap_font_load_glyph, rect) == RT_TRUE)
+        {
+            rect->x1 += bmp_font->width;
+            str += 2;
+            len -= 2;
+            continue;
+        }
+
         /* get font pixel data */
         font_ptr = _rtgui_hz_bitmap_get_font_ptr(bmp_font, str, font_bytes);
         /* draw word */
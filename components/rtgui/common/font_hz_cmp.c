@@ -0,0 +1,266 @@
+/*
+ * File      : font_hz_cmp.c
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2013, RT-Thread Development Team
+ *
+ * The license and distribution terms for this file may be
+ * found in the file LICENSE in this distribution or at
+ * http://www.rt-thread.org/license/LICENSE
+ */
+
+/*
+ * Compact HZ font engine.
+ *
+ * Each glyph is coded as its pixels in row order by a binary range coder. The
+ * probability of a pixel being blank is taken from the model of font by the
+ * context of 8 decoded neighbours:
+ *
+ *          . . X . .       row y - 2
+ *          X X X X X       row y - 1
+ *          X X ?           row y
+ *
+ * The runs are found while decoding, so the glyph goes into spans directly,
+ * which are kept by glyph cache as the other bitmap fonts.
+ */
+#include <rtgui/dc.h>
+#include <rtgui/font.h>
+#include <rtgui/font_cache.h>
+
+#ifdef RTGUI_USING_FONT_COMPACT
+
+/* the largest compact font is hz16 */
+#define HZ_CMP_SPAN_MAX     RTGUI_GLYPH_SPAN_MAX(16, 16)
+
+static void rtgui_hz_cmp_font_draw_text(struct rtgui_font *font, struct rtgui_dc *dc, const char *text, rt_ubase_t len, struct rtgui_rect *rect);
+static void rtgui_hz_cmp_font_get_metrics(struct rtgui_font *font, const char *text, rtgui_rect_t *rect);
+const struct rtgui_font_engine hz_cmp_font_engine =
+{
+    RT_NULL,
+    RT_NULL,
+    rtgui_hz_cmp_font_draw_text,
+    rtgui_hz_cmp_font_get_metrics
+};
+
+static int _hz_cmp_decode_index(const struct rtgui_font_compact *font, rt_uint32_t index,
+                                struct rtgui_glyph_span *spans)
+{
+    const rt_uint8_t *ptr;
+    rt_uint32_t value, range, bound;
+    rt_uint32_t row, above, above2, context;
+    int x, y, shift, start, count;
+
+    ptr = font->data + font->offset[index];
+    value = ((rt_uint32_t)ptr[0] << 24) | ((rt_uint32_t)ptr[1] << 16) |
+            ((rt_uint32_t)ptr[2] << 8) | ptr[3];
+    ptr += 4;
+    range = 0xFFFFFFFF;
+
+    count = 0;
+    above = above2 = 0;
+    for (y = 0; y < font->height; y ++)
+    {
+        row = 0;
+        start = -1;
+        for (x = 0; x < font->width; x ++)
+        {
+            shift = font->width - 1 - x;
+            context = ((row & 0x03) << 6) |
+                      ((((above << 2) >> shift) & 0x1F) << 1) |
+                      ((above2 >> shift) & 0x01);
+
+            bound = (range >> 8) * font->model[context];
+            if (value < bound)
+            {
+                range = bound;
+                row <<= 1;
+
+                if (start >= 0)
+                {
+                    spans[count].y  = y;
+                    spans[count].x1 = start;
+                    spans[count].x2 = x;
+                    count ++;
+                    start = -1;
+                }
+            }
+            else
+            {
+                value -= bound;
+                range -= bound;
+                row = (row << 1) | 0x01;
+
+                if (start < 0) start = x;
+            }
+
+            while (range < (1 << 24))
+            {
+                range <<= 8;
+                value = (value << 8) | *ptr ++;
+            }
+        }
+
+        if (start >= 0)
+        {
+            spans[count].y  = y;
+            spans[count].x1 = start;
+            spans[count].x2 = font->width;
+            count ++;
+        }
+
+        above2 = above;
+        above = row;
+    }
+
+    return count;
+}
+
+int rtgui_font_compact_decode(const struct rtgui_font_compact *font, rt_uint16_t code,
+                              struct rtgui_glyph_span *spans)
+{
+    rt_uint32_t index;
+
+    index = font->hash(code);
+    if (index >= font->count) return -1;
+
+    return _hz_cmp_decode_index(font, index, spans);
+}
+
+static int _hz_cmp_font_decode(const void *data, rt_uint16_t code,
+                               struct rtgui_glyph_span *spans)
+{
+    return rtgui_font_compact_decode((const struct rtgui_font_compact *)data, code, spans);
+}
+
+static void _rtgui_hz_cmp_font_draw_text(const struct rtgui_font_compact *cmp_font, struct rtgui_dc *dc, const char *text, rt_ubase_t len, struct rtgui_rect *rect)
+{
+    int count;
+    rt_uint16_t code;
+    rt_uint8_t *str;
+    struct rtgui_glyph_span spans[HZ_CMP_SPAN_MAX];
+
+    RT_ASSERT(cmp_font != RT_NULL);
+    RT_ASSERT(RTGUI_GLYPH_SPAN_MAX(cmp_font->width, cmp_font->height) <= HZ_CMP_SPAN_MAX);
+
+    str = (rt_uint8_t *)text;
+
+    while (len > 0 && rect->x1 < rect->x2)
+    {
+        code = *str | (*(str + 1) << 8);
+
+        /* draw with the spans in cache, or decode them here without cache */
+        if (rtgui_font_cache_draw_spans(dc, cmp_font, code, cmp_font->width, cmp_font->height,
+                                        _hz_cmp_font_decode, rect) == RT_FALSE)
+        {
+            count = rtgui_font_compact_decode(cmp_font, code, spans);
+            if (count >= 0)
+                rtgui_glyph_draw_spans(dc, spans, count, cmp_font->width, cmp_font->height, rect);
+        }
+
+        /* move x to next character */
+        rect->x1 += cmp_font->width;
+        str += 2;
+        len -= 2;
+    }
+}
+
+static void rtgui_hz_cmp_font_draw_text(struct rtgui_font *font, struct rtgui_dc *dc, const char *text, rt_ubase_t length, struct rtgui_rect *rect)
+{
+    rt_uint32_t len;
+    struct rtgui_font *efont;
+    const struct rtgui_font_compact *cmp_font = (const struct rtgui_font_compact *)(font->data);
+
+    RT_ASSERT(dc != RT_NULL);
+
+    /* get English font */
+    efont = rtgui_font_refer("asc", cmp_font->height);
+    if (efont == RT_NULL) efont = rtgui_font_default(); /* use system default font */
+
+    while (length > 0)
+    {
+        len = 0;
+        while (((rt_uint8_t) * (text + len)) < 0x80 && *(text + len) && len < length) len ++;
+        /* draw text with English font */
+        if (len > 0)
+        {
+            rtgui_font_draw(efont, dc, text, len, rect);
+
+            text += len;
+            length -= len;
+        }
+
+        len = 0;
+        while (((rt_uint8_t) * (text + len)) >= 0x80 && len < length) len ++;
+        if (len > 0)
+        {
+            _rtgui_hz_cmp_font_draw_text(cmp_font, dc, text, len, rect);
+
+            text += len;
+            length -= len;
+        }
+    }
+
+    rtgui_font_derefer(efont);
+}
+
+static void rtgui_hz_cmp_font_get_metrics(struct rtgui_font *font, const char *text, rtgui_rect_t *rect)
+{
+    const struct rtgui_font_compact *cmp_font = (const struct rtgui_font_compact *)(font->data);
+
+    RT_ASSERT(cmp_font != RT_NULL);
+
+    /* set metrics rect */
+    rect->x1 = rect->y1 = 0;
+    /* Chinese font is always fixed font */
+    rect->x2 = (rt_int16_t)(cmp_font->width * rt_strlen((const char *)text));
+    rect->y2 = cmp_font->height;
+}
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+#ifdef RTGUI_USING_FONT16
+extern const struct rtgui_font_compact hz16_compact;
+#endif
+#ifdef RTGUI_USING_FONT12
+extern const struct rtgui_font_compact hz12_compact;
+#endif
+
+static void _hz_cmp_font_bench(const char *name, const struct rtgui_font_compact *font)
+{
+    rt_uint32_t index, glyphs, spans, size;
+    rt_tick_t tick;
+    struct rtgui_glyph_span span[HZ_CMP_SPAN_MAX];
+
+    /* the coded glyphs end at the offset of the padding */
+    size = font->offset[font->count];
+    rt_kprintf("%s: %d glyphs, %d bytes coded, %d bytes in 1bpp\n", name,
+               font->count, size, font->count * ((font->width + 7) / 8) * font->height);
+    if (font->count == 0) return;
+
+    /* decode all the glyphs again and again for one second */
+    glyphs = spans = 0;
+    tick = rt_tick_get();
+    while (rt_tick_get() - tick < RT_TICK_PER_SECOND)
+    {
+        for (index = 0; index < font->count; index ++)
+            spans += _hz_cmp_decode_index(font, index, span);
+        glyphs += font->count;
+    }
+    tick = rt_tick_get() - tick;
+
+    rt_kprintf("%s: %d glyphs/s, %d spans/s\n", name,
+               glyphs * RT_TICK_PER_SECOND / tick, spans / tick * RT_TICK_PER_SECOND);
+}
+
+void list_font_compact(void)
+{
+#ifdef RTGUI_USING_FONT16
+    _hz_cmp_font_bench("hz16", &hz16_compact);
+#endif
+#ifdef RTGUI_USING_FONT12
+    _hz_cmp_font_bench("hz12", &hz12_compact);
+#endif
+}
+FINSH_FUNCTION_EXPORT(list_font_compact, display size and decode throughput of compact fonts);
+#endif
+
+#endif
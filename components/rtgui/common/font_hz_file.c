@@ -1,9 +1,12 @@
 /*
  * Cached HZ font engine
+ *
+ * The glyphs read from font file are kept in a hash table with a LRU list,
+ * the least recently used glyph is removed when the cache is full.
  */
 #include <rtgui/dc.h>
 #include <rtgui/font.h>
-#include <rtgui/tree.h>
+#include <rtgui/font_cache.h>
 #include <rtgui/rtgui_system.h>
 
 #ifdef RTGUI_USING_HZ_FILE
@@ -21,66 +24,143 @@
 #include <dfs_posix.h>
 #endif
 
-#define HZ_CACHE_MAX    64
-
-static int _font_cache_compare(struct hz_cache *node1, struct hz_cache *node2);
+#define HZ_CACHE_HASH(hz_id)    (((hz_id) ^ ((hz_id) >> 7)) % HZ_CACHE_HASH_SIZE)
+/* the most glyphs loaded by one read ahead */
+#define HZ_READ_AHEAD_MAX       32
 
+static void rtgui_hz_file_font_init(struct rtgui_font *font);
 static void rtgui_hz_file_font_load(struct rtgui_font *font);
 static void rtgui_hz_file_font_draw_text(struct rtgui_font *font, struct rtgui_dc *dc, const char *text, rt_ubase_t len, struct rtgui_rect *rect);
 static void rtgui_hz_file_font_get_metrics(struct rtgui_font *font, const char *text, rtgui_rect_t *rect);
 const struct rtgui_font_engine rtgui_hz_file_font_engine =
 {
-    RT_NULL,
+    rtgui_hz_file_font_init,
     rtgui_hz_file_font_load,
     rtgui_hz_file_font_draw_text,
     rtgui_hz_file_font_get_metrics
 };
 
-SPLAY_PROTOTYPE(cache_tree, hz_cache, hz_node, _font_cache_compare);
-SPLAY_GENERATE(cache_tree, hz_cache, hz_node, _font_cache_compare);
+rt_inline rt_bool_t _font_hz_valid(rt_uint16_t hz_id)
+{
+    return (hz_id & 0xff) > 0xA0 && (hz_id >> 8) > 0xA0;
+}
 
-static int _font_cache_compare(struct hz_cache *cache_1, struct hz_cache *cache_2)
+rt_inline rt_uint32_t _font_hz_offset(struct rtgui_hz_file_font *font, rt_uint16_t hz_id)
 {
-    if (cache_1->hz_id > cache_2->hz_id) return 1;
-    if (cache_1->hz_id < cache_2->hz_id) return -1;
+    rt_uint32_t seek;
 
-    return 0;
+    seek = 94 * (((hz_id & 0xff) - 0xA0) - 1) + ((hz_id >> 8) - 0xA0) - 1;
+    return seek * font->font_data_size;
 }
 
-static rt_uint8_t *_font_cache_get(struct rtgui_hz_file_font *font, rt_uint16_t hz_id)
+/* find a glyph in cache and move it to the head of lru list, should be
+ * invoked in critical */
+static struct hz_cache *_font_cache_find(struct rtgui_hz_file_font *font, rt_uint16_t hz_id)
 {
-    rt_uint32_t seek;
-    struct hz_cache *cache, search;
+    struct hz_cache *cache;
+
+    for (cache = font->cache_hash[HZ_CACHE_HASH(hz_id)]; cache != RT_NULL; cache = cache->hash_next)
+    {
+        if (cache->hz_id == hz_id)
+        {
+            rtgui_dlist_remove(&(cache->lru));
+            rtgui_dlist_insert_after(&(font->cache_lru), &(cache->lru));
+            return cache;
+        }
+    }
+
+    return RT_NULL;
+}
+
+/* remove the least recently used glyphs until there are less than count
+ * glyphs in cache, should be invoked in critical */
+static void _font_cache_shrink(struct rtgui_hz_file_font *font, rt_uint16_t count)
+{
+    struct hz_cache *cache, **pcache;
+
+    while (font->cache_size > count)
+    {
+        cache = rtgui_dlist_entry(font->cache_lru.prev, struct hz_cache, lru);
+        rtgui_dlist_remove(&(cache->lru));
+
+        pcache = &(font->cache_hash[HZ_CACHE_HASH(cache->hz_id)]);
+        while (*pcache != cache) pcache = &((*pcache)->hash_next);
+        *pcache = cache->hash_next;
 
-    search.hz_id = hz_id;
+        rtgui_free(cache);
+        font->cache_size --;
+    }
+}
+
+/* insert a loaded glyph into cache, return the glyph in cache */
+static struct hz_cache *_font_cache_insert(struct rtgui_hz_file_font *font, struct hz_cache *cache)
+{
+    struct hz_cache *exist;
+    rt_uint32_t hash;
 
     /* enter critical */
     rtgui_enter_critical();
 
-    cache = SPLAY_FIND(cache_tree, &(font->cache_root), &search);
+    /* it may be loaded by other thread */
+    exist = _font_cache_find(font, cache->hz_id);
+    if (exist != RT_NULL)
+    {
+        rtgui_exit_critical();
+
+        rtgui_free(cache);
+        return exist;
+    }
+
+    if (font->cache_size >= font->cache_max)
+        _font_cache_shrink(font, font->cache_max > 0 ? font->cache_max - 1 : 0);
+
+    hash = HZ_CACHE_HASH(cache->hz_id);
+    cache->hash_next = font->cache_hash[hash];
+    font->cache_hash[hash] = cache;
+    rtgui_dlist_insert_after(&(font->cache_lru), &(cache->lru));
+    font->cache_size ++;
+
+    /* exit critical */
+    rtgui_exit_critical();
+
+    return cache;
+}
+
+static rt_uint8_t *_font_cache_get(struct rtgui_hz_file_font *font, rt_uint16_t hz_id)
+{
+    struct hz_cache *cache;
+
+    /* enter critical */
+    rtgui_enter_critical();
+
+    cache = _font_cache_find(font, hz_id);
     if (cache != RT_NULL)
     {
+        font->hit ++;
         /* exit critical */
         rtgui_exit_critical();
 
         /* found it */
         return (rt_uint8_t *)(cache + 1);
     }
+    font->miss ++;
 
     /* exit critical */
     rtgui_exit_critical();
 
+    if (!_font_hz_valid(hz_id) || font->cache_max == 0)
+        return RT_NULL;
+
     /* can not find it, load to cache */
     cache = (struct hz_cache *) rtgui_malloc(sizeof(struct hz_cache) + font->font_data_size);
     if (cache == RT_NULL)
         return RT_NULL; /* no memory yet */
 
     cache->hz_id = hz_id;
-    seek = 94 * (((hz_id & 0xff) - 0xA0) - 1) + ((hz_id >> 8) - 0xA0) - 1;
-    seek *= font->font_data_size;
 
     /* read hz font data */
-    if ((lseek(font->fd, seek, SEEK_SET) < 0) ||
+    font->read_count ++;
+    if ((lseek(font->fd, _font_hz_offset(font, hz_id), SEEK_SET) < 0) ||
             read(font->fd, (char *)(cache + 1), font->font_data_size) !=
             font->font_data_size)
     {
@@ -88,30 +168,126 @@ static rt_uint8_t *_font_cache_get(struct rtgui_hz_file_font *font, rt_uint16_t
         return RT_NULL;
     }
 
-    /* enter critical */
-    rtgui_enter_critical();
+    cache = _font_cache_insert(font, cache);
+
+    return (rt_uint8_t *)(cache + 1);
+}
+
+/*
+ * Load all the glyphs of text which are not in cache. The missing glyphs
+ * are sorted by the offset in font file, and the glyphs near each other are
+ * loaded with one sequential read instead of one seek and read for each.
+ */
+static void _font_cache_read_ahead(struct rtgui_hz_file_font *font, const rt_uint8_t *str, rt_ubase_t len)
+{
+    rt_uint16_t missing[HZ_READ_AHEAD_MAX];
+    rt_uint16_t hz_id, count, max;
+    rt_uint32_t begin, end;
+    rt_uint8_t *buffer;
+    int i, j, k;
+
+    if (font->fd < 0) return;
+
+    /* don't load more glyphs than the cache could hold */
+    max = font->cache_max < HZ_READ_AHEAD_MAX ? font->cache_max : HZ_READ_AHEAD_MAX;
 
-    if (font->cache_size >= HZ_CACHE_MAX)
+    count = 0;
+    for (; len >= 2 && count < max; str += 2, len -= 2)
     {
-        /* remove a cache */
-        struct hz_cache *left;
-        left = font->cache_root.sph_root;
-        while (SPLAY_LEFT(left, hz_node) != RT_NULL) left = SPLAY_LEFT(left, hz_node);
-
-        /* remove the left node */
-        SPLAY_REMOVE(cache_tree, &(font->cache_root), left);
-        rtgui_free(left);
-        font->cache_size --;
+        struct hz_cache *cache;
+
+        hz_id = *str | (*(str + 1) << 8);
+        if (!_font_hz_valid(hz_id)) continue;
+        /* the expanded glyph is in glyph cache */
+        if (rtgui_font_cache_lookup(font, hz_id) == RT_TRUE) continue;
+
+        rtgui_enter_critical();
+        cache = _font_cache_find(font, hz_id);
+        rtgui_exit_critical();
+        if (cache != RT_NULL) continue;
+
+        /* insert sort by the offset, which is the order of hz_id in bytes swapped */
+        for (i = count; i > 0; i --)
+        {
+            rt_uint16_t prev = missing[i - 1];
+
+            if (((prev & 0xff) << 8 | prev >> 8) <= ((hz_id & 0xff) << 8 | hz_id >> 8))
+                break;
+            missing[i] = prev;
+        }
+        if (i > 0 && missing[i - 1] == hz_id)
+        {
+            /* duplicated, move back */
+            for (; i < count; i ++) missing[i] = missing[i + 1];
+            continue;
+        }
+        missing[i] = hz_id;
+        count ++;
     }
 
-    /* insert to cache */
-    SPLAY_INSERT(cache_tree, &(font->cache_root), cache);
-    font->cache_size ++;
+    if (count == 0) return;
 
-    /* exit critical */
+    buffer = (rt_uint8_t *) rtgui_malloc(RTGUI_HZ_FILE_READ_AHEAD);
+    if (buffer == RT_NULL) return;
+
+    for (i = 0; i < count; i = j)
+    {
+        /* coalesce the following glyphs in the read ahead window */
+        begin = _font_hz_offset(font, missing[i]);
+        for (j = i + 1; j < count; j ++)
+        {
+            end = _font_hz_offset(font, missing[j]) + font->font_data_size;
+            if (end - begin > RTGUI_HZ_FILE_READ_AHEAD) break;
+        }
+        end = _font_hz_offset(font, missing[j - 1]) + font->font_data_size;
+
+        font->read_count ++;
+        if ((lseek(font->fd, begin, SEEK_SET) < 0) ||
+                read(font->fd, (char *)buffer, end - begin) != end - begin)
+            break;
+
+        for (k = i; k < j; k ++)
+        {
+            struct hz_cache *cache;
+
+            cache = (struct hz_cache *) rtgui_malloc(sizeof(struct hz_cache) + font->font_data_size);
+            if (cache == RT_NULL) break;
+
+            cache->hz_id = missing[k];
+            rt_memcpy(cache + 1, buffer + _font_hz_offset(font, missing[k]) - begin,
+                      font->font_data_size);
+            _font_cache_insert(font, cache);
+        }
+    }
+
+    rtgui_free(buffer);
+}
+
+void rtgui_hz_file_font_set_cache_size(struct rtgui_font *font, rt_uint16_t count)
+{
+    struct rtgui_hz_file_font *hz_file_font;
+
+    RT_ASSERT(font != RT_NULL);
+    RT_ASSERT(font->engine == &rtgui_hz_file_font_engine);
+
+    hz_file_font = (struct rtgui_hz_file_font *)font->data;
+
+    rtgui_enter_critical();
+    hz_file_font->cache_max = count;
+    _font_cache_shrink(hz_file_font, count);
     rtgui_exit_critical();
+}
+RTM_EXPORT(rtgui_hz_file_font_set_cache_size);
 
-    return (rt_uint8_t *)(cache + 1);
+static void rtgui_hz_file_font_init(struct rtgui_font *font)
+{
+    struct rtgui_hz_file_font *hz_file_font = (struct rtgui_hz_file_font *)font->data;
+    RT_ASSERT(hz_file_font != RT_NULL);
+
+    rt_memset(hz_file_font->cache_hash, 0, sizeof(hz_file_font->cache_hash));
+    rtgui_dlist_init(&(hz_file_font->cache_lru));
+    hz_file_font->cache_size = 0;
+    hz_file_font->hit = hz_file_font->miss = hz_file_font->read_count = 0;
 }
 
 static void rtgui_hz_file_font_load(struct rtgui_font *font)
@@ -127,6 +303,21 @@ static void rtgui_hz_file_font_load(struct rtgui_font *font)
     }
 }
 
+static rt_bool_t _hz_file_font_load_glyph(const void *data, rt_uint16_t code,
+                                          struct rtgui_glyph_bitmap *bitmap)
+{
+    struct rtgui_hz_file_font *hz_file_font = (struct rtgui_hz_file_font *)data;
+
+    bitmap->data = _font_cache_get(hz_file_font, code);
+    if (bitmap->data == RT_NULL) return RT_FALSE;
+
+    bitmap->pitch  = (hz_file_font->font_size + 7) / 8;
+    bitmap->width  = hz_file_font->font_size;
+    bitmap->height = hz_file_font->font_size;
+
+    return RT_TRUE;
+}
+
 static void _rtgui_hz_file_font_draw_text(struct rtgui_hz_file_font *hz_file_font, struct rtgui_dc *dc, const char *text, rt_ubase_t len, struct rtgui_rect *rect)
 {
     rt_uint8_t *str;
@@ -145,13 +336,27 @@ static void _rtgui_hz_file_font_draw_text(struct rtgui_hz_file_font *hz_file_fon
 
     str = (rt_uint8_t *)text;
 
+    /* load all the missing glyphs before drawing */
+    _font_cache_read_ahead(hz_file_font, str, len);
+
     while (len > 0 && rect->x1 < rect->x2)
     {
         const rt_uint8_t *font_ptr;
         register rt_base_t i, j, k;
 
+        /* draw with the expanded glyph in cache */
+        if (rtgui_font_cache_draw(dc, hz_file_font, *str | (*(str + 1) << 8),
+                                  _hz_file_font_load_glyph, rect) == RT_TRUE)
+        {
+            rect->x1 += hz_file_font->font_size;
+            str += 2;
+            len -= 2;
+            continue;
+        }
+
         /* get font pixel data */
         font_ptr = _font_cache_get(hz_file_font, *str | (*(str + 1) << 8));
+        if (font_ptr == RT_NULL) break;
 
         /* draw word */
         for (i = 0; i < h; i ++)
@@ -228,4 +433,32 @@ static void rtgui_hz_file_font_get_metrics(struct rtgui_font *font, const char *
     rect->x2 = (rt_int16_t)(hz_file_font->font_size / 2 * rt_strlen((const char *)text));
     rect->y2 = hz_file_font->font_size;
 }
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+static void _list_hzcache(rt_uint16_t size)
+{
+    struct rtgui_font *font;
+    struct rtgui_hz_file_font *hz_file_font;
+
+    font = rtgui_font_refer("hz", size);
+    if (font == RT_NULL) return;
+
+    if (font->engine == &rtgui_hz_file_font_engine)
+    {
+        hz_file_font = (struct rtgui_hz_file_font *)font->data;
+        rt_kprintf("hz%d: %d/%d glyphs, hit: %d, miss: %d, read: %d\n", size,
+                   hz_file_font->cache_size, hz_file_font->cache_max,
+                   hz_file_font->hit, hz_file_font->miss, hz_file_font->read_count);
+    }
+    rtgui_font_derefer(font);
+}
+
+void list_hzcache(void)
+{
+    _list_hzcache(12);
+    _list_hzcache(16);
+}
+FINSH_FUNCTION_EXPORT(list_hzcache, display HZ file font cache statistics);
+#endif
 #endif
@@ -0,0 +1,381 @@
+/*
+ * File      : font_hz_flash.c
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2013, RT-Thread Development Team
+ *
+ * The license and distribution terms for this file may be
+ * found in the file LICENSE in this distribution or at
+ * http://www.rt-thread.org/license/LICENSE
+ */
+
+/*
+ * HZ font engine of raw flash partition
+ *
+ * The glyphs are read from a raw partition device by offset, without file
+ * system. The offset of a glyph is computed from the header of font:
+ *
+ *   data_offset + ((zone - first_zone) * positions + (pos - first_pos)) * data_size
+ *
+ * The glyphs of a string which are not in glyph cache are sorted by offset
+ * and the adjacent ones are loaded with one read.
+ */
+#include <rtgui/dc.h>
+#include <rtgui/font.h>
+#include <rtgui/font_cache.h>
+#include <rtgui/rtgui_system.h>
+
+#ifdef RTGUI_USING_HZ_FLASH
+
+/* the maximal fonts in the header table of partition */
+#define HZ_FLASH_FONT_MAX   8
+
+static void rtgui_hz_flash_font_init(struct rtgui_font *font);
+static void rtgui_hz_flash_font_load(struct rtgui_font *font);
+static void rtgui_hz_flash_font_draw_text(struct rtgui_font *font, struct rtgui_dc *dc, const char *text, rt_ubase_t len, struct rtgui_rect *rect);
+static void rtgui_hz_flash_font_get_metrics(struct rtgui_font *font, const char *text, rtgui_rect_t *rect);
+const struct rtgui_font_engine rtgui_hz_flash_font_engine =
+{
+    rtgui_hz_flash_font_init,
+    rtgui_hz_flash_font_load,
+    rtgui_hz_flash_font_draw_text,
+    rtgui_hz_flash_font_get_metrics
+};
+
+/* get the index of glyph in font, return -1 if it's not in font */
+rt_inline int _hz_flash_font_index(struct rtgui_hz_flash_font *font, rt_uint16_t code)
+{
+    rt_uint8_t zone = code & 0xff, pos = code >> 8;
+    struct rtgui_hz_flash_header *header = &(font->header);
+
+    if (zone < header->first_zone || zone > header->last_zone ||
+            pos < header->first_pos || pos > header->last_pos)
+        return -1;
+
+    return (zone - header->first_zone) * (header->last_pos - header->first_pos + 1) +
+           (pos - header->first_pos);
+}
+
+rt_inline rt_uint32_t _hz_flash_font_offset(struct rtgui_hz_flash_font *font, int index)
+{
+    return font->header.data_offset + index * font->header.data_size;
+}
+
+/* load the glyphs of str which are not in glyph cache, should be invoked
+ * with lock */
+static void _hz_flash_font_batch_read(struct rtgui_hz_flash_font *font, const rt_uint8_t *str, int count)
+{
+    int index[RTGUI_HZ_FLASH_BATCH];
+    int i, j, k, n;
+    rt_uint16_t code;
+
+    n = 0;
+    for (i = 0; i < count; i ++, str += 2)
+    {
+        code = *str | (*(str + 1) << 8);
+        k = _hz_flash_font_index(font, code);
+        if (k < 0) continue;
+        /* the expanded glyph is in glyph cache */
+        if (rtgui_font_cache_lookup(font, code) == RT_TRUE) continue;
+
+        /* insert sort by the index, skip the duplicated one */
+        for (j = n; j > 0 && index[j - 1] > k; j --);
+        if (j > 0 && index[j - 1] == k) continue;
+        rt_memmove(&index[j + 1], &index[j], (n - j) * sizeof(int));
+        rt_memmove(&(font->batch_code[j + 1]), &(font->batch_code[j]), (n - j) * sizeof(rt_uint16_t));
+        index[j] = k;
+        font->batch_code[j] = code;
+        n ++;
+    }
+
+    font->batch_count = 0;
+    for (i = 0; i < n; i = j)
+    {
+        /* read the adjacent glyphs at once */
+        for (j = i + 1; j < n && index[j] == index[j - 1] + 1; j ++);
+
+        font->read_count ++;
+        if (rt_device_read(font->device, _hz_flash_font_offset(font, index[i]),
+                           font->batch_buffer + i * font->header.data_size,
+                           (j - i) * font->header.data_size) != (j - i) * font->header.data_size)
+            break;
+        font->batch_count = j;
+    }
+}
+
+/* get the glyph data of code, should be invoked with lock */
+static const rt_uint8_t *_hz_flash_font_get(struct rtgui_hz_flash_font *font, rt_uint16_t code)
+{
+    int i;
+    rt_uint8_t *ptr;
+
+    for (i = 0; i < font->batch_count; i ++)
+    {
+        if (font->batch_code[i] == code)
+            return font->batch_buffer + i * font->header.data_size;
+    }
+
+    /* not in batch, read it into the last slot */
+    i = _hz_flash_font_index(font, code);
+    if (i < 0) return RT_NULL;
+
+    ptr = font->batch_buffer + RTGUI_HZ_FLASH_BATCH * font->header.data_size;
+    font->read_count ++;
+    if (rt_device_read(font->device, _hz_flash_font_offset(font, i), ptr,
+                       font->header.data_size) != font->header.data_size)
+        return RT_NULL;
+
+    return ptr;
+}
+
+static rt_bool_t _hz_flash_font_load_glyph(const void *data, rt_uint16_t code,
+                                           struct rtgui_glyph_bitmap *bitmap)
+{
+    struct rtgui_hz_flash_font *font = (struct rtgui_hz_flash_font *)data;
+
+    bitmap->data = _hz_flash_font_get(font, code);
+    if (bitmap->data == RT_NULL) return RT_FALSE;
+
+    bitmap->pitch  = (font->font_size + 7) / 8;
+    bitmap->width  = font->font_size;
+    bitmap->height = font->font_size;
+
+    return RT_TRUE;
+}
+
+static void rtgui_hz_flash_font_init(struct rtgui_font *font)
+{
+    struct rtgui_hz_flash_font *hz_flash_font = (struct rtgui_hz_flash_font *)font->data;
+    RT_ASSERT(hz_flash_font != RT_NULL);
+
+    rt_mutex_init(&(hz_flash_font->lock), "hzflash", RT_IPC_FLAG_FIFO);
+    hz_flash_font->device = RT_NULL;
+    hz_flash_font->batch_count = 0;
+    hz_flash_font->batch_buffer = RT_NULL;
+    hz_flash_font->read_count = 0;
+}
+
+static void rtgui_hz_flash_font_load(struct rtgui_font *font)
+{
+    int i;
+    rt_device_t device;
+    struct rtgui_hz_flash_header header[HZ_FLASH_FONT_MAX];
+    struct rtgui_hz_flash_font *hz_flash_font = (struct rtgui_hz_flash_font *)font->data;
+    RT_ASSERT(hz_flash_font != RT_NULL);
+
+    device = rt_device_find(hz_flash_font->device_name);
+    if (device == RT_NULL || rt_device_open(device, RT_DEVICE_OFLAG_RDONLY) != RT_EOK)
+    {
+        rt_kprintf("RTGUI: could not open the font partition:%s\n", hz_flash_font->device_name);
+        return;
+    }
+
+    /* find the header of font size */
+    rt_memset(header, 0, sizeof(header));
+    rt_device_read(device, 0, header, sizeof(header));
+    for (i = 0; i < HZ_FLASH_FONT_MAX && header[i].magic == HZ_FLASH_MAGIC; i ++)
+    {
+        if (header[i].font_size == hz_flash_font->font_size) break;
+    }
+    if (i == HZ_FLASH_FONT_MAX || header[i].magic != HZ_FLASH_MAGIC ||
+            header[i].data_size != (hz_flash_font->font_size + 7) / 8 * hz_flash_font->font_size)
+    {
+        rt_kprintf("RTGUI: no hz%d font in partition:%s\n", hz_flash_font->font_size,
+                   hz_flash_font->device_name);
+        rt_device_close(device);
+        return;
+    }
+
+    /* one more slot for the glyph out of batch */
+    hz_flash_font->batch_buffer = (rt_uint8_t *) rtgui_malloc((RTGUI_HZ_FLASH_BATCH + 1) * header[i].data_size);
+    if (hz_flash_font->batch_buffer == RT_NULL)
+    {
+        rt_device_close(device);
+        return;
+    }
+
+    hz_flash_font->header = header[i];
+    hz_flash_font->device = device;
+}
+
+static void _rtgui_hz_flash_font_draw_text(struct rtgui_hz_flash_font *hz_flash_font, struct rtgui_dc *dc, const char *text, rt_ubase_t len, struct rtgui_rect *rect)
+{
+    rt_uint8_t *str;
+    rtgui_color_t bc;
+    rt_uint16_t style;
+    register rt_base_t h, word_bytes;
+
+    /* get text style */
+    style = rtgui_dc_get_gc(dc)->textstyle;
+    bc = rtgui_dc_get_gc(dc)->background;
+
+    /* drawing height */
+    h = (hz_flash_font->font_size + rect->y1 > rect->y2) ?
+        rect->y2 - rect->y1 : hz_flash_font->font_size;
+    word_bytes = (hz_flash_font->font_size + 7) / 8;
+
+    str = (rt_uint8_t *)text;
+
+    rt_mutex_take(&(hz_flash_font->lock), RT_WAITING_FOREVER);
+    while (len >= 2 && rect->x1 < rect->x2)
+    {
+        rt_base_t count;
+
+        count = len / 2 > RTGUI_HZ_FLASH_BATCH ? RTGUI_HZ_FLASH_BATCH : len / 2;
+        _hz_flash_font_batch_read(hz_flash_font, str, count);
+
+        for (; count > 0 && rect->x1 < rect->x2; count --)
+        {
+            const rt_uint8_t *font_ptr;
+            register rt_base_t i, j, k;
+
+            /* draw with the expanded glyph in cache */
+            if (rtgui_font_cache_draw(dc, hz_flash_font, *str | (*(str + 1) << 8),
+                                      _hz_flash_font_load_glyph, rect) == RT_FALSE)
+            {
+                /* get font pixel data */
+                font_ptr = _hz_flash_font_get(hz_flash_font, *str | (*(str + 1) << 8));
+                if (font_ptr == RT_NULL)
+                {
+                    len = 0;
+                    break;
+                }
+
+                /* draw word */
+                for (i = 0; i < h; i ++)
+                {
+                    for (j = 0; j < word_bytes; j++)
+                        for (k = 0; k < 8; k++)
+                        {
+                            if (((font_ptr[i * word_bytes + j] >> (7 - k)) & 0x01) != 0 &&
+                                    (rect->x1 + 8 * j + k < rect->x2))
+                            {
+                                rtgui_dc_draw_point(dc, rect->x1 + 8 * j + k, rect->y1 + i);
+                            }
+                            else if (style & RTGUI_TEXTSTYLE_DRAW_BACKGROUND)
+                            {
+                                rtgui_dc_draw_color_point(dc, rect->x1 + 8 * j + k, rect->y1 + i, bc);
+                            }
+                        }
+                }
+            }
+
+            /* move x to next character */
+            rect->x1 += hz_flash_font->font_size;
+            str += 2;
+            len -= 2;
+        }
+    }
+    rt_mutex_release(&(hz_flash_font->lock));
+}
+
+static void rtgui_hz_flash_font_draw_text(struct rtgui_font *font, struct rtgui_dc *dc, const char *text, rt_ubase_t length, struct rtgui_rect *rect)
+{
+    rt_uint32_t len;
+    struct rtgui_font *efont;
+    struct rtgui_hz_flash_font *hz_flash_font = (struct rtgui_hz_flash_font *)font->data;
+
+    RT_ASSERT(dc != RT_NULL);
+    RT_ASSERT(hz_flash_font != RT_NULL);
+
+    /* get English font */
+    efont = rtgui_font_refer("asc", hz_flash_font->font_size);
+    if (efont == RT_NULL) efont = rtgui_font_default(); /* use system default font */
+
+    while (length > 0)
+    {
+        len = 0;
+        while (((rt_uint8_t) * (text + len)) < 0x80 && *(text + len) && len < length) len ++;
+        /* draw text with English font */
+        if (len > 0)
+        {
+            rtgui_font_draw(efont, dc, text, len, rect);
+
+            text += len;
+            length -= len;
+        }
+
+        len = 0;
+        while (((rt_uint8_t) * (text + len)) >= 0x80 && len < length) len ++;
+        if (len > 0)
+        {
+            if (hz_flash_font->device != RT_NULL)
+                _rtgui_hz_flash_font_draw_text(hz_flash_font, dc, text, len, rect);
+
+            text += len;
+            length -= len;
+        }
+    }
+
+    rtgui_font_derefer(efont);
+}
+
+static void rtgui_hz_flash_font_get_metrics(struct rtgui_font *font, const char *text, rtgui_rect_t *rect)
+{
+    struct rtgui_hz_flash_font *hz_flash_font = (struct rtgui_hz_flash_font *)font->data;
+    RT_ASSERT(hz_flash_font != RT_NULL);
+
+    /* set metrics rect */
+    rect->x1 = rect->y1 = 0;
+    rect->x2 = (rt_int16_t)(hz_flash_font->font_size / 2 * rt_strlen((const char *)text));
+    rect->y2 = hz_flash_font->font_size;
+}
+
+#if defined(RT_USING_FINSH) && defined(RT_USING_DFS)
+#include <finsh.h>
+#include <dfs_posix.h>
+/* write the image made by utils/mkhzflash.py to font partition */
+void hz_flash_update(const char *filename)
+{
+    int fd, length;
+    rt_uint32_t pos;
+    rt_uint8_t *buffer;
+    rt_device_t device;
+    struct rt_device_blk_geometry geometry;
+
+    device = rt_device_find(RTGUI_HZ_FLASH_DEVICE);
+    if (device == RT_NULL)
+    {
+        rt_kprintf("no font partition:%s\n", RTGUI_HZ_FLASH_DEVICE);
+        return;
+    }
+    rt_memset(&geometry, 0, sizeof(geometry));
+    rt_device_control(device, RT_DEVICE_CTRL_BLK_GETGEOME, &geometry);
+    if (geometry.bytes_per_sector == 0) return;
+
+    fd = open(filename, O_RDONLY, 0);
+    if (fd < 0)
+    {
+        rt_kprintf("open %s failed\n", filename);
+        return;
+    }
+
+    buffer = (rt_uint8_t *) rtgui_malloc(geometry.bytes_per_sector);
+    if (buffer == RT_NULL)
+    {
+        close(fd);
+        return;
+    }
+
+    rt_device_open(device, RT_DEVICE_OFLAG_RDWR);
+    for (pos = 0; ; pos += geometry.bytes_per_sector)
+    {
+        length = read(fd, (char *)buffer, geometry.bytes_per_sector);
+        if (length <= 0) break;
+
+        /* fill the tail of the last sector */
+        rt_memset(buffer + length, 0xff, geometry.bytes_per_sector - length);
+        if (rt_device_write(device, pos, buffer, geometry.bytes_per_sector) != geometry.bytes_per_sector)
+        {
+            rt_kprintf("write font partition failed at 0x%08x\n", pos);
+            break;
+        }
+    }
+    rt_device_close(device);
+    rt_kprintf("%d bytes written, reboot to load fonts\n", pos);
+
+    rtgui_free(buffer);
+    close(fd);
+}
+FINSH_FUNCTION_EXPORT(hz_flash_update, write font image to flash partition);
+#endif
+#endif
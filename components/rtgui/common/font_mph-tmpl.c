@@ -1,7 +1,7 @@
 /* adapted from utils/perfect_hash/example1-C/states-tmpl.c */
 
 #include <rtthread.h>
-#include <string.h>
+#include <rtgui/font.h>
 
 static const rt_uint32_t T1[] = { $S1 };
 static const rt_uint32_t T2[] = { $S2 };
@@ -18,7 +18,7 @@ static rt_uint32_t perfect_hash(const rt_uint16_t key)
     return (hash_g(key, T1) + hash_g(key, T2)) % $NG;
 }
 
-rt_uint32_t rtgui_font_mph${height}(const rt_uint16_t key)
+static rt_uint32_t rtgui_font_mph${height}(const rt_uint16_t key)
 {
     rt_uint32_t hash_value = perfect_hash(key);
 
@@ -31,5 +31,24 @@ rt_uint32_t rtgui_font_mph${height}(const rt_uint16_t key)
     return -1;
 }
 
-const unsigned char hz${height}_font[] = { $font_data };
+/* probability of blank pixel in 1/256 for each context of pixel */
+static const rt_uint8_t hz${height}_model[256] = { $font_model };
+
+/* offset of each glyph, the last one is the end of coded glyphs */
+static const rt_uint16_t hz${height}_offset[] = { $font_offset };
+
+/* $count glyphs, $coded_size bytes coded ($size bytes in 1bpp, $full_size bytes in full font),
+ * the trailing 4 bytes are read ahead by the decoder of last glyph */
+static const rt_uint8_t hz${height}_data[] = { $font_data };
+
+const struct rtgui_font_compact hz${height}_compact =
+{
+    $width,                 /* width */
+    $height,                /* height */
+    $count,                 /* count */
+    rtgui_font_mph${height},/* hash */
+    hz${height}_model,      /* model */
+    hz${height}_offset,     /* offset */
+    hz${height}_data,       /* data */
+};
 
@@ -53,6 +53,26 @@ static void _rgb565_draw_vline(rtgui_color_t *c, int x , int y1, int y2)
     }
 }
 
+static void _rgb565_draw_hspans(rtgui_color_t *c, const struct rtgui_span *spans, int count)
+{
+    rt_ubase_t index;
+    rt_uint16_t pixel;
+    rt_uint16_t *pixel_ptr;
+
+    /* get pixel from color once for all spans */
+    pixel = rtgui_color_to_565(*c);
+
+    for (; count > 0; count --, spans ++)
+    {
+        pixel_ptr = GET_PIXEL(rtgui_graphic_get_device(), spans->x1, spans->y, rt_uint16_t);
+        for (index = spans->x1; index < spans->x2; index ++)
+        {
+            *pixel_ptr = pixel;
+            pixel_ptr ++;
+        }
+    }
+}
+
 static void _rgb565p_set_pixel(rtgui_color_t *c, int x, int y)
 {
     *GET_PIXEL(rtgui_graphic_get_device(), x, y, rt_uint16_t) = rtgui_color_to_565p(*c);
@@ -102,6 +122,26 @@ static void _rgb565p_draw_vline(rtgui_color_t *c, int x , int y1, int y2)
     }
 }
 
+static void _rgb565p_draw_hspans(rtgui_color_t *c, const struct rtgui_span *spans, int count)
+{
+    rt_ubase_t index;
+    rt_uint16_t pixel;
+    rt_uint16_t *pixel_ptr;
+
+    /* get pixel from color once for all spans */
+    pixel = rtgui_color_to_565p(*c);
+
+    for (; count > 0; count --, spans ++)
+    {
+        pixel_ptr = GET_PIXEL(rtgui_graphic_get_device(), spans->x1, spans->y, rt_uint16_t);
+        for (index = spans->x1; index < spans->x2; index ++)
+        {
+            *pixel_ptr = pixel;
+            pixel_ptr ++;
+        }
+    }
+}
+
 /* draw raw hline */
 static void framebuffer_draw_raw_hline(rt_uint8_t *pixels, int x1, int x2, int y)
 {
@@ -118,6 +158,7 @@ const struct rtgui_graphic_driver_ops _framebuffer_rgb565_ops =
     _rgb565_draw_hline,
     _rgb565_draw_vline,
     framebuffer_draw_raw_hline,
+    _rgb565_draw_hspans,
 };
 
 const struct rtgui_graphic_driver_ops _framebuffer_rgb565p_ops =
@@ -127,6 +168,7 @@ const struct rtgui_graphic_driver_ops _framebuffer_rgb565p_ops =
     _rgb565p_draw_hline,
     _rgb565p_draw_vline,
     framebuffer_draw_raw_hline,
+    _rgb565p_draw_hspans,
 };
 
 #define FRAMEBUFFER (rtgui_graphic_get_device()->framebuffer)
@@ -202,6 +244,7 @@ const struct rtgui_graphic_driver_ops _framebuffer_mono_ops =
     _mono_draw_hline,
     _mono_draw_vline,
     _mono_draw_raw_hline,
+    RT_NULL,
 };
 
 const struct rtgui_graphic_driver_ops *rtgui_framebuffer_get_ops(int pixel_format)
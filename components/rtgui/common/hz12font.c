@@ -1,9 +1,17 @@
 #include <rtgui/font.h>
 
 #ifdef RTGUI_USING_FONT12
-#ifndef RTGUI_USING_HZ_FILE
+#if !defined(RTGUI_USING_HZ_FILE) && !defined(RTGUI_USING_HZ_FLASH)
 #ifdef RTGUI_USING_FONT_COMPACT
-extern const unsigned char hz12_font[];
+extern const struct rtgui_font_compact hz12_compact;
+struct rtgui_font rtgui_font_hz12 =
+{
+    "hz",               /* family */
+    12,                 /* height */
+    1,                  /* refer count */
+    &hz_cmp_font_engine,/* font engine */
+    (void *) &hz12_compact,/* font private data */
+};
 #else
 const unsigned char hz12_font[] =
 {
@@ -12277,7 +12285,6 @@ const unsigned char hz12_font[] =
     0x4c, 0x90, 0xfb, 0xe0, 0xaa, 0x20, 0xfb, 0xe0, 0x02, 0x20, 0xff, 0xe0, 0x48, 0x00, 0x8b, 0xf0,
     FONT_BMP_DATA_END
 };
-#endif
 
 const struct rtgui_font_bitmap hz12 =
 {
@@ -12300,11 +12307,29 @@ struct rtgui_font rtgui_font_hz12 =
     (void *) &hz12,     /* font private data */
 };
 /* size = 196272 bytes */
+#endif
+#elif defined(RTGUI_USING_HZ_FLASH)
+struct rtgui_hz_flash_font hz12 =
+{
+    RTGUI_HZ_FLASH_DEVICE,  /* device name      */
+    12,                     /* font size        */
+};
+
+struct rtgui_font rtgui_font_hz12 =
+{
+    "hz",               /* family */
+    12,                 /* height */
+    1,                  /* refer count */
+    &rtgui_hz_flash_font_engine,/* font engine */
+    (void *) &hz12,     /* font private data */
+};
 #else
 struct rtgui_hz_file_font hz12 =
 {
-    {RT_NULL},              /* cache root       */
+    {RT_NULL},              /* cache hash       */
+    {RT_NULL, RT_NULL},     /* cache lru        */
     0,                      /* cache size       */
+    RTGUI_HZ_FILE_CACHE_MAX,/* cache max        */
     12,                     /* font size        */
     24,                     /* font data size   */
     -1,                     /* fd               */
@@ -1,9 +1,17 @@
 #include <rtgui/font.h>
 
 #ifdef RTGUI_USING_FONT16
-#ifndef RTGUI_USING_HZ_FILE
+#if !defined(RTGUI_USING_HZ_FILE) && !defined(RTGUI_USING_HZ_FLASH)
 #ifdef RTGUI_USING_FONT_COMPACT
-extern const unsigned char hz16_font[];
+extern const struct rtgui_font_compact hz16_compact;
+struct rtgui_font rtgui_font_hz16 =
+{
+    "hz",               /* family */
+    16,                 /* height */
+    1,                  /* refer count */
+    &hz_cmp_font_engine,/* font engine */
+    (void *) &hz16_compact,/* font private data */
+};
 #else
 const unsigned char hz16_font[] =
 {
@@ -16736,7 +16744,6 @@ const unsigned char hz16_font[] =
     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
     FONT_BMP_DATA_END
 };
-#endif
 
 const struct rtgui_font_bitmap hz16 =
 {
@@ -16759,11 +16766,29 @@ struct rtgui_font rtgui_font_hz16 =
     (void *) &hz16,     /* font private data */
 };
 /* size = 267616 bytes */
+#endif
+#elif defined(RTGUI_USING_HZ_FLASH)
+struct rtgui_hz_flash_font hz16 =
+{
+    RTGUI_HZ_FLASH_DEVICE,  /* device name      */
+    16,                     /* font size        */
+};
+
+struct rtgui_font rtgui_font_hz16 =
+{
+    "hz",               /* family */
+    16,                 /* height */
+    1,                  /* refer count */
+    &rtgui_hz_flash_font_engine,/* font engine */
+    (void *) &hz16,     /* font private data */
+};
 #else
 struct rtgui_hz_file_font hz16 =
 {
-    {RT_NULL},              /* cache root       */
+    {RT_NULL},              /* cache hash       */
+    {RT_NULL, RT_NULL},     /* cache lru        */
     0,                      /* cache size       */
+    RTGUI_HZ_FILE_CACHE_MAX,/* cache max        */
     16,                     /* font size        */
     32,                     /* font data size   */
     -1,                     /* fd               */
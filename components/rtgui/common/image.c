@@ -21,6 +21,10 @@
 #include <rtgui/image_container.h>
 
 #include <string.h>
+#include <math.h>
+#ifndef M_PI
+#define M_PI    3.14159265358979323846
+#endif
 #ifdef _WIN32
 #define strncasecmp  strnicmp
 #endif
@@ -64,8 +68,8 @@ void rtgui_system_image_init(void)
 #endif
 
 #ifdef RTGUI_IMAGE_CONTAINER
-    /* initialize image container */
-    rtgui_system_image_container_init(RT_FALSE);
+    /* initialize image container, which caches the decoded images */
+    rtgui_system_image_container_init(RT_TRUE);
 #endif
 }
 
@@ -263,10 +267,15 @@ struct rtgui_image *rtgui_image_create_from_mem(const char *type, const rt_uint8
 }
 RTM_EXPORT(rtgui_image_create_from_mem);
 
+static void _image_native_drop(struct rtgui_image *image);
+
 void rtgui_image_destroy(struct rtgui_image *image)
 {
     RT_ASSERT(image != RT_NULL);
 
+    /* the native copy of image for scaler is not valid any more */
+    _image_native_drop(image);
+
     image->engine->image_unload(image);
     if (image->palette != RT_NULL)
         rtgui_free(image->palette);
@@ -325,22 +334,617 @@ void rtgui_image_get_rect(struct rtgui_image *image, struct rtgui_rect *rect)
 }
 RTM_EXPORT(rtgui_image_get_rect);
 
+/*
+ * The generic scaler works on the pixels of RGB565 or BGR565 graphic driver.
+ * The source image is converted into the pixel format of graphic driver once,
+ * unless it's a loaded hdc image already, and the position of source is
+ * calculated in 16.16 fixed point. The three fields of 565 pixel are weighted
+ * together by the spread of pixel, so it does not matter which one is red.
+ */
+#define IMAGE_FIX_SHIFT         16
+#define IMAGE_FIX_ONE           (1 << IMAGE_FIX_SHIFT)
+/* the weight of bilinear interpolation, 0 to 32 */
+#define IMAGE_WEIGHT_SHIFT      5
+#define IMAGE_WEIGHT_ONE        (1 << IMAGE_WEIGHT_SHIFT)
+
+/* spread 565 pixel as 00000GGGGGG00000RRRRR000000BBBBB, so that each field has
+ * room for the multiply of weight */
+#define IMAGE_565_SPREAD(p)     ((((rt_uint32_t)(p) << 16) | (p)) & 0x07E0F81F)
+#define IMAGE_565_PACK(c)       ((rt_uint16_t)(((c) & 0xF81F) | (((c) >> 16) & 0x07E0)))
+#define IMAGE_565_BLEND(a, b, w) \
+    ((((a) * (IMAGE_WEIGHT_ONE - (w)) + (b) * (w) + 0x02008010) >> IMAGE_WEIGHT_SHIFT) & 0x07E0F81F)
+
+struct image_scaler
+{
+    /* source pixels in the pixel format of graphic driver */
+    const rt_uint8_t *src;
+    rt_uint16_t src_pitch;
+    rt_uint16_t sw, sh, dw, dh;
+    rt_uint32_t mode;
+
+    /* the source columns and weights of each destination column, which is the
+     * range of columns in box mode */
+    rt_uint16_t *x0, *x1;
+    rt_uint8_t *xw;
+
+    /* the horizontally scaled rows of bilinear mode, cached by source row */
+    rt_uint32_t *rows[2];
+    int row_y[2];
+
+    /* the sums of fields in box mode */
+    rt_uint32_t *sum;
+
+    /* one destination line */
+    rt_uint16_t *line;
+
+    /* the memory of all the buffers above */
+    rt_uint8_t *buffer;
+};
+
+struct image_scale_out
+{
+    /* write lines into pixels, or draw them on dc */
+    rt_uint8_t *pixels;
+    rt_uint16_t pitch;
+
+    struct rtgui_dc *dc;
+    int x, y, w;
+    rtgui_color_t *colors;
+    rt_uint8_t pixel_format;
+};
+
+static rt_bool_t _image_scale_supported(void)
+{
+    struct rtgui_graphic_driver *hw_driver = rtgui_graphic_driver_get_default();
+
+    return hw_driver != RT_NULL &&
+           (hw_driver->pixel_format == RTGRAPHIC_PIXEL_FORMAT_RGB565 ||
+            hw_driver->pixel_format == RTGRAPHIC_PIXEL_FORMAT_RGB565P);
+}
+
+/*
+ * The native copy of the last image scaled, which is not an hdc image. Zooming
+ * or rotating the same image again, e.g. in an animation, uses the copy
+ * instead of converting the image each time. The copy is taken out of the
+ * cache while it's used, and dropped when its image is destroyed.
+ */
+static struct rtgui_image *_native_cache_source = RT_NULL;
+static rtgui_color_t _native_cache_background;
+static struct rtgui_image *_native_cache = RT_NULL;
+
+static void _image_native_drop(struct rtgui_image *image)
+{
+    struct rtgui_image *native = RT_NULL;
+
+    rt_enter_critical();
+    if (_native_cache_source == image)
+    {
+        native = _native_cache;
+        _native_cache = RT_NULL;
+        _native_cache_source = RT_NULL;
+    }
+    rt_exit_critical();
+
+    if (native != RT_NULL) rtgui_image_destroy(native);
+}
+
+/*
+ * get the pixels of image in the pixel format of graphic driver. The returned
+ * image is the native copy, which should be put back by _image_native_put
+ * after using pixels. The image is drawn on background for the copy, so the
+ * alpha of image is flattened: the scaled image has no transparent pixel.
+ */
+static struct rtgui_image *_image_native_source(struct rtgui_image *image, rtgui_color_t background,
+        const rt_uint8_t **pixels, rt_uint16_t *pitch)
+{
+    struct rtgui_image *native = RT_NULL;
+
+    *pixels = rtgui_image_hdc_get_pixels(image, pitch);
+    if (*pixels != RT_NULL) return RT_NULL;
+
+    rt_enter_critical();
+    if (_native_cache_source == image && _native_cache_background == background)
+    {
+        native = _native_cache;
+        _native_cache = RT_NULL;
+        _native_cache_source = RT_NULL;
+    }
+    rt_exit_critical();
+
+    if (native == RT_NULL)
+        native = rtgui_image_hdc_convert(image, background);
+    if (native != RT_NULL)
+        *pixels = rtgui_image_hdc_get_pixels(native, pitch);
+
+    return native;
+}
+
+/* keep the native copy of image in cache, instead of the copy of last image */
+static void _image_native_put(struct rtgui_image *image, rtgui_color_t background,
+                              struct rtgui_image *native)
+{
+    struct rtgui_image *old;
+
+    if (native == RT_NULL) return;
+
+    rt_enter_critical();
+    old = _native_cache;
+    _native_cache = native;
+    _native_cache_source = image;
+    _native_cache_background = background;
+    rt_exit_critical();
+
+    if (old != RT_NULL) rtgui_image_destroy(old);
+}
+
+/*
+ * The position of destination pixel d in source, with the weight of next pixel.
+ * The destination has n pixels and the source has size pixels.
+ */
+static void _image_scale_pos(const struct image_scaler *scaler, int d, int n, int size,
+                             rt_uint16_t *p0, rt_uint16_t *p1, rt_uint8_t *weight)
+{
+    rt_int32_t pos;
+    rt_uint32_t step = ((rt_uint32_t)size << IMAGE_FIX_SHIFT) / n;
+
+    switch (scaler->mode)
+    {
+    case RTGUI_IMG_ZOOM_BOX:
+        /* the covered range, at least one pixel */
+        *p0 = d * size / n;
+        *p1 = (d + 1) * size / n;
+        if (*p1 <= *p0) *p1 = *p0 + 1;
+        *weight = 0;
+        break;
+
+    case RTGUI_IMG_ZOOM_BILINEAR:
+        /* the center of destination pixel mapped on source */
+        pos = (rt_int32_t)(d * step + (step >> 1)) - (IMAGE_FIX_ONE >> 1);
+        if (pos < 0) pos = 0;
+        *p0 = pos >> IMAGE_FIX_SHIFT;
+        *weight = ((pos & (IMAGE_FIX_ONE - 1)) + (1 << (IMAGE_FIX_SHIFT - IMAGE_WEIGHT_SHIFT - 1)))
+                  >> (IMAGE_FIX_SHIFT - IMAGE_WEIGHT_SHIFT);
+        if (*p0 >= size - 1)
+        {
+            *p0 = size - 1;
+            *weight = 0;
+        }
+        *p1 = (*p0 < size - 1) ? *p0 + 1 : *p0;
+        break;
+
+    default:
+        *p0 = (d * step + (step >> 1)) >> IMAGE_FIX_SHIFT;
+        if (*p0 >= size) *p0 = size - 1;
+        *p1 = *p0;
+        *weight = 0;
+        break;
+    }
+}
+
+static void _image_scaler_fini(struct image_scaler *scaler)
+{
+    if (scaler->buffer != RT_NULL)
+    {
+        rtgui_free(scaler->buffer);
+        scaler->buffer = RT_NULL;
+    }
+}
+
+static rt_bool_t _image_scaler_init(struct image_scaler *scaler, const rt_uint8_t *src, rt_uint16_t pitch,
+                                    int sw, int sh, int dw, int dh, rt_uint32_t mode)
+{
+    int x;
+    rt_size_t size;
+    rt_uint8_t *ptr;
+
+    if (sw <= 0 || sh <= 0 || dw <= 0 || dh <= 0) return RT_FALSE;
+
+    scaler->src = src;
+    scaler->src_pitch = pitch;
+    scaler->sw = sw;
+    scaler->sh = sh;
+    scaler->dw = dw;
+    scaler->dh = dh;
+    scaler->mode = mode;
+    scaler->row_y[0] = scaler->row_y[1] = -1;
+
+    /* the words first, then half words and bytes */
+    size = dw * (sizeof(rt_uint16_t) * 3 + sizeof(rt_uint8_t));
+    if (mode == RTGUI_IMG_ZOOM_BILINEAR)
+        size += dw * sizeof(rt_uint32_t) * 2;
+    else if (mode == RTGUI_IMG_ZOOM_BOX)
+        size += dw * sizeof(rt_uint32_t) * 3;
+
+    ptr = (rt_uint8_t *) rtgui_malloc(size);
+    if (ptr == RT_NULL) return RT_FALSE;
+    scaler->buffer = ptr;
+
+    if (mode == RTGUI_IMG_ZOOM_BILINEAR)
+    {
+        scaler->line = (rt_uint16_t *)(ptr + dw * sizeof(rt_uint32_t) * 2);
+        scaler->rows[0] = (rt_uint32_t *)ptr;
+        scaler->rows[1] = scaler->rows[0] + dw;
+        scaler->sum = RT_NULL;
+    }
+    else if (mode == RTGUI_IMG_ZOOM_BOX)
+    {
+        scaler->line = (rt_uint16_t *)(ptr + dw * sizeof(rt_uint32_t) * 3);
+        scaler->rows[0] = scaler->rows[1] = RT_NULL;
+        scaler->sum = (rt_uint32_t *)ptr;
+    }
+    else
+    {
+        scaler->line = (rt_uint16_t *)ptr;
+        scaler->rows[0] = scaler->rows[1] = RT_NULL;
+        scaler->sum = RT_NULL;
+    }
+    scaler->x0 = scaler->line + dw;
+    scaler->x1 = scaler->x0 + dw;
+    scaler->xw = (rt_uint8_t *)(scaler->x1 + dw);
+
+    for (x = 0; x < dw; x ++)
+        _image_scale_pos(scaler, x, dw, sw, &scaler->x0[x], &scaler->x1[x], &scaler->xw[x]);
+
+    return RT_TRUE;
+}
+
+/* scale a source row horizontally, in the spread pixels */
+static void _image_scale_hrow(struct image_scaler *scaler, int sy, rt_uint32_t *row)
+{
+    int x;
+    const rt_uint16_t *src = (const rt_uint16_t *)(scaler->src + sy * scaler->src_pitch);
+
+    for (x = 0; x < scaler->dw; x ++)
+    {
+        rt_uint32_t a = IMAGE_565_SPREAD(src[scaler->x0[x]]);
+        rt_uint32_t b = IMAGE_565_SPREAD(src[scaler->x1[x]]);
+
+        row[x] = IMAGE_565_BLEND(a, b, scaler->xw[x]);
+    }
+}
+
+/* get the scaled row of sy, the cached row of keep is not replaced */
+static rt_uint32_t *_image_scale_row(struct image_scaler *scaler, int sy, int keep)
+{
+    int index;
+
+    if (scaler->row_y[0] == sy) return scaler->rows[0];
+    if (scaler->row_y[1] == sy) return scaler->rows[1];
+
+    index = (scaler->row_y[0] == keep) ? 1 : 0;
+    _image_scale_hrow(scaler, sy, scaler->rows[index]);
+    scaler->row_y[index] = sy;
+
+    return scaler->rows[index];
+}
+
+static void _image_scale_box(struct image_scaler *scaler, int sy0, int sy1)
+{
+    int x, sx, sy;
+    rt_uint32_t *sum = scaler->sum;
+
+    rt_memset(sum, 0, scaler->dw * sizeof(rt_uint32_t) * 3);
+    for (sy = sy0; sy < sy1; sy ++)
+    {
+        const rt_uint16_t *src = (const rt_uint16_t *)(scaler->src + sy * scaler->src_pitch);
+
+        for (x = 0; x < scaler->dw; x ++)
+        {
+            for (sx = scaler->x0[x]; sx < scaler->x1[x]; sx ++)
+            {
+                sum[x * 3]     += src[sx] >> 11;
+                sum[x * 3 + 1] += (src[sx] >> 5) & 0x3F;
+                sum[x * 3 + 2] += src[sx] & 0x1F;
+            }
+        }
+    }
+
+    for (x = 0; x < scaler->dw; x ++)
+    {
+        rt_uint32_t inv = IMAGE_FIX_ONE / ((scaler->x1[x] - scaler->x0[x]) * (sy1 - sy0));
+
+        scaler->line[x] = (rt_uint16_t)
+                          ((((sum[x * 3]     * inv + (IMAGE_FIX_ONE >> 1)) >> IMAGE_FIX_SHIFT) << 11) |
+                           (((sum[x * 3 + 1] * inv + (IMAGE_FIX_ONE >> 1)) >> IMAGE_FIX_SHIFT) << 5) |
+                           ((sum[x * 3 + 2]  * inv + (IMAGE_FIX_ONE >> 1)) >> IMAGE_FIX_SHIFT));
+    }
+}
+
+static void _image_scale_put(struct image_scale_out *out, int y, rt_uint16_t *line)
+{
+    int x;
+
+    if (out->pixels != RT_NULL)
+    {
+        rt_memcpy(out->pixels + y * out->pitch, line, out->w * sizeof(rt_uint16_t));
+    }
+    else if (out->colors != RT_NULL)
+    {
+        /* the buffer dc takes the lines of color */
+        for (x = 0; x < out->w; x ++)
+        {
+            out->colors[x] = (out->pixel_format == RTGRAPHIC_PIXEL_FORMAT_RGB565) ?
+                             rtgui_color_from_565(line[x]) : rtgui_color_from_565p(line[x]);
+        }
+        out->dc->engine->blit_line(out->dc, out->x, out->x + out->w, out->y + y, (rt_uint8_t *)out->colors);
+    }
+    else
+    {
+        out->dc->engine->blit_line(out->dc, out->x, out->x + out->w, out->y + y, (rt_uint8_t *)line);
+    }
+}
+
+static void _image_scale_run(struct image_scaler *scaler, struct image_scale_out *out)
+{
+    int x, y, last_y = -1;
+    rt_uint16_t y0, y1;
+    rt_uint8_t weight;
+
+    for (y = 0; y < scaler->dh; y ++)
+    {
+        _image_scale_pos(scaler, y, scaler->dh, scaler->sh, &y0, &y1, &weight);
+
+        if (scaler->mode == RTGUI_IMG_ZOOM_BILINEAR)
+        {
+            rt_uint32_t *r0 = _image_scale_row(scaler, y0, y1);
+            rt_uint32_t *r1 = _image_scale_row(scaler, y1, y0);
+
+            for (x = 0; x < scaler->dw; x ++)
+                scaler->line[x] = IMAGE_565_PACK(IMAGE_565_BLEND(r0[x], r1[x], weight));
+        }
+        else if (scaler->mode == RTGUI_IMG_ZOOM_BOX)
+        {
+            _image_scale_box(scaler, y0, y1);
+        }
+        else if (y0 != last_y)
+        {
+            /* the line of last row is reused when zoom in */
+            const rt_uint16_t *src = (const rt_uint16_t *)(scaler->src + y0 * scaler->src_pitch);
+
+            for (x = 0; x < scaler->dw; x ++)
+                scaler->line[x] = src[scaler->x0[x]];
+            last_y = y0;
+        }
+
+        _image_scale_put(out, y, scaler->line);
+    }
+}
+
+static struct rtgui_image *_image_zoom(struct rtgui_image *image, int w, int h, rt_uint32_t mode)
+{
+    rt_uint16_t pitch;
+    const rt_uint8_t *pixels;
+    struct rtgui_image *native, *zoomed = RT_NULL;
+    struct image_scaler scaler;
+    struct image_scale_out out;
+
+    if (_image_scale_supported() != RT_TRUE) return RT_NULL;
+
+    /* there is no dc, the transparent pixels are white */
+    native = _image_native_source(image, white, &pixels, &pitch);
+    if (pixels == RT_NULL) return RT_NULL;
+
+    if (_image_scaler_init(&scaler, pixels, pitch, image->w, image->h, w, h, mode) == RT_TRUE)
+    {
+        zoomed = rtgui_image_hdc_alloc(w, h);
+        if (zoomed != RT_NULL)
+        {
+            out.pixels = rtgui_image_hdc_get_pixels(zoomed, &out.pitch);
+            out.w = w;
+            _image_scale_run(&scaler, &out);
+        }
+        _image_scaler_fini(&scaler);
+    }
+
+    _image_native_put(image, white, native);
+    return zoomed;
+}
+
 rtgui_image_t *rtgui_image_zoom(rtgui_image_t *image, float scalew, float scaleh, rt_uint32_t mode)
 {
-    if (image != RT_NULL && image->engine != RT_NULL)
+    rtgui_image_t *zoomed;
+
+    if (image == RT_NULL || image->engine == RT_NULL) return RT_NULL;
+    if (scalew <= 0 || scaleh <= 0) return RT_NULL;
+
+    zoomed = _image_zoom(image, (int)(image->w / scalew), (int)(image->h / scaleh), mode);
+    if (zoomed == RT_NULL && image->engine->image_zoom != RT_NULL)
     {
-        return image->engine->image_zoom(image, scalew, scaleh, mode);
+        /* the engine zooms the image in its own format */
+        zoomed = image->engine->image_zoom(image, scalew, scaleh, mode);
     }
-    return RT_NULL;
+
+    return zoomed;
 }
 RTM_EXPORT(rtgui_image_zoom);
 
-rtgui_image_t *rtgui_image_rotate(rtgui_image_t *image, float angle)
+void rtgui_image_zoom_blit(rtgui_image_t *image, struct rtgui_dc *dc, struct rtgui_rect *rect, rt_uint32_t mode)
 {
-    if (image != RT_NULL && image->engine != RT_NULL)
+    rt_uint16_t pitch;
+    const rt_uint8_t *pixels;
+    struct rtgui_image *native;
+    struct image_scaler scaler;
+    struct image_scale_out out;
+    struct rtgui_graphic_driver *hw_driver;
+    rtgui_color_t background;
+
+    RT_ASSERT(image != RT_NULL);
+    RT_ASSERT(dc    != RT_NULL);
+    RT_ASSERT(rect  != RT_NULL);
+
+    if (rtgui_dc_get_visible(dc) != RT_TRUE) return;
+    if (_image_scale_supported() != RT_TRUE) return;
+    hw_driver = rtgui_graphic_driver_get_default();
+
+    /* the transparent pixels of image show the background of dc */
+    background = RTGUI_DC_BC(dc);
+    native = _image_native_source(image, background, &pixels, &pitch);
+    if (pixels == RT_NULL) return;
+
+    if (_image_scaler_init(&scaler, pixels, pitch, image->w, image->h,
+                           rtgui_rect_width(*rect), rtgui_rect_height(*rect), mode) == RT_TRUE)
     {
-        return image->engine->image_rotate(image, angle);
+        out.pixels = RT_NULL;
+        out.dc = dc;
+        out.x = rect->x1;
+        out.y = rect->y1;
+        out.w = scaler.dw;
+        out.colors = RT_NULL;
+        out.pixel_format = hw_driver->pixel_format;
+        if (dc->type == RTGUI_DC_BUFFER)
+            out.colors = (rtgui_color_t *) rtgui_malloc(out.w * sizeof(rtgui_color_t));
+
+        if (dc->type != RTGUI_DC_BUFFER || out.colors != RT_NULL)
+            _image_scale_run(&scaler, &out);
+
+        if (out.colors != RT_NULL) rtgui_free(out.colors);
+        _image_scaler_fini(&scaler);
     }
-    return RT_NULL;
+
+    _image_native_put(image, background, native);
+}
+RTM_EXPORT(rtgui_image_zoom_blit);
+
+/* rotate clockwise around the center, the uncovered pixels are white */
+static struct rtgui_image *_image_rotate(struct rtgui_image *image, float angle)
+{
+    int x, y, sw, sh, dw, dh;
+    float radian, sina, cosa;
+    rt_int32_t sin_fix, cos_fix, sx, sy;
+    rt_uint16_t pitch, dst_pitch;
+    const rt_uint8_t *pixels;
+    rt_uint8_t *dst;
+    struct rtgui_image *native, *rotated;
+
+    if (_image_scale_supported() != RT_TRUE) return RT_NULL;
+
+    /* there is no dc, the transparent pixels are white */
+    native = _image_native_source(image, white, &pixels, &pitch);
+    if (pixels == RT_NULL) return RT_NULL;
+
+    radian = angle * (float)M_PI / (float)180.0;
+    sina = sin(radian);
+    cosa = cos(radian);
+    sin_fix = (rt_int32_t)(sina * IMAGE_FIX_ONE);
+    cos_fix = (rt_int32_t)(cosa * IMAGE_FIX_ONE);
+
+    sw = image->w;
+    sh = image->h;
+    dw = (int)(sw * fabs(cosa) + sh * fabs(sina));
+    dh = (int)(sh * fabs(cosa) + sw * fabs(sina));
+
+    rotated = rtgui_image_hdc_alloc(dw, dh);
+    if (rotated != RT_NULL)
+    {
+        dst = rtgui_image_hdc_get_pixels(rotated, &dst_pitch);
+        for (y = 0; y < dh; y ++)
+        {
+            rt_uint16_t *line = (rt_uint16_t *)(dst + y * dst_pitch);
+
+            /* the source position of the first pixel in this line, which
+             * moves by (cos, -sin) for each pixel */
+            sx = (sw << (IMAGE_FIX_SHIFT - 1)) - (dw >> 1) * cos_fix + (y - (dh >> 1)) * sin_fix;
+            sy = (sh << (IMAGE_FIX_SHIFT - 1)) + (y - (dh >> 1)) * cos_fix + (dw >> 1) * sin_fix;
+            for (x = 0; x < dw; x ++)
+            {
+                rt_int32_t px = sx >> IMAGE_FIX_SHIFT, py = sy >> IMAGE_FIX_SHIFT;
+
+                if ((rt_uint32_t)px < (rt_uint32_t)sw && (rt_uint32_t)py < (rt_uint32_t)sh)
+                    line[x] = ((const rt_uint16_t *)(pixels + py * pitch))[px];
+                else
+                    line[x] = 0xFFFF;
+
+                sx += cos_fix;
+                sy -= sin_fix;
+            }
+        }
+    }
+
+    _image_native_put(image, white, native);
+    return rotated;
+}
+
+rtgui_image_t *rtgui_image_rotate(rtgui_image_t *image, float angle)
+{
+    rtgui_image_t *rotated;
+
+    if (image == RT_NULL || image->engine == RT_NULL) return RT_NULL;
+
+    rotated = _image_rotate(image, angle);
+    if (rotated == RT_NULL && image->engine->image_rotate != RT_NULL)
+        rotated = image->engine->image_rotate(image, angle);
+
+    return rotated;
 }
 RTM_EXPORT(rtgui_image_rotate);
+
+#if defined(RT_USING_FINSH) && defined(RTGUI_USING_DFS_FILERW)
+#include <finsh.h>
+
+static rt_tick_t _image_zoom_bench_one(struct rtgui_image *image, int w, int h,
+                                       rt_uint32_t mode, int loops, rt_bool_t generic)
+{
+    int i;
+    rt_tick_t tick;
+    struct rtgui_image *zoomed;
+
+    tick = rt_tick_get();
+    for (i = 0; i < loops; i ++)
+    {
+        if (generic == RT_TRUE)
+            zoomed = _image_zoom(image, w, h, mode);
+        else
+            zoomed = image->engine->image_zoom(image, (float)image->w / w, (float)image->h / h, mode);
+        if (zoomed == RT_NULL) return 0;
+        rtgui_image_destroy(zoomed);
+    }
+
+    return rt_tick_get() - tick;
+}
+
+/* compare the fixed point scaler with the float zoom of image engine */
+void image_zoom_bench(const char *filename, int w, int h, int loops)
+{
+    rt_uint32_t mode;
+    rt_tick_t tick;
+    struct rtgui_image *image, *native;
+    static const char *mode_name[] = {"nearest", "bilinear", "box"};
+
+    if (w <= 0 || h <= 0) return;
+    if (loops <= 0) loops = 10;
+
+    image = rtgui_image_create(filename, RT_TRUE);
+    if (image == RT_NULL)
+    {
+        rt_kprintf("open %s failed\n", filename);
+        return;
+    }
+
+    /* the scaler converts the source once and keeps the copy, which is measured alone */
+    tick = rt_tick_get();
+    native = rtgui_image_hdc_convert(image, white);
+    tick = rt_tick_get() - tick;
+    if (native == RT_NULL)
+    {
+        rt_kprintf("the pixel format is not supported\n");
+        rtgui_image_destroy(image);
+        return;
+    }
+
+    rt_kprintf("%dx%d -> %dx%d, %d loops, convert %d ticks\n", image->w, image->h, w, h, loops, tick);
+    rt_kprintf("mode        engine(float)  scaler(fixed)\n");
+    for (mode = RTGUI_IMG_ZOOM_NEAREST; mode <= RTGUI_IMG_ZOOM_BOX; mode ++)
+    {
+        rt_kprintf("%-10s  ", mode_name[mode]);
+        if (mode != RTGUI_IMG_ZOOM_BOX && image->engine->image_zoom != RT_NULL)
+            rt_kprintf("%13d  ", _image_zoom_bench_one(image, w, h, mode, loops, RT_FALSE));
+        else
+            rt_kprintf("%13s  ", "-");
+        rt_kprintf("%13d\n", _image_zoom_bench_one(native, w, h, mode, loops, RT_TRUE));
+    }
+
+    rtgui_image_destroy(native);
+    rtgui_image_destroy(image);
+}
+FINSH_FUNCTION_EXPORT(image_zoom_bench, compare image zoom: image_zoom_bench(filename, w, h, loops));
+#endif
@@ -27,6 +27,7 @@
 
 #define BMP_WORKING_BUFFER_SIZE (384)   /* In multiple of 12 and bigger than 48 */
 #define BMP_MAX_SCALING_FACTOR  (10)    // TODO: find the max value!
+#define BMP_SECTOR_SIZE         (512)
 #define hw_driver               (rtgui_graphic_driver_get_default())
 
 struct rtgui_image_bmp
@@ -501,6 +502,267 @@ static void rtgui_image_bmp_unload(struct rtgui_image *image)
     }
 }
 
+/*
+ * Streaming blit of unloaded image
+ *
+ * The rows of the rect are contiguous in file (bottom-up), so they are read
+ * in chunks of RTGUI_IMAGE_BMP_STREAM_SIZE bytes from a sector boundary and
+ * drawn from the bottom row. A row which spans two chunks is gathered in a
+ * row buffer, the others are converted directly from the chunk. With
+ * RTGUI_IMAGE_BMP_READ_AHEAD, a reader thread fills the other chunk while
+ * the current one is drawn.
+ */
+struct bmp_stream
+{
+    struct rtgui_filerw *filerw;
+    rt_uint32_t offset;         /* file offset of the next chunk */
+    rt_uint32_t end;            /* file offset of the end of rows */
+
+    rt_uint8_t *chunk[2];
+    rt_int32_t length[2];       /* the bytes in chunk, -1 on error */
+
+    rt_thread_t thread;
+    rt_bool_t stop;
+    struct rt_semaphore empty, full, done;
+};
+
+static rt_int32_t _bmp_stream_read(struct bmp_stream *stream, rt_uint8_t *chunk)
+{
+    rt_uint32_t length;
+
+    if (stream->offset >= stream->end) return 0;
+
+    length = stream->end - stream->offset;
+    if (length > RTGUI_IMAGE_BMP_STREAM_SIZE) length = RTGUI_IMAGE_BMP_STREAM_SIZE;
+    if (rtgui_filerw_read(stream->filerw, chunk, 1, length) != length)
+        return -1;
+
+    stream->offset += length;
+    return length;
+}
+
+#ifdef RTGUI_IMAGE_BMP_READ_AHEAD
+static void _bmp_stream_entry(void *parameter)
+{
+    int index = 0;
+    struct bmp_stream *stream = (struct bmp_stream *)parameter;
+
+    while (1)
+    {
+        rt_sem_take(&(stream->empty), RT_WAITING_FOREVER);
+        if (stream->stop) break;
+
+        stream->length[index] = _bmp_stream_read(stream, stream->chunk[index]);
+        rt_sem_release(&(stream->full));
+        if (stream->length[index] <= 0) break;
+
+        index ^= 1;
+    }
+
+    rt_sem_release(&(stream->done));
+}
+#endif
+
+static rt_bool_t _bmp_stream_open(struct bmp_stream *stream, struct rtgui_filerw *filerw,
+                                  rt_uint32_t offset, rt_uint32_t end)
+{
+    stream->filerw = filerw;
+    stream->offset = offset;
+    stream->end = end;
+    stream->thread = RT_NULL;
+    stream->stop = RT_FALSE;
+
+    stream->chunk[1] = RT_NULL;
+    stream->chunk[0] = (rt_uint8_t *)rtgui_malloc(RTGUI_IMAGE_BMP_STREAM_SIZE);
+    if (stream->chunk[0] == RT_NULL) return RT_FALSE;
+
+    if (rtgui_filerw_seek(filerw, offset, RTGUI_FILE_SEEK_SET) < 0)
+    {
+        rtgui_free(stream->chunk[0]);
+        return RT_FALSE;
+    }
+
+#ifdef RTGUI_IMAGE_BMP_READ_AHEAD
+    /* read ahead only when there are more than one chunk */
+    if (end - offset > RTGUI_IMAGE_BMP_STREAM_SIZE)
+        stream->chunk[1] = (rt_uint8_t *)rtgui_malloc(RTGUI_IMAGE_BMP_STREAM_SIZE);
+    if (stream->chunk[1] != RT_NULL)
+    {
+        rt_uint8_t priority = rt_thread_self()->current_priority;
+
+        /* the reader starts the next read as soon as a chunk is free */
+        stream->thread = rt_thread_create("bmprd", _bmp_stream_entry, stream, 2048,
+                                          priority > 0 ? priority - 1 : 0, 5);
+        if (stream->thread != RT_NULL)
+        {
+            rt_sem_init(&(stream->empty), "bmpe", 2, RT_IPC_FLAG_FIFO);
+            rt_sem_init(&(stream->full), "bmpf", 0, RT_IPC_FLAG_FIFO);
+            rt_sem_init(&(stream->done), "bmpd", 0, RT_IPC_FLAG_FIFO);
+            rt_thread_startup(stream->thread);
+        }
+        else
+        {
+            rtgui_free(stream->chunk[1]);
+            stream->chunk[1] = RT_NULL;
+        }
+    }
+#endif
+
+    return RT_TRUE;
+}
+
+/* get the next chunk, index is 0 and 1 alternately */
+static rt_int32_t _bmp_stream_next(struct bmp_stream *stream, int index)
+{
+    if (stream->thread != RT_NULL)
+    {
+        rt_sem_take(&(stream->full), RT_WAITING_FOREVER);
+        return stream->length[index];
+    }
+
+    return _bmp_stream_read(stream, stream->chunk[0]);
+}
+
+/* the chunk got by _bmp_stream_next is drawn */
+static void _bmp_stream_release(struct bmp_stream *stream)
+{
+    if (stream->thread != RT_NULL)
+        rt_sem_release(&(stream->empty));
+}
+
+static void _bmp_stream_close(struct bmp_stream *stream)
+{
+    if (stream->thread != RT_NULL)
+    {
+        /* wake up and wait for the reader */
+        stream->stop = RT_TRUE;
+        rt_sem_release(&(stream->empty));
+        rt_sem_take(&(stream->done), RT_WAITING_FOREVER);
+
+        rt_sem_detach(&(stream->empty));
+        rt_sem_detach(&(stream->full));
+        rt_sem_detach(&(stream->done));
+        rtgui_free(stream->chunk[1]);
+    }
+
+    rtgui_free(stream->chunk[0]);
+}
+
+/* blit the w x h rect of a scale 1:1 image with 16, 24 or 32 bits per pixel */
+static rt_bool_t _bmp_blit_stream(struct rtgui_image *image, struct rtgui_dc *dc,
+                                  struct rtgui_rect *dst_rect, rt_uint16_t w, rt_uint16_t h)
+{
+    struct rtgui_image_bmp *bmp = (struct rtgui_image_bmp *)image->data;
+    struct bmp_stream stream;
+    rtgui_blit_line_func blit_line;
+    rt_uint8_t bytePerPixel, hw_bytePerPixel;
+    rt_uint32_t stride, start, row_pos, n;
+    rt_int32_t length, pos;
+    rt_uint8_t *row, *line, *chunk, *pixels;
+    rt_uint16_t rows;
+    int index, y;
+
+    bytePerPixel = bmp->bit_per_pixel / 8;
+    hw_bytePerPixel = hw_driver->bits_per_pixel / 8;
+    if (!hw_bytePerPixel)
+    {
+        hw_bytePerPixel = 1;
+    }
+
+    if (hw_driver->pixel_format == RTGRAPHIC_PIXEL_FORMAT_RGB565)
+    {
+        blit_line = rtgui_blit_line_get_inv(hw_bytePerPixel, bytePerPixel);
+    }
+    else
+    {
+        blit_line = rtgui_blit_line_get(hw_bytePerPixel, bytePerPixel);
+    }
+
+    row = (rt_uint8_t *)rtgui_malloc(bmp->pitch);
+    line = (rt_uint8_t *)rtgui_malloc(w * hw_bytePerPixel);
+    if (row == RT_NULL || line == RT_NULL)
+    {
+        goto __error;
+    }
+
+    /* the rows of rect are the last h rows in file, read from the sector
+     * boundary before them */
+    stride = bmp->pitch + bmp->pad;
+    start = bmp->pixel_offset + (image->h - h) * stride;
+    if (_bmp_stream_open(&stream, bmp->filerw, start & ~(BMP_SECTOR_SIZE - 1),
+                         start + (h - 1) * stride + bmp->pitch) != RT_TRUE)
+    {
+        goto __error;
+    }
+
+    pos = start & (BMP_SECTOR_SIZE - 1);
+    row_pos = 0;
+    rows = 0;
+    y = dst_rect->y1 + h - 1;
+    for (index = 0; rows < h; index ^= 1)
+    {
+        length = _bmp_stream_next(&stream, index);
+        if (length <= 0)
+        {
+            rt_kprintf("BMP err: read failed\n");
+            break;
+        }
+        chunk = stream.chunk[stream.thread != RT_NULL ? index : 0];
+
+        while (pos < length && rows < h)
+        {
+            if (row_pos < bmp->pitch)
+            {
+                n = bmp->pitch - row_pos;
+                if (n > (rt_uint32_t)(length - pos)) n = length - pos;
+
+                if (row_pos == 0 && n == bmp->pitch)
+                {
+                    /* the whole row is in chunk */
+                    pixels = chunk + pos;
+                }
+                else
+                {
+                    rt_memcpy(row + row_pos, chunk + pos, n);
+                    pixels = row;
+                }
+                pos += n;
+                row_pos += n;
+
+                if (row_pos == bmp->pitch)
+                {
+                    blit_line(line, pixels, w * bytePerPixel);
+                    dc->engine->blit_line(dc, dst_rect->x1, dst_rect->x1 + w, y--, line);
+                    rows ++;
+                }
+            }
+            else
+            {
+                /* skip padding bytes */
+                n = stride - row_pos;
+                if (n > (rt_uint32_t)(length - pos)) n = length - pos;
+                pos += n;
+                row_pos += n;
+            }
+
+            if (row_pos == stride) row_pos = 0;
+        }
+
+        pos = 0;
+        _bmp_stream_release(&stream);
+    }
+
+    _bmp_stream_close(&stream);
+    rtgui_free(line);
+    rtgui_free(row);
+    return RT_TRUE;
+
+__error:
+    if (line != RT_NULL) rtgui_free(line);
+    if (row != RT_NULL) rtgui_free(row);
+    return RT_FALSE;
+}
+
 static void rtgui_image_bmp_blit(struct rtgui_image *image, struct rtgui_dc *dc, struct rtgui_rect *dst_rect)
 {
     rt_uint16_t w, h;
@@ -546,6 +808,15 @@ static void rtgui_image_bmp_blit(struct rtgui_image *image, struct rtgui_dc *dc,
             h = rtgui_rect_height(*dst_rect);
         }
 
+        if (!bmp->is_loaded && bmp->scale == 0 && bmp->bit_per_pixel >= 16)
+        {
+            /* fall back to the row by row reading if there is no memory */
+            if (_bmp_blit_stream(image, dc, dst_rect, w, h) == RT_TRUE)
+            {
+                break;
+            }
+        }
+
         if (!bmp->is_loaded)
         {
             rt_uint8_t *wrkBuffer;
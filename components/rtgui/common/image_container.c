@@ -1,4 +1,14 @@
+/*
+ * File      : image_container.c
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2013, RT-Thread Development Team
+ *
+ * The license and distribution terms for this file may be
+ * found in the file LICENSE in this distribution or at
+ * http://www.rt-thread.org/license/LICENSE
+ */
 #include <rtgui/image_container.h>
+#include <rtgui/rtgui_system.h>
 
 #ifdef RTGUI_IMAGE_CONTAINER
 typedef unsigned int (*rtgui_hash_func_t)(const void *key);
@@ -280,7 +290,7 @@ static void hash_table_resize(rtgui_hash_table_t *hash_table)
     hash_table->size = new_size;
 }
 
-static rtgui_hash_node_t *hash_node_create(void *key, void *value)
+static rtgui_hash_node_t *hash_node_create(const void *key, void *value)
 {
     rtgui_hash_node_t *hash_node;
 
@@ -288,7 +298,7 @@ static rtgui_hash_node_t *hash_node_create(void *key, void *value)
     if (hash_node != RT_NULL)
     {
         /* set value and key */
-        hash_node->key = key;
+        hash_node->key = (void *)key;
         hash_node->value = value;;
 
         hash_node->next = RT_NULL;
@@ -353,95 +363,276 @@ rt_bool_t string_equal_func(const void *a, const void *b)
     return RT_FALSE;
 }
 
+static struct rt_mutex _container_lock;
 static rtgui_hash_table_t *image_hash_table;
 static rt_bool_t load_image = RT_FALSE;
+/* the idle images (refcount is zero), the most recently used one is at the head */
+static struct rtgui_dlist_node _image_lru;
+static struct rtgui_image_container_stat _container_stat;
+
 void rtgui_system_image_container_init(rt_bool_t load)
 {
+    rt_mutex_init(&_container_lock, "imgc", RT_IPC_FLAG_FIFO);
+
     /* create image hash table */
     image_hash_table = hash_table_create(string_hash_func, string_equal_func);
     RT_ASSERT(image_hash_table != RT_NULL);
 
+    rtgui_dlist_init(&_image_lru);
+    rt_memset(&_container_stat, 0, sizeof(_container_stat));
+    _container_stat.max_size = RTGUI_IMAGE_CONTAINER_SIZE;
+
     /* set load type */
     load_image = load;
 }
 
-#ifdef RTGUI_USING_DFS_FILERW
-rtgui_image_item_t *rtgui_image_container_get(const char *filename)
+static rt_uint32_t _image_item_size(struct rtgui_image *image)
+{
+    /* the decoded pixels are ARGB in most of image engines */
+    if (load_image == RT_TRUE)
+        return sizeof(struct rtgui_image) + image->w * image->h * sizeof(rtgui_color_t);
+
+    return sizeof(struct rtgui_image);
+}
+
+static void _image_item_destroy(struct rtgui_image_item *item)
+{
+    /* remove item from container */
+    hash_table_remove(image_hash_table, item->filename);
+    _container_stat.used_size -= item->size;
+
+    /* destroy image and image item */
+    rt_free(item->filename);
+    rtgui_image_destroy(item->image);
+    rtgui_free(item);
+}
+
+/* release the idle images from the tail of lru list until the budget is met */
+static void _image_shrink(void)
 {
     struct rtgui_image_item *item;
 
-    item = hash_table_find(image_hash_table, filename);
-    if (item == RT_NULL)
+    while (_container_stat.used_size > _container_stat.max_size &&
+            !rtgui_dlist_isempty(&_image_lru))
     {
-        item = (struct rtgui_image_item *) rtgui_malloc(sizeof(struct rtgui_image_item));
-        if (item == RT_NULL) return RT_NULL;
+        item = rtgui_dlist_entry(_image_lru.prev, struct rtgui_image_item, lru);
+        rtgui_dlist_remove(&(item->lru));
+        _container_stat.cached_size -= item->size;
+
+        _image_item_destroy(item);
+        _container_stat.evict ++;
+    }
+}
+
+/* find an image in container and take a reference of it */
+static struct rtgui_image_item *_image_find(const char *key)
+{
+    struct rtgui_image_item *item;
 
-        /* create a image object */
-        item->image = rtgui_image_create(filename, load_image);
-        if (item->image == RT_NULL)
+    item = hash_table_find(image_hash_table, key);
+    if (item != RT_NULL)
+    {
+        if (item->refcount == 0)
         {
-            rtgui_free(item);
-            return RT_NULL; /* create image failed */
+            /* take it out of the idle images */
+            rtgui_dlist_remove(&(item->lru));
+            _container_stat.cached_size -= item->size;
         }
+        item->refcount ++;
+    }
 
-        item->refcount = 1;
-        item->filename = rt_strdup(filename);
-        hash_table_insert(image_hash_table, item->filename, item);
+    return item;
+}
+
+static struct rtgui_image_item *_image_insert(const char *key, struct rtgui_image *image)
+{
+    struct rtgui_image_item *item;
+
+    item = (struct rtgui_image_item *) rtgui_malloc(sizeof(struct rtgui_image_item));
+    if (item == RT_NULL)
+    {
+        rtgui_image_destroy(image);
+        return RT_NULL;
     }
-    else
+
+    item->filename = rt_strdup(key);
+    if (item->filename == RT_NULL)
     {
-        item->refcount ++; /* increase refcount */
+        rtgui_image_destroy(image);
+        rtgui_free(item);
+        return RT_NULL;
     }
 
+    item->image = image;
+    item->refcount = 1;
+    item->size = _image_item_size(image);
+    rtgui_dlist_init(&(item->lru));
+    hash_table_insert(image_hash_table, item->filename, item);
+    _container_stat.used_size += item->size;
+
+    /* make room for the new image by the idle ones */
+    _image_shrink();
+
     return item;
 }
+
+#ifdef RTGUI_USING_DFS_FILERW
+static struct rtgui_image_item *_image_container_get(const char *filename, rt_bool_t prefetch)
+{
+    struct rtgui_image *image;
+    struct rtgui_image_item *item;
+
+    item = _image_find(filename);
+    if (item != RT_NULL)
+    {
+        if (prefetch == RT_FALSE) _container_stat.hit ++;
+        return item;
+    }
+
+    if (prefetch == RT_FALSE) _container_stat.miss ++;
+
+    /* create a image object */
+    image = rtgui_image_create(filename, load_image);
+    if (image == RT_NULL) return RT_NULL; /* create image failed */
+
+    return _image_insert(filename, image);
+}
+
+rtgui_image_item_t *rtgui_image_container_get(const char *filename)
+{
+    struct rtgui_image_item *item;
+
+    rt_mutex_take(&_container_lock, RT_WAITING_FOREVER);
+    item = _image_container_get(filename, RT_FALSE);
+    rt_mutex_release(&_container_lock);
+
+    return item;
+}
+RTM_EXPORT(rtgui_image_container_get);
+
+/*
+ * Decode an image into container without taking a reference of it, so that
+ * the following rtgui_image_container_get hits. It's the hint of the images
+ * which will be used soon, e.g. the ones of next page, and should be called
+ * when the application is idle.
+ */
+rt_bool_t rtgui_image_container_prefetch(const char *filename)
+{
+    struct rtgui_image_item *item;
+
+    /* there is no room for idle image */
+    if (_container_stat.max_size == 0) return RT_FALSE;
+
+    rt_mutex_take(&_container_lock, RT_WAITING_FOREVER);
+    item = _image_container_get(filename, RT_TRUE);
+    if (item != RT_NULL)
+    {
+        _container_stat.prefetch ++;
+        rtgui_image_container_put(item);
+    }
+    rt_mutex_release(&_container_lock);
+
+    return item != RT_NULL;
+}
+RTM_EXPORT(rtgui_image_container_prefetch);
 #endif
 
 rtgui_image_item_t *rtgui_image_container_get_memref(const char *type, const rt_uint8_t *memory, rt_uint32_t length)
 {
     char filename[32];
+    struct rtgui_image *image;
     struct rtgui_image_item *item;
 
     /* create filename for image identification */
     rt_snprintf(filename, sizeof(filename), "0x%08x_%s", memory, type);
 
+    rt_mutex_take(&_container_lock, RT_WAITING_FOREVER);
+
     /* search in container */
-    item = hash_table_find(image_hash_table, filename);
-    if (item == RT_NULL)
+    item = _image_find(filename);
+    if (item != RT_NULL)
+    {
+        _container_stat.hit ++;
+    }
+    else
     {
-        item = (struct rtgui_image_item *) rtgui_malloc(sizeof(struct rtgui_image_item));
-        if (item == RT_NULL) return RT_NULL;
+        _container_stat.miss ++;
 
         /* create image object */
-        item->image = rtgui_image_create_from_mem(type, memory, length, load_image);
-        if (item->image == RT_NULL)
-        {
-            rtgui_free(item);
-            return RT_NULL; /* create image failed */
-        }
-
-        item->refcount = 1;
-        item->filename = rt_strdup(filename);
-        hash_table_insert(image_hash_table, item->filename, item);
+        image = rtgui_image_create_from_mem(type, memory, length, load_image);
+        if (image != RT_NULL)
+            item = _image_insert(filename, image);
     }
-    else item->refcount ++;
+
+    rt_mutex_release(&_container_lock);
 
     return item;
 }
+RTM_EXPORT(rtgui_image_container_get_memref);
 
 void rtgui_image_container_put(rtgui_image_item_t *item)
 {
+    rt_mutex_take(&_container_lock, RT_WAITING_FOREVER);
+
     item->refcount --;
     if (item->refcount == 0)
     {
-        /* remove item from container */
-        hash_table_remove(image_hash_table, item->filename);
+        /* keep it as the most recently used idle image */
+        rtgui_dlist_insert_after(&_image_lru, &(item->lru));
+        _container_stat.cached_size += item->size;
 
-        /* destroy image and image item */
-        rt_free(item->filename);
-        rtgui_image_destroy(item->image);
-        rtgui_free(item);
+        _image_shrink();
+    }
+
+    rt_mutex_release(&_container_lock);
+}
+RTM_EXPORT(rtgui_image_container_put);
+
+void rtgui_image_container_set_size(rt_uint32_t size)
+{
+    rt_mutex_take(&_container_lock, RT_WAITING_FOREVER);
+    _container_stat.max_size = size;
+    _image_shrink();
+    rt_mutex_release(&_container_lock);
+}
+RTM_EXPORT(rtgui_image_container_set_size);
+
+/* release all the idle images, e.g. when the memory is short */
+void rtgui_image_container_flush(void)
+{
+    struct rtgui_image_item *item;
+
+    rt_mutex_take(&_container_lock, RT_WAITING_FOREVER);
+    while (!rtgui_dlist_isempty(&_image_lru))
+    {
+        item = rtgui_dlist_entry(_image_lru.next, struct rtgui_image_item, lru);
+        rtgui_dlist_remove(&(item->lru));
+        _container_stat.cached_size -= item->size;
+
+        _image_item_destroy(item);
     }
+    rt_mutex_release(&_container_lock);
+}
+RTM_EXPORT(rtgui_image_container_flush);
+
+void rtgui_image_container_get_stat(struct rtgui_image_container_stat *stat)
+{
+    RT_ASSERT(stat != RT_NULL);
+
+    *stat = _container_stat;
+}
+RTM_EXPORT(rtgui_image_container_get_stat);
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+void list_imgcache(void)
+{
+    rt_kprintf("image cache: %d/%d bytes, %d bytes idle\n", _container_stat.used_size,
+               _container_stat.max_size, _container_stat.cached_size);
+    rt_kprintf("hit: %d, miss: %d, evict: %d, prefetch: %d\n", _container_stat.hit,
+               _container_stat.miss, _container_stat.evict, _container_stat.prefetch);
 }
+FINSH_FUNCTION_EXPORT(list_imgcache, display image cache statistics);
+#endif
 
 #endif
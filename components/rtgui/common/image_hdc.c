@@ -1,10 +1,22 @@
+/*
+ * File      : image_hdc.c
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2013, RT-Thread Development Team
+ *
+ * The license and distribution terms for this file may be
+ * found in the file LICENSE in this distribution or at
+ * http://www.rt-thread.org/license/LICENSE
+ */
 #include <rtthread.h>
 #include <rtgui/dc_hw.h>
 #include <rtgui/image.h>
 #include <rtgui/rtgui_system.h>
 #include <rtgui/image_hdc.h>
+#include <rtgui/filerw.h>
 
 #define HDC_MAGIC_LEN       4
+/* the pitch of loaded pixels, which is aligned to word */
+#define HDC_PITCH(w, bpp)   ((((w) * (bpp)) + 3) & ~3)
 
 struct rtgui_image_hdc
 {
@@ -109,7 +121,10 @@ static rt_bool_t rtgui_image_hdc_load(struct rtgui_image *image, struct rtgui_fi
 
     if (load == RT_TRUE)
     {
+        rt_uint16_t y;
+
         /* load all pixels */
+        hdc->pitch = HDC_PITCH(image->w, hdc->byte_per_pixel);
         hdc->pixels = rtgui_malloc(image->h * hdc->pitch);
         if (hdc->pixels == RT_NULL)
         {
@@ -118,7 +133,8 @@ static rt_bool_t rtgui_image_hdc_load(struct rtgui_image *image, struct rtgui_fi
             return RT_FALSE;
         }
 
-        rtgui_filerw_read(hdc->filerw, hdc->pixels, 1, image->h * hdc->pitch);
+        for (y = 0; y < image->h; y ++)
+            rtgui_filerw_read(hdc->filerw, hdc->pixels + y * hdc->pitch, 1, image->w * hdc->byte_per_pixel);
         rtgui_filerw_close(hdc->filerw);
         hdc->filerw = RT_NULL;
         hdc->pixel_offset = 0;
@@ -241,3 +257,428 @@ void rtgui_image_hdc_init()
     /* register hdc on image system */
     rtgui_image_register_engine(&rtgui_image_hdc_engine);
 }
+
+/*
+ * The off-screen dc in the pixel format of graphic driver. Image engines draw
+ * into it the same as into the screen, so the converted pixels are the same
+ * as the ones blitted by the engine.
+ */
+struct hdc_native_dc
+{
+    struct rtgui_dc parent;
+    rtgui_gc_t gc;
+
+    rt_uint8_t pixel_format;
+    rt_uint8_t byte_per_pixel;
+    rt_uint16_t width, height;
+    rt_uint16_t pitch;
+
+    rt_uint8_t *pixels;
+};
+
+static void _native_set_pixel(struct hdc_native_dc *dc, int x, int y, rtgui_color_t color)
+{
+    rt_uint16_t *ptr;
+
+    if (x < 0 || y < 0 || x >= dc->width || y >= dc->height) return;
+
+    ptr = (rt_uint16_t *)(dc->pixels + y * dc->pitch + x * dc->byte_per_pixel);
+    if (dc->pixel_format == RTGRAPHIC_PIXEL_FORMAT_RGB565P)
+        *ptr = rtgui_color_to_565p(color);
+    else
+        *ptr = rtgui_color_to_565(color);
+}
+
+static void _native_draw_point(struct rtgui_dc *self, int x, int y)
+{
+    struct hdc_native_dc *dc = (struct hdc_native_dc *)self;
+
+    _native_set_pixel(dc, x, y, dc->gc.foreground);
+}
+
+static void _native_draw_color_point(struct rtgui_dc *self, int x, int y, rtgui_color_t color)
+{
+    _native_set_pixel((struct hdc_native_dc *)self, x, y, color);
+}
+
+static void _native_draw_vline(struct rtgui_dc *self, int x, int y1, int y2)
+{
+    struct hdc_native_dc *dc = (struct hdc_native_dc *)self;
+
+    for (; y1 < y2; y1 ++)
+        _native_set_pixel(dc, x, y1, dc->gc.foreground);
+}
+
+static void _native_draw_hline(struct rtgui_dc *self, int x1, int x2, int y)
+{
+    struct hdc_native_dc *dc = (struct hdc_native_dc *)self;
+
+    for (; x1 < x2; x1 ++)
+        _native_set_pixel(dc, x1, y, dc->gc.foreground);
+}
+
+static void _native_fill_rect(struct rtgui_dc *self, struct rtgui_rect *rect)
+{
+    int x, y;
+    struct hdc_native_dc *dc = (struct hdc_native_dc *)self;
+
+    for (y = rect->y1; y < rect->y2; y ++)
+        for (x = rect->x1; x < rect->x2; x ++)
+            _native_set_pixel(dc, x, y, dc->gc.background);
+}
+
+static void _native_blit_line(struct rtgui_dc *self, int x1, int x2, int y, rt_uint8_t *line_data)
+{
+    struct hdc_native_dc *dc = (struct hdc_native_dc *)self;
+
+    if (y < 0 || y >= dc->height) return;
+    if (x1 < 0)
+    {
+        line_data += -x1 * dc->byte_per_pixel;
+        x1 = 0;
+    }
+    if (x2 > dc->width) x2 = dc->width;
+    if (x1 >= x2) return;
+
+    rt_memcpy(dc->pixels + y * dc->pitch + x1 * dc->byte_per_pixel, line_data,
+              (x2 - x1) * dc->byte_per_pixel);
+}
+
+static void _native_blit(struct rtgui_dc *dc, struct rtgui_point *dc_point, struct rtgui_dc *dest, rtgui_rect_t *rect)
+{
+    /* not supported */
+}
+
+static void _native_set_gc(struct rtgui_dc *self, rtgui_gc_t *gc)
+{
+    ((struct hdc_native_dc *)self)->gc = *gc;
+}
+
+static rtgui_gc_t *_native_get_gc(struct rtgui_dc *self)
+{
+    return &(((struct hdc_native_dc *)self)->gc);
+}
+
+static rt_bool_t _native_get_visible(struct rtgui_dc *dc)
+{
+    return RT_TRUE;
+}
+
+static void _native_get_rect(struct rtgui_dc *self, rtgui_rect_t *rect)
+{
+    struct hdc_native_dc *dc = (struct hdc_native_dc *)self;
+
+    rect->x1 = rect->y1 = 0;
+    rect->x2 = dc->width;
+    rect->y2 = dc->height;
+}
+
+static rt_bool_t _native_fini(struct rtgui_dc *dc)
+{
+    /* the pixels are owned by the converted image */
+    return RT_TRUE;
+}
+
+static const struct rtgui_dc_engine _native_dc_engine =
+{
+    _native_draw_point,
+    _native_draw_color_point,
+    _native_draw_vline,
+    _native_draw_hline,
+    _native_fill_rect,
+    _native_blit_line,
+    _native_blit,
+
+    _native_set_gc,
+    _native_get_gc,
+
+    _native_get_visible,
+    _native_get_rect,
+
+    _native_fini,
+};
+
+/* draw image on a native dc filled with background */
+static void _native_dc_draw(struct hdc_native_dc *dc, struct rtgui_image *image, rtgui_color_t background)
+{
+    struct rtgui_rect rect;
+
+    rect.x1 = rect.y1 = 0;
+    rect.x2 = dc->width;
+    rect.y2 = dc->height;
+
+    dc->gc.background = background;
+    _native_fill_rect(&(dc->parent), &rect);
+    rtgui_image_blit(image, &(dc->parent), &rect);
+}
+
+static rt_bool_t _native_dc_init(struct hdc_native_dc *dc, int w, int h)
+{
+    struct rtgui_graphic_driver *hw_driver = rtgui_graphic_driver_get_default();
+
+    /* only the 16bpp formats are supported */
+    if (hw_driver == RT_NULL ||
+            (hw_driver->pixel_format != RTGRAPHIC_PIXEL_FORMAT_RGB565 &&
+             hw_driver->pixel_format != RTGRAPHIC_PIXEL_FORMAT_RGB565P))
+        return RT_FALSE;
+
+    dc->parent.type = RTGUI_DC_NATIVE;
+    dc->parent.engine = &_native_dc_engine;
+    dc->gc.foreground = default_foreground;
+    dc->gc.background = default_background;
+    dc->gc.font = rtgui_font_default();
+    dc->gc.textalign = RTGUI_ALIGN_LEFT | RTGUI_ALIGN_TOP;
+    dc->gc.textstyle = RTGUI_TEXTSTYLE_NORMAL;
+
+    dc->pixel_format = hw_driver->pixel_format;
+    dc->byte_per_pixel = hw_driver->bits_per_pixel / 8;
+    dc->width = w;
+    dc->height = h;
+    dc->pitch = HDC_PITCH(w, dc->byte_per_pixel);
+
+    dc->pixels = rtgui_malloc(h * dc->pitch);
+    return dc->pixels != RT_NULL;
+}
+
+/*
+ * Convert an image into a loaded hdc image in the pixel format of graphic
+ * driver, which is blitted by raw lines without pixel conversion. The
+ * transparent pixels are composited on background, so the image should be
+ * drawn on the same background later. The source image is not changed.
+ */
+struct rtgui_image *rtgui_image_hdc_convert(struct rtgui_image *image, rtgui_color_t background)
+{
+    struct hdc_native_dc dc;
+    struct rtgui_image *native;
+    struct rtgui_image_hdc *hdc;
+
+    RT_ASSERT(image != RT_NULL);
+
+    native = (struct rtgui_image *) rtgui_malloc(sizeof(struct rtgui_image));
+    hdc = (struct rtgui_image_hdc *) rtgui_malloc(sizeof(struct rtgui_image_hdc));
+    if (native == RT_NULL || hdc == RT_NULL)
+        goto __error;
+
+    if (_native_dc_init(&dc, image->w, image->h) != RT_TRUE)
+        goto __error;
+    _native_dc_draw(&dc, image, background);
+
+    hdc->is_loaded = RT_TRUE;
+    hdc->byte_per_pixel = dc.byte_per_pixel;
+    hdc->pitch = dc.pitch;
+    hdc->pixel_offset = 0;
+    hdc->pixels = dc.pixels;
+    hdc->filerw = RT_NULL;
+    hdc->hw_driver = rtgui_graphic_driver_get_default();
+
+    native->w = image->w;
+    native->h = image->h;
+    native->engine = &rtgui_image_hdc_engine;
+    native->palette = RT_NULL;
+    native->data = hdc;
+
+    return native;
+
+__error:
+    if (native != RT_NULL) rtgui_free(native);
+    if (hdc != RT_NULL) rtgui_free(hdc);
+    return RT_NULL;
+}
+RTM_EXPORT(rtgui_image_hdc_convert);
+
+/* allocate a loaded hdc image in the pixel format of graphic driver, the pixels are not initialized */
+struct rtgui_image *rtgui_image_hdc_alloc(rt_uint16_t w, rt_uint16_t h)
+{
+    struct rtgui_image *image;
+    struct rtgui_image_hdc *hdc;
+
+    image = (struct rtgui_image *) rtgui_malloc(sizeof(struct rtgui_image));
+    hdc = (struct rtgui_image_hdc *) rtgui_malloc(sizeof(struct rtgui_image_hdc));
+    if (image == RT_NULL || hdc == RT_NULL)
+        goto __error;
+
+    hdc->hw_driver = rtgui_graphic_driver_get_default();
+    if (hdc->hw_driver == RT_NULL)
+        goto __error;
+
+    hdc->is_loaded = RT_TRUE;
+    hdc->byte_per_pixel = hdc->hw_driver->bits_per_pixel / 8;
+    hdc->pitch = HDC_PITCH(w, hdc->byte_per_pixel);
+    hdc->pixel_offset = 0;
+    hdc->filerw = RT_NULL;
+    hdc->pixels = rtgui_malloc(h * hdc->pitch);
+    if (hdc->pixels == RT_NULL)
+        goto __error;
+
+    image->w = w;
+    image->h = h;
+    image->engine = &rtgui_image_hdc_engine;
+    image->palette = RT_NULL;
+    image->data = hdc;
+
+    return image;
+
+__error:
+    if (image != RT_NULL) rtgui_free(image);
+    if (hdc != RT_NULL) rtgui_free(hdc);
+    return RT_NULL;
+}
+RTM_EXPORT(rtgui_image_hdc_alloc);
+
+/* get the pixels of a loaded hdc or hdcmm image, RT_NULL for the other images */
+rt_uint8_t *rtgui_image_hdc_get_pixels(struct rtgui_image *image, rt_uint16_t *pitch)
+{
+    RT_ASSERT(image != RT_NULL);
+
+    if (image->engine == &rtgui_image_hdc_engine)
+    {
+        struct rtgui_image_hdc *hdc = (struct rtgui_image_hdc *) image->data;
+
+        *pitch = hdc->pitch;
+        return hdc->pixels;
+    }
+    else if (image->engine == &rtgui_image_hdcmm_engine)
+    {
+        struct rtgui_image_hdcmm *hdc = (struct rtgui_image_hdcmm *) image;
+
+        *pitch = hdc->pitch;
+        return hdc->pixels;
+    }
+
+    return RT_NULL;
+}
+RTM_EXPORT(rtgui_image_hdc_get_pixels);
+
+#ifdef RTGUI_USING_DFS_FILERW
+/* save a loaded hdc image, e.g. the converted one, into file */
+rt_bool_t rtgui_image_hdc_save(struct rtgui_image *image, const char *filename)
+{
+    rt_uint16_t y;
+    rt_uint32_t header[5];
+    rt_size_t line;
+    struct rtgui_filerw *filerw;
+    struct rtgui_image_hdc *hdc;
+
+    RT_ASSERT(image != RT_NULL);
+
+    if (image->engine != &rtgui_image_hdc_engine) return RT_FALSE;
+    hdc = (struct rtgui_image_hdc *) image->data;
+    if (hdc->pixels == RT_NULL) return RT_FALSE;
+
+    filerw = rtgui_filerw_create_file(filename, "wb");
+    if (filerw == RT_NULL) return RT_FALSE;
+
+    rt_memcpy(&header[0], "HDC", HDC_MAGIC_LEN);
+    header[1] = image->w;
+    header[2] = image->h;
+    header[3] = hdc->byte_per_pixel * 8;
+    header[4] = 0;
+
+    line = image->w * hdc->byte_per_pixel;
+    if (rtgui_filerw_write(filerw, header, 1, sizeof(header)) != sizeof(header))
+        goto __error;
+    for (y = 0; y < image->h; y ++)
+    {
+        if (rtgui_filerw_write(filerw, hdc->pixels + y * hdc->pitch, 1, line) != line)
+            goto __error;
+    }
+
+    rtgui_filerw_close(filerw);
+    return RT_TRUE;
+
+__error:
+    rtgui_filerw_close(filerw);
+    return RT_FALSE;
+}
+RTM_EXPORT(rtgui_image_hdc_save);
+
+/*
+ * Create a native image of filename. The converted pixels are saved in
+ * hdc_filename, which is loaded directly without decoding next time. Remove
+ * the hdc file when the source image or the background changes.
+ */
+struct rtgui_image *rtgui_image_hdc_create_native(const char *filename, const char *hdc_filename,
+                                                  rtgui_color_t background)
+{
+    struct rtgui_image *image, *native;
+
+    native = rtgui_image_create_from_file("hdc", hdc_filename, RT_TRUE);
+    if (native != RT_NULL) return native;
+
+    image = rtgui_image_create(filename, RT_TRUE);
+    if (image == RT_NULL) return RT_NULL;
+
+    native = rtgui_image_hdc_convert(image, background);
+    rtgui_image_destroy(image);
+    if (native != RT_NULL)
+        rtgui_image_hdc_save(native, hdc_filename);
+
+    return native;
+}
+RTM_EXPORT(rtgui_image_hdc_create_native);
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+#define _TICK_MS(tick)      ((tick) * 1000 / RT_TICK_PER_SECOND)
+
+static rt_tick_t _image_bench_blit(struct hdc_native_dc *dc, struct rtgui_image *image, int loops)
+{
+    int index;
+    rt_tick_t tick;
+    struct rtgui_rect rect;
+
+    _native_get_rect(&(dc->parent), &rect);
+
+    tick = rt_tick_get();
+    for (index = 0; index < loops; index ++)
+        rtgui_image_blit(image, &(dc->parent), &rect);
+
+    return rt_tick_get() - tick;
+}
+
+/* the first paint and steady-state blit time of an image, before and after conversion */
+void image_bench(const char *filename, int loops)
+{
+    rt_tick_t decode, first, blit, convert, native_blit;
+    struct hdc_native_dc dc;
+    struct rtgui_image *image, *native;
+
+    if (loops <= 0) loops = 10;
+
+    decode = rt_tick_get();
+    image = rtgui_image_create(filename, RT_TRUE);
+    decode = rt_tick_get() - decode;
+    if (image == RT_NULL)
+    {
+        rt_kprintf("open image %s failed\n", filename);
+        return;
+    }
+
+    if (_native_dc_init(&dc, image->w, image->h) != RT_TRUE)
+    {
+        rt_kprintf("pixel format not supported or no memory\n");
+        rtgui_image_destroy(image);
+        return;
+    }
+
+    first = _image_bench_blit(&dc, image, 1);
+    blit = _image_bench_blit(&dc, image, loops);
+
+    convert = rt_tick_get();
+    native = rtgui_image_hdc_convert(image, default_background);
+    convert = rt_tick_get() - convert;
+    native_blit = native != RT_NULL ? _image_bench_blit(&dc, native, loops) : 0;
+
+    rt_kprintf("%s: %dx%d, %s\n", filename, image->w, image->h, image->engine->name);
+    rt_kprintf("decode: %d ms, first paint: %d ms, blit: %d ms/%d\n",
+               _TICK_MS(decode), _TICK_MS(decode + first), _TICK_MS(blit), loops);
+    rt_kprintf("convert: %d ms, native blit: %d ms/%d\n",
+               _TICK_MS(convert), _TICK_MS(native_blit), loops);
+
+    if (native != RT_NULL) rtgui_image_destroy(native);
+    rtgui_image_destroy(image);
+    rtgui_free(dc.pixels);
+}
+FINSH_FUNCTION_EXPORT(image_bench, benchmark image blit: image_bench(filename, loops));
+#endif
+#endif
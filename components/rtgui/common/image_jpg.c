@@ -6,6 +6,23 @@
 #include <rtthread.h>
 #include <rtgui/rtgui.h>
 
+#if defined(RTGUI_IMAGE_JPEG) || defined(RTGUI_IMAGE_TJPGD)
+/* the largest scale 1/(2^scale) of w x h which fits in max_w x max_h, up to 1/8 */
+static rt_uint8_t _jpeg_fit_scale(rt_uint32_t w, rt_uint32_t h, rt_uint16_t max_w, rt_uint16_t max_h)
+{
+    rt_uint8_t scale;
+
+    if (max_w == 0 || max_h == 0) return 0;
+
+    for (scale = 0; scale < 3; scale ++)
+    {
+        if ((w >> scale) <= max_w && (h >> scale) <= max_h) break;
+    }
+
+    return scale;
+}
+#endif
+
 #ifdef RTGUI_IMAGE_JPEG
 #include <stdio.h>
 #include <stdlib.h>
@@ -305,7 +322,8 @@ static void output_no_message(j_common_ptr cinfo)
     /* do nothing */
 }
 
-static rt_bool_t rtgui_image_jpeg_load(struct rtgui_image *image, struct rtgui_filerw *file, rt_bool_t load)
+static rt_bool_t rtgui_image_jpeg_load_fit(struct rtgui_image *image, struct rtgui_filerw *file, rt_bool_t load,
+                                           rt_uint16_t max_w, rt_uint16_t max_h)
 {
     struct rtgui_image_jpeg *jpeg;
 
@@ -324,21 +342,24 @@ static rt_bool_t rtgui_image_jpeg_load(struct rtgui_image *image, struct rtgui_f
     rtgui_jpeg_filerw_src_init(&jpeg->cinfo, jpeg->filerw);
     (void)jpeg_read_header(&jpeg->cinfo, TRUE);
 
-    image->w = jpeg->cinfo.image_width;
-    image->h = jpeg->cinfo.image_height;
+    /* the scale takes effect only when it's set before decompression */
+    jpeg->cinfo.scale_num   = 1;
+    jpeg->cinfo.scale_denom = 1 << _jpeg_fit_scale(jpeg->cinfo.image_width,
+                                                   jpeg->cinfo.image_height, max_w, max_h);
+
+    /* start decompression */
+    (void) jpeg_start_decompress(&jpeg->cinfo);
+
+    image->w = jpeg->cinfo.output_width;
+    image->h = jpeg->cinfo.output_height;
 
     /* set image private data and engine */
     image->data = jpeg;
     image->engine = &rtgui_image_jpeg_engine;
 
-    /* start decompression */
-    (void) jpeg_start_decompress(&jpeg->cinfo);
-
     jpeg->cinfo.out_color_space = JCS_RGB;
     jpeg->cinfo.quantize_colors = FALSE;
     /* use fast jpeg */
-    jpeg->cinfo.scale_num   = 1;
-    jpeg->cinfo.scale_denom = 1;
     jpeg->cinfo.dct_method = JDCT_FASTEST;
     jpeg->cinfo.do_fancy_upsampling = FALSE;
 
@@ -363,6 +384,10 @@ static rt_bool_t rtgui_image_jpeg_load(struct rtgui_image *image, struct rtgui_f
     return RT_TRUE;
 }
 
+static rt_bool_t rtgui_image_jpeg_load(struct rtgui_image *image, struct rtgui_filerw *file, rt_bool_t load)
+{
+    return rtgui_image_jpeg_load_fit(image, file, load, 0, 0);
+}
 
 static void rtgui_image_jpeg_unload(struct rtgui_image *image)
 {
@@ -389,7 +414,7 @@ static void rtgui_image_jpeg_unload(struct rtgui_image *image)
 
 static void rtgui_image_jpeg_blit(struct rtgui_image *image, struct rtgui_dc *dc, struct rtgui_rect *rect)
 {
-    rt_uint16_t x, y;
+    rt_uint16_t x, y, w, h;
     rtgui_color_t *ptr;
     struct rtgui_image_jpeg *jpeg;
 
@@ -398,14 +423,17 @@ static void rtgui_image_jpeg_blit(struct rtgui_image *image, struct rtgui_dc *dc
     jpeg = (struct rtgui_image_jpeg *) image->data;
     RT_ASSERT(jpeg != RT_NULL);
 
+    /* the minimum rect */
+    w = image->w < rtgui_rect_width(*rect) ? image->w : rtgui_rect_width(*rect);
+    h = image->h < rtgui_rect_height(*rect) ? image->h : rtgui_rect_height(*rect);
+
     if (jpeg->pixels != RT_NULL)
     {
-        ptr = (rtgui_color_t *) jpeg->pixels;
-
         /* draw each point within dc */
-        for (y = 0; y < image->h; y ++)
+        for (y = 0; y < h; y ++)
         {
-            for (x = 0; x < image->w; x++)
+            ptr = (rtgui_color_t *) jpeg->pixels + y * image->w;
+            for (x = 0; x < w; x++)
             {
                 /* not alpha */
                 if ((*ptr >> 24) != 255)
@@ -423,11 +451,11 @@ static void rtgui_image_jpeg_blit(struct rtgui_image *image, struct rtgui_dc *dc
         /* seek to the begin of file */
         rtgui_filerw_seek(jpeg->filerw, 0, RTGUI_FILE_SEEK_SET);
 
-        /* decompress line and line */
-        for (y = 0; y < image->h; y ++)
+        /* decompress line and line, until the bottom of rect */
+        for (y = 0; y < h; y ++)
         {
             ptr = (rtgui_color_t *)rtgui_image_get_line(image, y);
-            for (x = 0; x < image->w; x++)
+            for (x = 0; x < w; x++)
             {
                 /* not alpha */
                 if ((*ptr >> 24) != 255)
@@ -669,15 +697,15 @@ static UINT tjpgd_out_func(JDEC *jdec, void *bitmap, JRECT *rect)
         /* we decompress from top to bottom if the block is beyond the right
          * boundary, just continue to next block. However, if the block is
          * beyond the bottom boundary, we don't need to decompress the rest. */
-        if (rect->left > jpeg->dst_w)
+        if (rect->left >= jpeg->dst_w)
             return 1;
-        if (rect->top  > jpeg->dst_h)
+        if (rect->top  >= jpeg->dst_h)
             return 0;
 
-        w = rect->right < jpeg->dst_w ? rect->right : jpeg->dst_w;
-        w = w - rect->left + 1;
-        h = rect->bottom < jpeg->dst_h ? rect->bottom : jpeg->dst_h;
-        h = h - rect->top + 1;
+        w = rect->right < jpeg->dst_w ? rect->right + 1 : jpeg->dst_w;
+        w = w - rect->left;
+        h = rect->bottom < jpeg->dst_h ? rect->bottom + 1 : jpeg->dst_h;
+        h = h - rect->top;
         if (jpeg->byte_per_pixel == hw_driver->bits_per_pixel / 8)
         {
             if (hw_driver->pixel_format == RTGRAPHIC_PIXEL_FORMAT_RGB565)
@@ -762,18 +790,13 @@ static rt_bool_t rtgui_image_jpeg_check(struct rtgui_filerw *file)
     return is_JPG;
 }
 
-static rt_bool_t rtgui_image_jpeg_load(struct rtgui_image *image, struct rtgui_filerw *file, rt_bool_t load)
+static rt_bool_t rtgui_image_jpeg_load_fit(struct rtgui_image *image, struct rtgui_filerw *file, rt_bool_t load,
+                                           rt_uint16_t max_w, rt_uint16_t max_h)
 {
-    rt_uint8_t scale = 0;
     rt_bool_t res = RT_FALSE;
     struct rtgui_image_jpeg *jpeg;
     JRESULT ret;
 
-    if (scale > TJPGD_MAX_SCALING_FACTOR)
-    {
-        return RT_FALSE;
-    }
-
     do
     {
         jpeg = (struct rtgui_image_jpeg *)rt_malloc(sizeof(struct rtgui_image_jpeg));
@@ -784,7 +807,7 @@ static rt_bool_t rtgui_image_jpeg_load(struct rtgui_image *image, struct rtgui_f
         jpeg->filerw = file;
         jpeg->is_loaded = RT_FALSE;
         jpeg->to_buffer = load;
-        jpeg->scale = scale;
+        jpeg->scale = 0;
 #if (JD_FORMAT == 0)
         jpeg->byte_per_pixel = 3;
 #elif (JD_FORMAT == 1)
@@ -819,6 +842,10 @@ static rt_bool_t rtgui_image_jpeg_load(struct rtgui_image *image, struct rtgui_f
         rt_kprintf("TJPGD: prepare OK\n");
 #endif
 
+        /* TJpgDec scales in the IDCT, which skips most of the work */
+        jpeg->scale = _jpeg_fit_scale(jpeg->tjpgd.width, jpeg->tjpgd.height, max_w, max_h);
+        RT_ASSERT(jpeg->scale <= TJPGD_MAX_SCALING_FACTOR);
+
         image->w = (rt_uint16_t)jpeg->tjpgd.width >> jpeg->scale;
         image->h = (rt_uint16_t)jpeg->tjpgd.height >> jpeg->scale;
 
@@ -868,6 +895,10 @@ static rt_bool_t rtgui_image_jpeg_load(struct rtgui_image *image, struct rtgui_f
     return res;
 }
 
+static rt_bool_t rtgui_image_jpeg_load(struct rtgui_image *image, struct rtgui_filerw *file, rt_bool_t load)
+{
+    return rtgui_image_jpeg_load_fit(image, file, load, 0, 0);
+}
 
 static void rtgui_image_jpeg_unload(struct rtgui_image *image)
 {
@@ -940,13 +971,32 @@ static void rtgui_image_jpeg_blit(struct rtgui_image *image,
         if (!jpeg->is_loaded)
         {
             JRESULT ret;
+            struct rtgui_rect dc_rect;
+
+            /* the rows below dc are not decoded either */
+            rtgui_dc_get_rect(dc, &dc_rect);
+            if (dst_rect->y1 + h > dc_rect.y2)
+            {
+                if (dst_rect->y1 >= dc_rect.y2) break;
+                h = dc_rect.y2 - dst_rect->y1;
+            }
 
             jpeg->dst_x = dst_rect->x1;
             jpeg->dst_y = dst_rect->y1;
             jpeg->dst_w = w;
             jpeg->dst_h = h;
+
+            /* rewind for the decompression */
+            if (rtgui_filerw_seek(jpeg->filerw, 0, RTGUI_FILE_SEEK_SET) == -1 ||
+                    jd_prepare(&jpeg->tjpgd, tjpgd_in_func, jpeg->pool,
+                               TJPGD_WORKING_BUFFER_SIZE, (void *)jpeg) != JDR_OK)
+            {
+                break;
+            }
+
+            /* JDR_INTR: output stopped below the rect */
             ret = jd_decomp(&jpeg->tjpgd, tjpgd_out_func, jpeg->scale);
-            if (ret != JDR_OK)
+            if (ret != JDR_OK && ret != JDR_INTR)
             {
                 break;
             }
@@ -974,21 +1024,25 @@ static void rtgui_image_jpeg_blit(struct rtgui_image *image,
 
             if (blit_line)
             {
-                rt_uint16_t x;
-                rt_uint8_t temp[4];
+                rt_uint8_t *line_buf;
+
+                /* convert a row at a time */
+                line_buf = rtgui_malloc(w * hw_driver->bits_per_pixel / 8);
+                if (line_buf == RT_NULL)
+                {
+                    break;
+                }
 
                 for (y = 0; y < h; y++)
                 {
-                    for (x = 0; x < w; x++)
-                    {
-                        blit_line(temp, src, jpeg->byte_per_pixel);
-                        src += jpeg->byte_per_pixel;
-                        dc->engine->blit_line(dc,
-                                              dst_rect->x1 + x, dst_rect->x1 + x,
-                                              dst_rect->y1 + y,
-                                              temp);
-                    }
+                    blit_line(line_buf, src, w * jpeg->byte_per_pixel);
+                    dc->engine->blit_line(dc,
+                                          dst_rect->x1, dst_rect->x1 + w,
+                                          dst_rect->y1 + y,
+                                          line_buf);
+                    src += imageWidth;
                 }
+                rtgui_free(line_buf);
             }
             else
             {
@@ -1006,6 +1060,48 @@ static void rtgui_image_jpeg_blit(struct rtgui_image *image,
     while (0);
 }
 #endif /* defined(RTGUI_IMAGE_TJPGD) */
+
+#if (defined(RTGUI_IMAGE_JPEG) || defined(RTGUI_IMAGE_TJPGD)) && defined(RTGUI_USING_DFS_FILERW)
+/*
+ * Create a jpeg image decoded at 1/1, 1/2, 1/4 or 1/8 scale, the largest one
+ * which fits in max_w x max_h, e.g. for thumbnails. It's the smallest scale
+ * if none of them fits.
+ */
+struct rtgui_image *rtgui_image_jpeg_create_fit(const char *filename, rt_uint16_t max_w, rt_uint16_t max_h,
+                                                rt_bool_t load)
+{
+    struct rtgui_filerw *filerw;
+    struct rtgui_image *image;
+
+    /* create filerw context */
+    filerw = rtgui_filerw_create_file(filename, "rb");
+    if (filerw == RT_NULL) return RT_NULL;
+
+    if (rtgui_image_jpeg_check(filerw) != RT_TRUE)
+    {
+        rtgui_filerw_close(filerw);
+        return RT_NULL;
+    }
+
+    image = (struct rtgui_image *) rtgui_malloc(sizeof(struct rtgui_image));
+    if (image == RT_NULL)
+    {
+        rtgui_filerw_close(filerw);
+        return RT_NULL;
+    }
+
+    image->palette = RT_NULL;
+    if (rtgui_image_jpeg_load_fit(image, filerw, load, max_w, max_h) != RT_TRUE)
+    {
+        rtgui_filerw_close(filerw);
+        rtgui_free(image);
+        return RT_NULL;
+    }
+
+    return image;
+}
+RTM_EXPORT(rtgui_image_jpeg_create_fit);
+#endif
 /***************************************************************************//**
  * @}
  ******************************************************************************/
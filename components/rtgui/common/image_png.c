@@ -3,6 +3,8 @@
 
 #ifdef RTGUI_IMAGE_PNG
 #include "png.h"
+#include <rtgui/dc_hw.h>
+#include <rtgui/driver.h>
 #include <rtgui/image_png.h>
 
 #define PNG_MAGIC_LEN       8
@@ -44,64 +46,74 @@ static void rtgui_image_png_read_data(png_structp png_ptr, png_bytep data, png_s
     rtgui_filerw_read(filerw, data, length, 1);
 }
 
-static rt_bool_t rtgui_image_png_process(png_structp png_ptr, png_infop info_ptr, struct rtgui_image_png *png)
+/* x * a / 255 in integer, exact for all 8 bit x and a */
+rt_inline rt_uint32_t _png_mul_div255(rt_uint32_t x, rt_uint32_t a)
 {
-    rt_uint32_t x, y;
-    png_bytep row;
-    png_bytep data;
-    rtgui_color_t *ptr;
-
-    row = (png_bytep) rtgui_malloc(png_get_rowbytes(png_ptr, info_ptr));
-    if (row == RT_NULL) return RT_FALSE;
+    x = x * a + 128;
+    return (x + (x >> 8)) >> 8;
+}
 
-    ptr = (rtgui_color_t *)png->pixels;
+/* convert a decoded row to color with the alpha premultiplied */
+static void _png_convert_row(png_infop info_ptr, png_bytep row, rtgui_color_t *ptr, int width)
+{
+    int x;
+    png_bytep data;
+    rt_uint32_t a;
 
     switch (info_ptr->color_type)
     {
     case PNG_COLOR_TYPE_RGB:
-        for (y = 0; y < info_ptr->height; y++)
+        for (x = 0, data = row; x < width; x ++, data += 3)
         {
-            png_read_row(png_ptr, row, png_bytep_NULL);
-            for (x = 0; x < info_ptr->width; x++)
-            {
-                data = &(row[x * 3]);
-
-                ptr[x + y * info_ptr->width] = RTGUI_RGB(data[0], data[1], data[2]);
-            }
+            ptr[x] = RTGUI_RGB(data[0], data[1], data[2]);
         }
         break;
 
     case PNG_COLOR_TYPE_RGBA:
-        for (y = 0; y < info_ptr->height; y++)
+        for (x = 0, data = row; x < width; x ++, data += 4)
         {
-            png_read_row(png_ptr, row, png_bytep_NULL);
-            for (x = 0; x < info_ptr->width; x++)
-            {
-                data = &(row[x * 4]);
-
-                ptr[x + y * info_ptr->width] = RTGUI_ARGB(data[3], data[0], data[1], data[2]);
-            }
+            a = data[3];
+            if (a == 255)
+                ptr[x] = RTGUI_RGB(data[0], data[1], data[2]);
+            else if (a == 0)
+                ptr[x] = 0;
+            else
+                ptr[x] = RTGUI_ARGB(a, _png_mul_div255(data[0], a),
+                                    _png_mul_div255(data[1], a),
+                                    _png_mul_div255(data[2], a));
         }
-
         break;
 
     case PNG_COLOR_TYPE_PALETTE:
-        for (y = 0; y < info_ptr->height; y++)
+        for (x = 0, data = row; x < width; x ++, data ++)
         {
-            png_read_row(png_ptr, row, png_bytep_NULL);
-            for (x = 0; x < info_ptr->width; x++)
-            {
-                data = &(row[x]);
-
-                ptr[x] = RTGUI_ARGB(0, info_ptr->palette[data[0]].red,
-                                    info_ptr->palette[data[0]].green,
-                                    info_ptr->palette[data[0]].blue);
-            }
+            ptr[x] = RTGUI_RGB(info_ptr->palette[data[0]].red,
+                               info_ptr->palette[data[0]].green,
+                               info_ptr->palette[data[0]].blue);
         }
+        break;
 
     default:
         break;
-    };
+    }
+}
+
+static rt_bool_t rtgui_image_png_process(png_structp png_ptr, png_infop info_ptr, struct rtgui_image_png *png)
+{
+    rt_uint32_t y;
+    png_bytep row;
+    rtgui_color_t *ptr;
+
+    row = (png_bytep) rtgui_malloc(png_get_rowbytes(png_ptr, info_ptr));
+    if (row == RT_NULL) return RT_FALSE;
+
+    ptr = (rtgui_color_t *)png->pixels;
+    for (y = 0; y < info_ptr->height; y++)
+    {
+        png_read_row(png_ptr, row, png_bytep_NULL);
+        _png_convert_row(info_ptr, row, ptr, info_ptr->width);
+        ptr += info_ptr->width;
+    }
 
     rtgui_free(row);
 
@@ -243,18 +255,188 @@ static void rtgui_image_png_unload(struct rtgui_image *image)
     }
 }
 
+/*
+ * Row compositor
+ *
+ * The pixels are premultiplied, so the blending of a pixel is
+ * dst = src + dst * (255 - alpha) / 255 in integer. Each row is split into
+ * the runs of non-transparent pixels, the destination is read back only for
+ * the translucent pixels and each run is written with one blit_line.
+ */
+struct png_blitter
+{
+    struct rtgui_dc *dc;
+
+    /* device coordinate of dc origin */
+    int ox, oy;
+    /* pixel format of dc, 0xff if not supported */
+    rt_uint8_t pixel_format;
+
+    /* the composited line, and it in the pixel format of dc */
+    rtgui_color_t *line;
+    rt_uint8_t *pixels;
+};
+
+static rt_bool_t _png_blitter_init(struct png_blitter *blitter, struct rtgui_dc *dc, int w)
+{
+    rtgui_widget_t *owner;
+    struct rtgui_graphic_driver *hw_driver = rtgui_graphic_driver_get_default();
+
+    blitter->dc = dc;
+    blitter->ox = blitter->oy = 0;
+    blitter->pixel_format = 0xff;
+    blitter->pixels = RT_NULL;
+
+    blitter->line = (rtgui_color_t *)rtgui_malloc(w * sizeof(rtgui_color_t));
+    if (blitter->line == RT_NULL) return RT_FALSE;
+
+    if (dc->type == RTGUI_DC_HW || dc->type == RTGUI_DC_CLIENT)
+    {
+        if (dc->type == RTGUI_DC_HW)
+            owner = ((struct rtgui_dc_hw *)dc)->owner;
+        else
+            owner = RTGUI_CONTAINER_OF(dc, struct rtgui_widget, dc_type);
+
+        blitter->ox = owner->extent.x1;
+        blitter->oy = owner->extent.y1;
+
+        if (hw_driver->pixel_format == RTGRAPHIC_PIXEL_FORMAT_RGB565 ||
+                hw_driver->pixel_format == RTGRAPHIC_PIXEL_FORMAT_RGB565P)
+        {
+            blitter->pixels = (rt_uint8_t *)rtgui_malloc(w * sizeof(rt_uint16_t));
+            if (blitter->pixels != RT_NULL)
+                blitter->pixel_format = hw_driver->pixel_format;
+        }
+    }
+    else if (dc->type == RTGUI_DC_BUFFER)
+    {
+        /* buffer dc takes the color line directly */
+        blitter->pixel_format = RTGRAPHIC_PIXEL_FORMAT_ARGB888;
+    }
+
+    return RT_TRUE;
+}
+
+static void _png_blitter_fini(struct png_blitter *blitter)
+{
+    rtgui_free(blitter->line);
+    if (blitter->pixels != RT_NULL)
+        rtgui_free(blitter->pixels);
+}
+
+/* read back the destination pixel at (x, y) of dc */
+static rtgui_color_t _png_blitter_read(struct png_blitter *blitter, int x, int y)
+{
+    rtgui_color_t color;
+    const struct rtgui_graphic_driver *hw_driver;
+
+    if (blitter->dc->type == RTGUI_DC_BUFFER)
+    {
+        struct rtgui_dc_buffer *buffer = (struct rtgui_dc_buffer *)blitter->dc;
+
+        if (x < 0 || y < 0 || x >= buffer->width || y >= buffer->height)
+            return buffer->gc.background;
+
+        return *(rtgui_color_t *)(buffer->pixel + y * buffer->pitch + x * sizeof(rtgui_color_t));
+    }
+    else if (blitter->dc->type != RTGUI_DC_HW && blitter->dc->type != RTGUI_DC_CLIENT)
+    {
+        /* an off-screen dc without read back, composite on its background */
+        return RTGUI_DC_BC(blitter->dc);
+    }
+
+    hw_driver = rtgui_dc_get_driver(blitter->dc);
+    x += blitter->ox;
+    y += blitter->oy;
+    if (x < 0 || y < 0 || x >= hw_driver->width || y >= hw_driver->height)
+        return RTGUI_DC_BC(blitter->dc);
+
+    hw_driver->ops->get_pixel(&color, x, y);
+    return color;
+}
+
+/* write line[start, end) to (x + start, y) of dc */
+static void _png_blitter_write(struct png_blitter *blitter, int start, int end, int x, int y)
+{
+    int index;
+    rt_uint16_t *pixel;
+    rtgui_color_t *line = blitter->line;
+
+    switch (blitter->pixel_format)
+    {
+    case RTGRAPHIC_PIXEL_FORMAT_RGB565:
+        pixel = (rt_uint16_t *)blitter->pixels;
+        for (index = start; index < end; index ++)
+            *pixel++ = rtgui_color_to_565(line[index]);
+        blitter->dc->engine->blit_line(blitter->dc, x + start, x + end, y, blitter->pixels);
+        break;
+
+    case RTGRAPHIC_PIXEL_FORMAT_RGB565P:
+        pixel = (rt_uint16_t *)blitter->pixels;
+        for (index = start; index < end; index ++)
+            *pixel++ = rtgui_color_to_565p(line[index]);
+        blitter->dc->engine->blit_line(blitter->dc, x + start, x + end, y, blitter->pixels);
+        break;
+
+    case RTGRAPHIC_PIXEL_FORMAT_ARGB888:
+        blitter->dc->engine->blit_line(blitter->dc, x + start, x + end, y, (rt_uint8_t *)&line[start]);
+        break;
+
+    default:
+        for (index = start; index < end; index ++)
+            rtgui_dc_draw_color_point(blitter->dc, x + index, y, line[index]);
+        break;
+    }
+}
+
+/* composite a row of w premultiplied pixels to (x, y) of dc */
+static void _png_blitter_row(struct png_blitter *blitter, const rtgui_color_t *src, int x, int y, int w)
+{
+    int index, start;
+    rt_uint32_t alpha;
+    rtgui_color_t c, d;
+    rtgui_color_t *line = blitter->line;
+
+    index = 0;
+    while (index < w)
+    {
+        /* skip the transparent run */
+        while (index < w && RTGUI_RGB_A(src[index]) == 0) index ++;
+        if (index == w) break;
+
+        start = index;
+        for (; index < w; index ++)
+        {
+            c = src[index];
+            alpha = RTGUI_RGB_A(c);
+            if (alpha == 255)
+            {
+                line[index] = c;
+            }
+            else if (alpha == 0)
+            {
+                break;
+            }
+            else
+            {
+                alpha = 255 - alpha;
+                d = _png_blitter_read(blitter, x + index, y);
+                line[index] = RTGUI_RGB(RTGUI_RGB_R(c) + _png_mul_div255(RTGUI_RGB_R(d), alpha),
+                                        RTGUI_RGB_G(c) + _png_mul_div255(RTGUI_RGB_G(d), alpha),
+                                        RTGUI_RGB_B(c) + _png_mul_div255(RTGUI_RGB_B(d), alpha));
+            }
+        }
+
+        _png_blitter_write(blitter, start, index, x, y);
+    }
+}
+
 static void rtgui_image_png_blit(struct rtgui_image *image, struct rtgui_dc *dc, struct rtgui_rect *rect)
 {
-    struct rtgui_graphic_driver *hwdev = rtgui_graphic_get_device();
-    rt_uint16_t x, y, w, h;
+    rt_uint16_t y, w, h;
     rtgui_color_t *ptr;
     struct rtgui_image_png *png;
-    int fg_maxsample;
-    int ialpha;
-    float alpha;
-    rtgui_color_t color;
-    rtgui_color_t c, bgcolor;
-    int fc[3], bc[3];
+    struct png_blitter blitter;
 
     RT_ASSERT(image != RT_NULL && dc != RT_NULL && rect != RT_NULL);
     RT_ASSERT(image->data != RT_NULL);
@@ -266,109 +448,39 @@ static void rtgui_image_png_blit(struct rtgui_image *image, struct rtgui_dc *dc,
     if (image->h < rtgui_rect_height(*rect)) h = image->h;
     else h = rtgui_rect_height(*rect);
 
-    fg_maxsample = (1 << png->info_ptr->bit_depth) - 1;
+    if (_png_blitter_init(&blitter, dc, w) == RT_FALSE) return;
 
     if (png->pixels != RT_NULL)
     {
         ptr = (rtgui_color_t *)png->pixels;
-        bgcolor = rtgui_color_from_565(RTGUI_DC_BC(dc));
-        bc[0] = RTGUI_RGB_R(bgcolor);
-        bc[1] = RTGUI_RGB_G(bgcolor);
-        bc[2] = RTGUI_RGB_B(bgcolor);
-        /* draw each point within dc */
+        /* composite each row within dc */
         for (y = 0; y < h; y ++)
         {
-            for (x = 0; x < w; x++)
-            {
-                c = *ptr;
-                ialpha = RTGUI_RGB_A(c);
-                if (ialpha == 0)
-                {
-                    /*
-                     * Foreground image is transparent hear.
-                     * If the background image is already in the frame
-                     * buffer, there is nothing to do.
-                     */
-                }
-                else if (ialpha == fg_maxsample)
-                {
-                    /*
-                     * Copy foreground pixel to frame buffer.
-                     */
-                    rtgui_dc_draw_color_point(dc, x + rect->x1, y + rect->y1, c);
-                }
-                else
-                {
-                    /* output = alpha * foreground + (1-alpha) * background */
-                    /*
-                     * Compositing is necessary.
-                     * Get floating-point alpha and its complement.
-                     * Note: alpha is always linear: gamma does not
-                     * affect it.
-                     */
-                    fc[0] = RTGUI_RGB_R(c);
-                    fc[1] = RTGUI_RGB_G(c);
-                    fc[2] = RTGUI_RGB_B(c);
-
-                    alpha = (float) ialpha / fg_maxsample;
-                    color = RTGUI_RGB((rt_uint8_t)(fc[0] * alpha + bc[0] * (1 - alpha)),
-                                      (rt_uint8_t)(fc[1] * alpha + bc[1] * (1 - alpha)),
-                                      (rt_uint8_t)(fc[2] * alpha + bc[2] * (1 - alpha)));
-                    rtgui_dc_draw_color_point(dc, x + rect->x1, y + rect->y1, color);
-                }
-                /* move to next color buffer */
-                ptr ++;
-            }
+            _png_blitter_row(&blitter, ptr, rect->x1, rect->y1 + y, w);
+            ptr += image->w;
         }
     }
     else
     {
         png_bytep row;
-        png_bytep data;
 
         row = (png_bytep) rtgui_malloc(png_get_rowbytes(png->png_ptr, png->info_ptr));
-        if (row == RT_NULL) return ;
-
-        switch (png->info_ptr->color_type)
+        ptr = (rtgui_color_t *) rtgui_malloc(image->w * sizeof(rtgui_color_t));
+        if (row != RT_NULL && ptr != RT_NULL)
         {
-        case PNG_COLOR_TYPE_RGBA:
-            for (y = 0; y < h; y++)
-            {
-                png_read_row(png->png_ptr, row, png_bytep_NULL);
-                for (x = 0; x < w; x++)
-                {
-                    data = &(row[x * 4]);
-                    if (data[3] != 0)
-                    {
-                        rtgui_dc_draw_color_point(dc, x + rect->x1, y + rect->y1,
-                                                  RTGUI_ARGB(data[3], data[0], data[1], data[2]));
-                    }
-                }
-            }
-
-            break;
-
-        case PNG_COLOR_TYPE_PALETTE:
             for (y = 0; y < h; y++)
             {
                 png_read_row(png->png_ptr, row, png_bytep_NULL);
-                for (x = 0; x < w; x++)
-                {
-                    data = &(row[x]);
-
-                    rtgui_dc_draw_color_point(dc, x + rect->x1, y + rect->y1,
-                                              RTGUI_ARGB(0, png->info_ptr->palette[data[0]].red,
-                                                         png->info_ptr->palette[data[0]].green,
-                                                         png->info_ptr->palette[data[0]].blue));
-                }
+                _png_convert_row(png->info_ptr, row, ptr, image->w);
+                _png_blitter_row(&blitter, ptr, rect->x1, rect->y1 + y, w);
             }
+        }
 
-        default:
-            break;
-        };
-
-        rtgui_free(row);
+        if (row != RT_NULL) rtgui_free(row);
+        if (ptr != RT_NULL) rtgui_free(ptr);
     }
+
+    _png_blitter_fini(&blitter);
 }
 
 void rtgui_image_png_init()
@@ -137,6 +137,42 @@ static void _pixel_rgb888_draw_vline(rtgui_color_t *c, int x, int y1, int y2)
     gfx_device_ops->draw_vline((char *)&pixel, x, y1, y2);
 }
 
+static void _pixel_mono_draw_hspans(rtgui_color_t *c, const struct rtgui_span *spans, int count)
+{
+    rt_uint8_t pixel;
+
+    pixel = rtgui_color_to_mono(*c);
+    for (; count > 0; count --, spans ++)
+        gfx_device_ops->draw_hline((char *)&pixel, spans->x1, spans->x2, spans->y);
+}
+
+static void _pixel_rgb565p_draw_hspans(rtgui_color_t *c, const struct rtgui_span *spans, int count)
+{
+    rt_uint16_t pixel;
+
+    pixel = rtgui_color_to_565p(*c);
+    for (; count > 0; count --, spans ++)
+        gfx_device_ops->draw_hline((char *)&pixel, spans->x1, spans->x2, spans->y);
+}
+
+static void _pixel_rgb565_draw_hspans(rtgui_color_t *c, const struct rtgui_span *spans, int count)
+{
+    rt_uint16_t pixel;
+
+    pixel = rtgui_color_to_565(*c);
+    for (; count > 0; count --, spans ++)
+        gfx_device_ops->draw_hline((char *)&pixel, spans->x1, spans->x2, spans->y);
+}
+
+static void _pixel_rgb888_draw_hspans(rtgui_color_t *c, const struct rtgui_span *spans, int count)
+{
+    rt_uint32_t pixel;
+
+    pixel = rtgui_color_to_888(*c);
+    for (; count > 0; count --, spans ++)
+        gfx_device_ops->draw_hline((char *)&pixel, spans->x1, spans->x2, spans->y);
+}
+
 static void _pixel_draw_raw_hline(rt_uint8_t *pixels, int x1, int x2, int y)
 {
     if (x2 > x1)
@@ -153,6 +189,7 @@ const struct rtgui_graphic_driver_ops _pixel_mono_ops =
     _pixel_mono_draw_hline,
     _pixel_mono_draw_vline,
     _pixel_draw_raw_hline,
+    _pixel_mono_draw_hspans,
 };
 
 const struct rtgui_graphic_driver_ops _pixel_rgb565p_ops =
@@ -162,6 +199,7 @@ const struct rtgui_graphic_driver_ops _pixel_rgb565p_ops =
     _pixel_rgb565p_draw_hline,
     _pixel_rgb565p_draw_vline,
     _pixel_draw_raw_hline,
+    _pixel_rgb565p_draw_hspans,
 };
 
 const struct rtgui_graphic_driver_ops _pixel_rgb565_ops =
@@ -171,6 +209,7 @@ const struct rtgui_graphic_driver_ops _pixel_rgb565_ops =
     _pixel_rgb565_draw_hline,
     _pixel_rgb565_draw_vline,
     _pixel_draw_raw_hline,
+    _pixel_rgb565_draw_hspans,
 };
 
 const struct rtgui_graphic_driver_ops _pixel_rgb888_ops =
@@ -180,6 +219,7 @@ const struct rtgui_graphic_driver_ops _pixel_rgb888_ops =
     _pixel_rgb888_draw_hline,
     _pixel_rgb888_draw_vline,
     _pixel_draw_raw_hline,
+    _pixel_rgb888_draw_hspans,
 };
 
 const struct rtgui_graphic_driver_ops *rtgui_pixel_device_get_ops(int pixel_format)
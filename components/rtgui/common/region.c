@@ -120,8 +120,263 @@ static rtgui_region_status_t rtgui_break(rtgui_region_t *pReg);
         ((r1)->y1 >= (r2)->y1) && \
         ((r1)->y2 <= (r2)->y2) )
 
-#define allocData(n) rtgui_malloc(PIXREGION_SZOF(n))
-#define freeData(reg) if ((reg)->data && (reg)->data->size) rtgui_free((reg)->data)
+#define allocData(n) _region_data_alloc(n)
+#define freeData(reg) if ((reg)->data && (reg)->data->size) _region_data_free((reg)->data)
+
+/*
+ * Region data pool
+ *
+ * The data of region is allocated in the size classes of 1, 4, 16 and 64
+ * rectangles. The blocks of each class are carved from slabs and recycled
+ * through a free list, so the alloc/free done by nearly every region
+ * operation does not fragment the heap. The size field of data is the
+ * capacity of its class, which tells where to free it. Data bigger than
+ * the largest class is allocated from heap directly.
+ */
+#ifdef RTGUI_USING_REGION_POOL
+#define REGION_POOL_CLASSES     4
+
+struct region_pool_block
+{
+    struct region_pool_block *next;
+};
+
+static const rt_uint16_t _region_pool_rects[REGION_POOL_CLASSES] = {1, 4, 16, 64};
+static struct region_pool_block *_region_pool_free[REGION_POOL_CLASSES];
+static struct rtgui_region_pool_info _region_pool_info;
+
+static int _region_pool_class(rt_uint32_t n)
+{
+    int index;
+
+    for (index = 0; index < REGION_POOL_CLASSES; index ++)
+    {
+        if (n <= _region_pool_rects[index])
+            break;
+    }
+
+    return index;
+}
+
+static rt_bool_t _region_pool_grow(int index)
+{
+    rt_uint8_t *slab;
+    rt_size_t block_size;
+    int count, i;
+    struct region_pool_block *block;
+
+    block_size = RT_ALIGN(PIXREGION_SZOF(_region_pool_rects[index]), sizeof(void *));
+    count = RTGUI_REGION_POOL_SLAB_SIZE / block_size;
+    if (count == 0) count = 1;
+
+    /* the slabs are never given back to heap */
+    slab = (rt_uint8_t *)rtgui_malloc(count * block_size);
+    if (slab == RT_NULL) return RT_FALSE;
+
+    rtgui_enter_critical();
+    for (i = 0; i < count; i ++)
+    {
+        block = (struct region_pool_block *)(slab + i * block_size);
+        block->next = _region_pool_free[index];
+        _region_pool_free[index] = block;
+    }
+    _region_pool_info.free[index] += count;
+    _region_pool_info.slab_size += count * block_size;
+    rtgui_exit_critical();
+
+    return RT_TRUE;
+}
+
+static rtgui_region_data_t *_region_data_alloc(rt_uint32_t n)
+{
+    int index;
+    rtgui_region_data_t *data;
+    struct region_pool_block *block;
+
+    index = _region_pool_class(n);
+    if (index == REGION_POOL_CLASSES)
+    {
+        data = (rtgui_region_data_t *)rtgui_malloc(PIXREGION_SZOF(n));
+        if (data == RT_NULL) return RT_NULL;
+
+        rtgui_enter_critical();
+        _region_pool_info.heap_used ++;
+        _region_pool_info.heap_size += PIXREGION_SZOF(n);
+        rtgui_exit_critical();
+
+        data->size = n;
+        return data;
+    }
+
+    while (1)
+    {
+        rtgui_enter_critical();
+        block = _region_pool_free[index];
+        if (block != RT_NULL)
+        {
+            _region_pool_free[index] = block->next;
+            _region_pool_info.free[index] --;
+            _region_pool_info.used[index] ++;
+        }
+        rtgui_exit_critical();
+
+        if (block != RT_NULL) break;
+        if (_region_pool_grow(index) == RT_FALSE) return RT_NULL;
+    }
+
+    data = (rtgui_region_data_t *)block;
+    data->size = _region_pool_rects[index];
+    return data;
+}
+
+static void _region_data_free(rtgui_region_data_t *data)
+{
+    int index;
+    struct region_pool_block *block;
+
+    index = _region_pool_class(data->size);
+    if (index == REGION_POOL_CLASSES)
+    {
+        rtgui_enter_critical();
+        _region_pool_info.heap_used --;
+        _region_pool_info.heap_size -= PIXREGION_SZOF(data->size);
+        rtgui_exit_critical();
+
+        rtgui_free(data);
+        return;
+    }
+
+    RT_ASSERT(data->size == _region_pool_rects[index]);
+
+    block = (struct region_pool_block *)data;
+    rtgui_enter_critical();
+    block->next = _region_pool_free[index];
+    _region_pool_free[index] = block;
+    _region_pool_info.free[index] ++;
+    _region_pool_info.used[index] --;
+    rtgui_exit_critical();
+}
+
+/*
+ * Scratch arena for the temporary data inside one region operation. The
+ * allocations bump a pointer in a static buffer and are released all at
+ * once by resetting it. Only one operation owns the arena at a time, the
+ * others and the allocations beyond the buffer fall back to heap.
+ */
+static rt_ubase_t _region_scratch[RTGUI_REGION_SCRATCH_SIZE / sizeof(rt_ubase_t)];
+static rt_size_t _region_scratch_top;
+static rt_bool_t _region_scratch_busy = RT_FALSE;
+
+static rt_bool_t _region_scratch_begin(void)
+{
+    rt_bool_t owner = RT_FALSE;
+
+    rtgui_enter_critical();
+    if (_region_scratch_busy == RT_FALSE)
+    {
+        _region_scratch_busy = RT_TRUE;
+        _region_scratch_top = 0;
+        owner = RT_TRUE;
+    }
+    rtgui_exit_critical();
+
+    return owner;
+}
+
+static void *_region_scratch_alloc(rt_bool_t owner, rt_size_t size)
+{
+    void *ptr;
+
+    size = RT_ALIGN(size, sizeof(rt_ubase_t));
+    if (owner == RT_TRUE && _region_scratch_top + size <= sizeof(_region_scratch))
+    {
+        ptr = (rt_uint8_t *)_region_scratch + _region_scratch_top;
+        _region_scratch_top += size;
+        _region_pool_info.scratch_hit ++;
+        if (_region_scratch_top > _region_pool_info.scratch_max)
+            _region_pool_info.scratch_max = _region_scratch_top;
+
+        return ptr;
+    }
+
+    _region_pool_info.scratch_miss ++;
+    return rtgui_malloc(size);
+}
+
+static void _region_scratch_free(void *ptr)
+{
+    /* the memory in arena is released when the operation ends */
+    if ((rt_uint8_t *)ptr >= (rt_uint8_t *)_region_scratch &&
+            (rt_uint8_t *)ptr < (rt_uint8_t *)_region_scratch + sizeof(_region_scratch))
+        return;
+
+    rtgui_free(ptr);
+}
+
+static void _region_scratch_end(rt_bool_t owner)
+{
+    if (owner == RT_TRUE)
+    {
+        rtgui_enter_critical();
+        _region_scratch_top = 0;
+        _region_scratch_busy = RT_FALSE;
+        rtgui_exit_critical();
+    }
+}
+
+void rtgui_region_pool_info(struct rtgui_region_pool_info *info)
+{
+    RT_ASSERT(info != RT_NULL);
+
+    rtgui_enter_critical();
+    *info = _region_pool_info;
+    rtgui_exit_critical();
+}
+RTM_EXPORT(rtgui_region_pool_info);
+
+#else
+static rtgui_region_data_t *_region_data_alloc(rt_uint32_t n)
+{
+    rtgui_region_data_t *data;
+
+    data = (rtgui_region_data_t *)rtgui_malloc(PIXREGION_SZOF(n));
+    if (data != RT_NULL)
+        data->size = n;
+
+    return data;
+}
+
+#define _region_data_free(data)             rtgui_free(data)
+
+#define _region_scratch_begin()             RT_FALSE
+#define _region_scratch_alloc(owner, size)  rtgui_malloc(size)
+#define _region_scratch_free(ptr)           rtgui_free(ptr)
+#define _region_scratch_end(owner)
+#endif
+
+/* move the rectangles of data to a new data of n rectangles at least */
+static rtgui_region_data_t *_region_data_resize(rtgui_region_data_t *data, rt_uint32_t n)
+{
+    rtgui_region_data_t *new_data;
+
+#ifdef RTGUI_USING_REGION_POOL
+    /* the data is in the same class already */
+    if (_region_pool_class(n) == _region_pool_class(data->size) &&
+            _region_pool_class(n) != REGION_POOL_CLASSES)
+        return data;
+#endif
+
+    RT_ASSERT(data->numRects <= n);
+
+    new_data = _region_data_alloc(n);
+    if (new_data == RT_NULL) return RT_NULL;
+
+    new_data->numRects = data->numRects;
+    rt_memcpy(new_data + 1, data + 1, data->numRects * sizeof(rtgui_rect_t));
+    _region_data_free(data);
+
+    return new_data;
+}
 
 #define RECTALLOC_BAIL(pReg,n,bail) \
 if (!(pReg)->data || (((pReg)->data->numRects + (n)) > (pReg)->data->size)) \
@@ -157,10 +412,9 @@ if (!(pReg)->data || (((pReg)->data->numRects + (n)) > (pReg)->data->size)) \
 if (((numRects) < ((reg)->data->size >> 1)) && ((reg)->data->size > 50)) \
 {                                    \
     rtgui_region_data_t * NewData;                           \
-    NewData = (rtgui_region_data_t *)rt_realloc((reg)->data, PIXREGION_SZOF(numRects));  \
+    NewData = _region_data_resize((reg)->data, numRects);    \
     if (NewData)                             \
     {                                    \
-    NewData->size = (numRects);                  \
     (reg)->data = NewData;                       \
     }                                    \
 }
@@ -238,11 +492,10 @@ static rtgui_region_status_t rtgui_rect_alloc(rtgui_region_t *region, int n)
                 n = 250;
         }
         n += region->data->numRects;
-        data = (rtgui_region_data_t *)rt_realloc(region->data, PIXREGION_SZOF(n));
+        data = _region_data_resize(region->data, n);
         if (!data) return rtgui_break(region);
         region->data = data;
     }
-    region->data->size = n;
     return RTGUI_REGION_STATUS_SUCCESS;
 }
 
@@ -264,7 +517,6 @@ rtgui_region_status_t rtgui_region_copy(rtgui_region_t *dst, rtgui_region_t *src
         freeData(dst);
         dst->data = allocData(src->data->numRects);
         if (!dst->data) return rtgui_break(dst);
-        dst->data->size = src->data->numRects;
     }
     dst->data->numRects = src->data->numRects;
     rt_memmove((char *)PIXREGION_BOXPTR(dst), (char *)PIXREGION_BOXPTR(src),
@@ -686,7 +938,7 @@ rtgui_op(
     }
 
     if (oldData)
-        rtgui_free(oldData);
+        _region_data_free(oldData);
 
     numRects = newReg->data->numRects;
     if (!numRects)
@@ -1320,6 +1572,7 @@ rtgui_region_status_t rtgui_region_validate(rtgui_region_t *badreg,
     rtgui_rect_t   *box;        /* Current box in rects         */
     rtgui_rect_t   *riBox;      /* Last box in ri[j].reg            */
     rtgui_region_t   *hreg;       /* ri[j_half].reg             */
+    rt_bool_t scratch;  /* ri is in scratch arena          */
     rtgui_region_status_t ret = RTGUI_REGION_STATUS_SUCCESS;
 
     *pOverlap = RTGUI_REGION_STATUS_FAILURE;
@@ -1358,8 +1611,13 @@ rtgui_region_status_t rtgui_region_validate(rtgui_region_t *badreg,
 
     /* Set up the first region to be the first rectangle in badreg */
     /* Note that step 2 code will never overflow the ri[0].reg rects array */
-    ri = (RegionInfo *) rtgui_malloc(4 * sizeof(RegionInfo));
-    if (!ri) return rtgui_break(badreg);
+    scratch = _region_scratch_begin();
+    ri = (RegionInfo *) _region_scratch_alloc(scratch, 4 * sizeof(RegionInfo));
+    if (!ri)
+    {
+        _region_scratch_end(scratch);
+        return rtgui_break(badreg);
+    }
     sizeRI = 4;
     numRI = 1;
     ri[0].prevBand = 0;
@@ -1421,9 +1679,11 @@ rtgui_region_status_t rtgui_region_validate(rtgui_region_t *badreg,
         {
             /* Oops, allocate space for new region information */
             sizeRI <<= 1;
-            rit = (RegionInfo *) rt_realloc(ri, sizeRI * sizeof(RegionInfo));
+            rit = (RegionInfo *) _region_scratch_alloc(scratch, sizeRI * sizeof(RegionInfo));
             if (!rit)
                 goto bail;
+            rt_memcpy(rit, ri, numRI * sizeof(RegionInfo));
+            _region_scratch_free(ri);
             ri = rit;
             rit = &ri[numRI];
         }
@@ -1478,14 +1738,16 @@ NextRect:
         numRI -= half;
     }
     *badreg = ri[0].reg;
-    rtgui_free(ri);
+    _region_scratch_free(ri);
+    _region_scratch_end(scratch);
     good(badreg);
     return ret;
 
 bail:
     for (i = 0; i < numRI; i++)
         freeData(&ri[i].reg);
-    rtgui_free(ri);
+    _region_scratch_free(ri);
+    _region_scratch_end(scratch);
 
     return rtgui_break(badreg);
 }
@@ -17,6 +17,9 @@
 #include <rtgui/rtgui_app.h>
 #include <rtgui/widgets/window.h>
 
+/* all of the applications, used for the statistics of event queue */
+static rt_list_t _rtgui_app_list = {&_rtgui_app_list, &_rtgui_app_list};
+
 static void _rtgui_app_constructor(struct rtgui_app *app)
 {
     /* set event handler */
@@ -33,12 +36,27 @@ static void _rtgui_app_constructor(struct rtgui_app *app)
     app->mq             = RT_NULL;
     app->main_object    = RT_NULL;
     app->on_idle        = RT_NULL;
+
+    app->tail_type      = 0;
+    app->tail_wid       = RT_NULL;
+    app->motion_queued  = RT_FALSE;
+    app->mq_peak        = 0;
+    app->event_merged   = 0;
+    app->event_dropped  = 0;
+
+    rt_enter_critical();
+    rt_list_insert_before(&_rtgui_app_list, &(app->list));
+    rt_exit_critical();
 }
 
 static void _rtgui_app_destructor(struct rtgui_app *app)
 {
     RT_ASSERT(app != RT_NULL);
 
+    rt_enter_critical();
+    rt_list_remove(&(app->list));
+    rt_exit_critical();
+
     rt_free(app->name);
     app->name = RT_NULL;
 }
@@ -382,3 +400,29 @@ void rtgui_app_set_main_win(struct rtgui_app *app, struct rtgui_win *win)
     app->main_object = RTGUI_OBJECT(win);
 }
 RTM_EXPORT(rtgui_app_set_main_win);
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+void list_guievent(void)
+{
+    struct rtgui_app *app;
+    struct rt_list_node *node;
+
+    rt_kprintf("app      entry peak max  merged     dropped\n");
+    rt_kprintf("-------- ----- ---- ---- ---------- ----------\n");
+
+    rt_enter_critical();
+    for (node = _rtgui_app_list.next; node != &_rtgui_app_list; node = node->next)
+    {
+        app = rt_list_entry(node, struct rtgui_app, list);
+        if (app->mq == RT_NULL || app->name == RT_NULL)
+            continue;
+
+        rt_kprintf("%-8.8s %5d %4d %4d %10d %10d\n", app->name,
+                   app->mq->entry, app->mq_peak, app->mq->max_msgs,
+                   app->event_merged, app->event_dropped);
+    }
+    rt_exit_critical();
+}
+FINSH_FUNCTION_EXPORT(list_guievent, display the event queue statistics of applications);
+#endif
@@ -308,11 +308,32 @@ void rtgui_free(void *ptr)
 }
 RTM_EXPORT(rtgui_free);
 
-#if defined(RTGUI_MEM_TRACE) && defined(RT_USING_FINSH)
+#if (defined(RTGUI_MEM_TRACE) || defined(RTGUI_USING_REGION_POOL)) && defined(RT_USING_FINSH)
 #include <finsh.h>
 void list_guimem(void)
 {
+#ifdef RTGUI_USING_REGION_POOL
+    int index;
+    struct rtgui_region_pool_info info;
+    const int rects[] = {1, 4, 16, 64};
+#endif
+
+#ifdef RTGUI_MEM_TRACE
     rt_kprintf("Current Used: %d, Maximal Used: %d\n", mem_info.allocated_size, mem_info.max_allocated);
+#endif
+
+#ifdef RTGUI_USING_REGION_POOL
+    rtgui_region_pool_info(&info);
+    rt_kprintf("region pool, slab: %d bytes\n", info.slab_size);
+    for (index = 0; index < 4; index ++)
+    {
+        rt_kprintf("  %2d rects: used %d, free %d\n", rects[index],
+                   info.used[index], info.free[index]);
+    }
+    rt_kprintf("  heap: %d data, %d bytes\n", info.heap_used, info.heap_size);
+    rt_kprintf("  scratch: hit %d, miss %d, max %d/%d bytes\n",
+               info.scratch_hit, info.scratch_miss, info.scratch_max, RTGUI_REGION_SCRATCH_SIZE);
+#endif
 }
 FINSH_FUNCTION_EXPORT(list_guimem, display memory information);
 #endif
@@ -552,6 +573,121 @@ static void rtgui_event_dump(struct rtgui_app* app, rtgui_event_t *event)
 /************************************************************************/
 /* RTGUI IPC APIs                                                       */
 /************************************************************************/
+/*
+ * A mouse motion or paint event which is the last one in the message queue
+ * is marked as mergeable. The following motion or paint event of the same
+ * window is merged into it instead of being queued:
+ *  - a paint event repaints the whole window, so the later one is dropped;
+ *  - a motion event stores its position in app->motion, and the receiver
+ *    picks the latest position up when it gets the marked motion.
+ * Any other event breaks the merging, so the order of events is kept and a
+ * button event is never merged nor passed by a motion.
+ */
+#define _RTGUI_EVENT_MERGEABLE  0x8000
+
+static rt_bool_t _rtgui_send_merge(struct rtgui_app *app, rtgui_event_t *event,
+                                   rt_size_t event_size)
+{
+    rt_base_t level;
+    struct rtgui_win *wid = RT_NULL;
+    rt_bool_t mergeable = RT_FALSE;
+
+    if ((event->type == RTGUI_EVENT_MOUSE_MOTION &&
+            event_size == sizeof(struct rtgui_event_mouse)) ||
+            event->type == RTGUI_EVENT_PAINT)
+    {
+        wid = ((struct rtgui_event_win *)event)->wid;
+        mergeable = (event->ack == RT_NULL);
+    }
+
+    level = rt_hw_interrupt_disable();
+    if (mergeable && app->tail_type == event->type && app->tail_wid == wid)
+    {
+        if (event->type == RTGUI_EVENT_MOUSE_MOTION)
+        {
+            app->motion = *(struct rtgui_event_mouse *)event;
+            app->motion.parent.user |= _RTGUI_EVENT_MERGEABLE;
+        }
+        app->event_merged ++;
+        rt_hw_interrupt_enable(level);
+
+        return RT_TRUE;
+    }
+
+    app->tail_type = 0;
+    if (mergeable)
+    {
+        if (event->type == RTGUI_EVENT_PAINT)
+        {
+            app->tail_type = RTGUI_EVENT_PAINT;
+        }
+        else if (app->motion_queued == RT_FALSE)
+        {
+            /* only one motion in the queue can refer to app->motion */
+            app->motion = *(struct rtgui_event_mouse *)event;
+            app->motion.parent.user |= _RTGUI_EVENT_MERGEABLE;
+            app->motion_queued = RT_TRUE;
+            app->tail_type = RTGUI_EVENT_MOUSE_MOTION;
+        }
+
+        if (app->tail_type != 0)
+        {
+            app->tail_wid = wid;
+            event->user |= _RTGUI_EVENT_MERGEABLE;
+        }
+    }
+    rt_hw_interrupt_enable(level);
+
+    return RT_FALSE;
+}
+
+static void _rtgui_send_done(struct rtgui_app *app, rtgui_event_t *event, rt_err_t result)
+{
+    rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+    if (result == RT_EOK)
+    {
+        if (app->mq->entry > app->mq_peak)
+            app->mq_peak = app->mq->entry;
+    }
+    else
+    {
+        app->event_dropped ++;
+        if (event->user & _RTGUI_EVENT_MERGEABLE)
+        {
+            if (event->type == RTGUI_EVENT_MOUSE_MOTION)
+                app->motion_queued = RT_FALSE;
+            app->tail_type = 0;
+        }
+    }
+    rt_hw_interrupt_enable(level);
+
+    /* the event is owned by sender, remove the mark */
+    event->user &= ~_RTGUI_EVENT_MERGEABLE;
+}
+
+static void _rtgui_recv_merge(struct rtgui_app *app, rtgui_event_t *event)
+{
+    rt_base_t level;
+
+    if (!(event->user & _RTGUI_EVENT_MERGEABLE))
+        return;
+
+    level = rt_hw_interrupt_disable();
+    if (event->type == RTGUI_EVENT_MOUSE_MOTION)
+    {
+        /* pick up the latest position merged into this motion */
+        *(struct rtgui_event_mouse *)event = app->motion;
+        app->motion_queued = RT_FALSE;
+    }
+    if (app->tail_type == event->type)
+        app->tail_type = 0;
+    rt_hw_interrupt_enable(level);
+
+    event->user &= ~_RTGUI_EVENT_MERGEABLE;
+}
+
 rt_err_t rtgui_send(struct rtgui_app* app, rtgui_event_t *event, rt_size_t event_size)
 {
     rt_err_t result;
@@ -562,7 +698,11 @@ rt_err_t rtgui_send(struct rtgui_app* app, rtgui_event_t *event, rt_size_t event
 
     rtgui_event_dump(app, event);
 
+    if (_rtgui_send_merge(app, event, event_size) == RT_TRUE)
+        return RT_EOK;
+
     result = rt_mq_send(app->mq, event, event_size);
+    _rtgui_send_done(app, event, result);
     if (result != RT_EOK)
     {
         if (event->type != RTGUI_EVENT_TIMER)
@@ -584,6 +724,7 @@ rt_err_t rtgui_send_urgent(struct rtgui_app* app, rtgui_event_t *event, rt_size_
     rtgui_event_dump(app, event);
 
     result = rt_mq_urgent(app->mq, event, event_size);
+    _rtgui_send_done(app, event, result);
     if (result != RT_EOK)
         rt_kprintf("send ergent event to %s failed\n", app->name);
 
@@ -609,7 +750,10 @@ rt_err_t rtgui_send_sync(struct rtgui_app* app, rtgui_event_t *event, rt_size_t
         goto __return;
 
     event->ack = &ack_mb;
+    /* a sync event breaks the merging of events */
+    _rtgui_send_merge(app, event, event_size);
     r = rt_mq_send(app->mq, event, event_size);
+    _rtgui_send_done(app, event, r);
     if (r != RT_EOK)
     {
         rt_kprintf("send sync event failed\n");
@@ -656,6 +800,8 @@ rt_err_t rtgui_recv(rtgui_event_t *event, rt_size_t event_size)
         return -RT_ERROR;
 
     r = rt_mq_recv(app->mq, event, event_size, RT_WAITING_FOREVER);
+    if (r == RT_EOK)
+        _rtgui_recv_merge(app, event);
 
     return r;
 }
@@ -674,11 +820,48 @@ rt_err_t rtgui_recv_nosuspend(rtgui_event_t *event, rt_size_t event_size)
         return -RT_ERROR;
 
     r = rt_mq_recv(app->mq, event, event_size, 0);
+    if (r == RT_EOK)
+        _rtgui_recv_merge(app, event);
 
     return r;
 }
 RTM_EXPORT(rtgui_recv_nosuspend);
 
+/*
+ * receive at most count events into the array of events, each one takes
+ * event_size bytes. It waits for the first event and then drains the ones
+ * already in the queue without suspending. Returns the number of events.
+ */
+rt_size_t rtgui_recv_batch(rtgui_event_t *events, rt_size_t event_size, rt_size_t count)
+{
+    struct rtgui_app *app;
+    rt_uint8_t *ptr;
+    rt_size_t index;
+    rt_int32_t timeout;
+
+    RT_ASSERT(events != RT_NULL);
+    RT_ASSERT(event_size != 0);
+
+    app = (struct rtgui_app *)(rt_thread_self()->user_data);
+    if (app == RT_NULL)
+        return 0;
+
+    ptr = (rt_uint8_t *)events;
+    timeout = RT_WAITING_FOREVER;
+    for (index = 0; index < count; index ++)
+    {
+        if (rt_mq_recv(app->mq, ptr, event_size, timeout) != RT_EOK)
+            break;
+
+        _rtgui_recv_merge(app, (rtgui_event_t *)ptr);
+        ptr += event_size;
+        timeout = 0;
+    }
+
+    return index;
+}
+RTM_EXPORT(rtgui_recv_batch);
+
 rt_err_t rtgui_recv_filter(rt_uint32_t type, rtgui_event_t *event, rt_size_t event_size)
 {
     struct rtgui_app *app;
@@ -692,6 +875,7 @@ rt_err_t rtgui_recv_filter(rt_uint32_t type, rtgui_event_t *event, rt_size_t eve
 
     while (rt_mq_recv(app->mq, event, event_size, RT_WAITING_FOREVER) == RT_EOK)
     {
+        _rtgui_recv_merge(app, event);
         if (event->type == type)
         {
             return RT_EOK;
@@ -157,5 +157,9 @@ extern const rt_uint8_t* rtgui_blit_expand_byte[9];
 typedef void (*rtgui_blit_line_func)(rt_uint8_t *dst, rt_uint8_t *src, int line);
 rtgui_blit_line_func rtgui_blit_line_get(int dst_bpp, int src_bpp);
 rtgui_blit_line_func rtgui_blit_line_get_inv(int dst_bpp, int src_bpp);
+void rtgui_blit_line_set_word(rt_bool_t enable);
+
+void rtgui_blit_copy_rect(rt_uint8_t *pixels, int pitch, int bpp,
+                          const rtgui_rect_t *rect, int dx, int dy);
 
 #endif
@@ -29,6 +29,8 @@ enum rtgui_dc_type
     RTGUI_DC_HW,
     RTGUI_DC_CLIENT,
     RTGUI_DC_BUFFER,
+    /* off-screen dc in the pixel format of graphic driver, see image_hdc.c */
+    RTGUI_DC_NATIVE,
 };
 
 struct rtgui_dc_engine
@@ -108,9 +110,16 @@ rt_uint8_t *rtgui_dc_buffer_get_pixel(struct rtgui_dc *dc);
 struct rtgui_dc *rtgui_dc_begin_drawing(rtgui_widget_t *owner);
 void rtgui_dc_end_drawing(struct rtgui_dc *dc);
 
+/* the graphic driver which a hw or client dc draws with */
+const struct rtgui_graphic_driver *rtgui_dc_get_driver(struct rtgui_dc *dc);
+
 /* destroy a dc */
 void rtgui_dc_destory(struct rtgui_dc *dc);
 
+/* move the pixels in rect and get the exposed part to be repainted */
+rt_err_t rtgui_dc_scroll(struct rtgui_dc *dc, rtgui_rect_t *rect, int dx, int dy,
+                         rtgui_region_t *exposed);
+
 void rtgui_dc_draw_line(struct rtgui_dc *dc, int x1, int y1, int x2, int y2);
 void rtgui_dc_draw_rect(struct rtgui_dc *dc, struct rtgui_rect *rect);
 void rtgui_dc_fill_rect_forecolor(struct rtgui_dc *dc, struct rtgui_rect *rect);
@@ -17,6 +17,13 @@
 #include <rtgui/list.h>
 #include <rtgui/color.h>
 
+/* horizontal span [x1, x2) on line y */
+struct rtgui_span
+{
+    rt_int16_t x1, x2;
+    rt_int16_t y;
+};
+
 /* graphic driver operations */
 struct rtgui_graphic_driver_ops
 {
@@ -29,6 +36,9 @@ struct rtgui_graphic_driver_ops
 
     /* draw raw hline */
     void (*draw_raw_hline)(rt_uint8_t *pixels, int x1, int x2, int y);
+
+    /* draw a batch of hlines in the same color, could be RT_NULL */
+    void (*draw_hspans)(rtgui_color_t *c, const struct rtgui_span *spans, int count);
 };
 
 /* graphic extension operations */
@@ -45,6 +55,10 @@ struct rtgui_graphic_ext_ops
 
 	void (*draw_ellipse)(rtgui_color_t *c, int x, int y, int rx, int ry);
 	void (*fill_ellipse)(rtgui_color_t *c, int x, int y, int rx, int ry);
+
+	/* copy the pixels in (x1, y1) - (x2, y2) to (x1 + dx, y1 + dy), which
+	 * could overlap, could be RT_NULL */
+	void (*copy_rect)(int x1, int y1, int x2, int y2, int dx, int dy);
 };
 
 struct rtgui_graphic_driver
@@ -70,6 +84,10 @@ struct rtgui_graphic_driver *rtgui_graphic_driver_get_default(void);
 
 void rtgui_graphic_driver_get_rect(const struct rtgui_graphic_driver *driver, rtgui_rect_t *rect);
 void rtgui_graphic_driver_screen_update(const struct rtgui_graphic_driver *driver, rtgui_rect_t *rect);
+void rtgui_graphic_driver_draw_hspans(const struct rtgui_graphic_driver *driver, rtgui_color_t *c,
+                                      const struct rtgui_span *spans, int count);
+rt_err_t rtgui_graphic_driver_copy_rect(const struct rtgui_graphic_driver *driver,
+                                        const rtgui_rect_t *rect, int dx, int dy);
 rt_uint8_t *rtgui_graphic_driver_get_framebuffer(const struct rtgui_graphic_driver *driver);
 rt_uint8_t *rtgui_graphic_driver_get_default_framebuffer(void);
 
@@ -49,19 +49,23 @@ struct rtgui_font_bitmap
 };
 extern const struct rtgui_font_engine bmp_font_engine;
 
-#include <rtgui/tree.h>
-SPLAY_HEAD(cache_tree, hz_cache);
+#include <rtgui/dlist.h>
+#define HZ_CACHE_HASH_SIZE  32
 struct hz_cache
 {
-    SPLAY_ENTRY(hz_cache) hz_node;
+    struct hz_cache *hash_next;
+    struct rtgui_dlist_node lru;
 
     rt_uint16_t hz_id;
 };
 
 struct rtgui_hz_file_font
 {
-    struct cache_tree cache_root;
+    struct hz_cache *cache_hash[HZ_CACHE_HASH_SIZE];
+    /* the most recently used glyph is at the head */
+    struct rtgui_dlist_node cache_lru;
     rt_uint16_t cache_size;
+    rt_uint16_t cache_max;
 
     /* font size */
     rt_uint16_t font_size;
@@ -72,8 +76,73 @@ struct rtgui_hz_file_font
 
     /* font file name */
     const char *font_fn;
+
+    /* statistics */
+    rt_uint32_t hit, miss;
+    rt_uint32_t read_count;
 };
 extern const struct rtgui_font_engine rtgui_hz_file_font_engine;
+void rtgui_hz_file_font_set_cache_size(struct rtgui_font *font, rt_uint16_t count);
+
+/*
+ * HZ font in raw partition of flash. The partition begins with a table of
+ * headers, terminated by a header without magic, and each header describes
+ * the glyphs of one font size.
+ */
+#define HZ_FLASH_MAGIC      0x30465A48  /* "HZF0" */
+struct rtgui_hz_flash_header
+{
+    rt_uint32_t magic;
+    rt_uint16_t font_size;
+    rt_uint16_t data_size;      /* bytes of each glyph */
+
+    /* the range of the first and second byte of code */
+    rt_uint8_t  first_zone, last_zone;
+    rt_uint8_t  first_pos, last_pos;
+
+    rt_uint32_t data_offset;    /* offset of the first glyph in partition */
+};
+
+struct rtgui_hz_flash_font
+{
+    /* the name of raw partition device */
+    const char *device_name;
+    rt_uint16_t font_size;
+
+    rt_device_t device;
+    struct rtgui_hz_flash_header header;
+
+    /* the glyphs loaded by one batch read, protected by lock */
+    struct rt_mutex lock;
+    rt_uint16_t batch_code[RTGUI_HZ_FLASH_BATCH];
+    rt_uint16_t batch_count;
+    rt_uint8_t *batch_buffer;
+
+    rt_uint32_t read_count;
+};
+extern const struct rtgui_font_engine rtgui_hz_flash_font_engine;
+
+/*
+ * Compact HZ font, the subset of glyphs used by UI strings, which is generated
+ * by utils/stract_cjk.py. The glyph is found by a minimal perfect hash of code,
+ * and its pixels are coded by a binary range coder with the probability of the
+ * pixel in the context of its decoded neighbours.
+ */
+struct rtgui_glyph_span;
+struct rtgui_font_compact
+{
+    rt_uint16_t width;
+    rt_uint16_t height;
+    rt_uint16_t count;              /* number of glyphs */
+
+    rt_uint32_t (*hash)(const rt_uint16_t code);
+    const rt_uint8_t  *model;       /* probability of blank pixel in 1/256 of each context */
+    const rt_uint16_t *offset;      /* offset of each glyph in data */
+    const rt_uint8_t  *data;
+};
+extern const struct rtgui_font_engine hz_cmp_font_engine;
+int rtgui_font_compact_decode(const struct rtgui_font_compact *font, rt_uint16_t code,
+                              struct rtgui_glyph_span *spans);
 
 struct rtgui_font
 {
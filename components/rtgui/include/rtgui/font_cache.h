@@ -0,0 +1,91 @@
+/*
+ * File      : font_cache.h
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2006 - 2013, RT-Thread Development Team
+ *
+ * The license and distribution terms for this file may be
+ * found in the file LICENSE in this distribution or at
+ * http://www.rt-thread.org/license/LICENSE
+ */
+#ifndef __RTGUI_FONT_CACHE_H__
+#define __RTGUI_FONT_CACHE_H__
+
+#include <rtgui/rtgui.h>
+#include <rtgui/dlist.h>
+
+struct rtgui_dc;
+
+/* a foreground run [x1, x2) on row y of glyph */
+struct rtgui_glyph_span
+{
+    rt_uint8_t y;
+    rt_uint8_t x1, x2;
+};
+
+/* a glyph expanded into foreground runs */
+struct rtgui_glyph
+{
+    struct rtgui_dlist_node lru;
+    struct rtgui_glyph *hash_next;
+
+    /* cache key */
+    const void *font;
+    rt_uint16_t code;
+
+    rt_uint8_t width, height;
+    rt_uint16_t span_count;
+
+    /* struct rtgui_glyph_span spans[span_count] follows */
+};
+
+/* a 1bpp glyph bitmap, MSB first */
+struct rtgui_glyph_bitmap
+{
+    const rt_uint8_t *data;
+    rt_uint16_t width, height;
+    rt_uint16_t pitch;
+};
+
+struct rtgui_font_cache_stat
+{
+    rt_uint32_t hit;
+    rt_uint32_t miss;
+    rt_uint32_t evict;
+
+    rt_uint32_t used_size;
+    rt_uint32_t max_size;
+};
+
+/* load the bitmap of glyph code of font when it's not in cache */
+typedef rt_bool_t (*rtgui_font_cache_load_t)(const void *font, rt_uint16_t code,
+                                             struct rtgui_glyph_bitmap *bitmap);
+
+/* the maximal number of foreground runs in a glyph */
+#define RTGUI_GLYPH_SPAN_MAX(width, height)     ((((width) + 1) / 2) * (height))
+
+/* decode the glyph code of font into the runs sorted by row when it's not in
+ * cache, spans has room for RTGUI_GLYPH_SPAN_MAX runs. Return the number of
+ * runs, or -1 if there is no such glyph. */
+typedef int (*rtgui_font_cache_decode_t)(const void *font, rt_uint16_t code,
+                                         struct rtgui_glyph_span *spans);
+
+void rtgui_font_cache_init(void);
+void rtgui_font_cache_set_size(rt_uint32_t size);
+void rtgui_font_cache_flush(const void *font);
+void rtgui_font_cache_get_stat(struct rtgui_font_cache_stat *stat);
+/* whether the glyph of code is in cache */
+rt_bool_t rtgui_font_cache_lookup(const void *font, rt_uint16_t code);
+
+/* draw a glyph at the left-top of rect, return RT_FALSE if it can't be cached */
+rt_bool_t rtgui_font_cache_draw(struct rtgui_dc *dc, const void *font, rt_uint16_t code,
+                                rtgui_font_cache_load_t load, struct rtgui_rect *rect);
+/* draw a glyph of width x height decoded by decode at the left-top of rect */
+rt_bool_t rtgui_font_cache_draw_spans(struct rtgui_dc *dc, const void *font, rt_uint16_t code,
+                                      rt_uint8_t width, rt_uint8_t height,
+                                      rtgui_font_cache_decode_t decode, struct rtgui_rect *rect);
+
+/* draw the runs of a glyph of width x height at the left-top of rect */
+void rtgui_glyph_draw_spans(struct rtgui_dc *dc, const struct rtgui_glyph_span *spans, int count,
+                            int width, int height, struct rtgui_rect *rect);
+
+#endif
@@ -21,7 +21,9 @@
 enum rtgui_img_zoom
 {
     RTGUI_IMG_ZOOM_NEAREST,
-    RTGUI_IMG_ZOOM_BILINEAR
+    RTGUI_IMG_ZOOM_BILINEAR,
+    /* average of the covered pixels, for zoom out */
+    RTGUI_IMG_ZOOM_BOX
 };
 
 struct rtgui_image;
@@ -84,8 +86,12 @@ void rtgui_image_register_engine(struct rtgui_image_engine *engine);
 /* blit an image on DC */
 void rtgui_image_blit(struct rtgui_image *image, struct rtgui_dc *dc, struct rtgui_rect *rect);
 struct rtgui_image_palette *rtgui_image_palette_create(rt_uint32_t ncolors);
+/* the image is scaled in the pixel format of graphic driver, its alpha is
+ * flattened on white, or on the background of dc by rtgui_image_zoom_blit */
 rtgui_image_t *rtgui_image_zoom(rtgui_image_t *image, float scalew, float scaleh, rt_uint32_t mode);
 rtgui_image_t *rtgui_image_rotate(rtgui_image_t *image, float angle);
+/* zoom an image into the size of rect and draw it on DC without the zoomed image */
+void rtgui_image_zoom_blit(rtgui_image_t *image, struct rtgui_dc *dc, struct rtgui_rect *rect, rt_uint32_t mode);
 
 #endif
 
@@ -3,6 +3,7 @@
 
 #include <rtgui/rtgui.h>
 #include <rtgui/image.h>
+#include <rtgui/dlist.h>
 
 #ifdef RTGUI_IMAGE_CONTAINER
 /* image item in image container */
@@ -12,16 +13,38 @@ struct rtgui_image_item
     char *filename;
 
     rt_uint32_t refcount;
+    /* the bytes accounted in the budget of container */
+    rt_uint32_t size;
+    /* the node in lru list when it's idle (refcount is zero) */
+    struct rtgui_dlist_node lru;
 };
 typedef struct rtgui_image_item rtgui_image_item_t;
 
+struct rtgui_image_container_stat
+{
+    rt_uint32_t hit;
+    rt_uint32_t miss;
+    rt_uint32_t evict;
+    rt_uint32_t prefetch;
+
+    /* the bytes of all images, of idle images and the budget */
+    rt_uint32_t used_size;
+    rt_uint32_t cached_size;
+    rt_uint32_t max_size;
+};
+
 void rtgui_system_image_container_init(rt_bool_t load);
 #ifdef RTGUI_USING_DFS_FILERW
 rtgui_image_item_t *rtgui_image_container_get(const char *filename);
+rt_bool_t rtgui_image_container_prefetch(const char *filename);
 #endif
-rtgui_image_item_t *rtgui_image_container_get_from_mem(const rt_uint8_t *mem, const char *type, rt_uint32_t len);
+rtgui_image_item_t *rtgui_image_container_get_memref(const char *type, const rt_uint8_t *memory, rt_uint32_t length);
 
 void rtgui_image_container_put(rtgui_image_item_t *item);
+
+void rtgui_image_container_set_size(rt_uint32_t size);
+void rtgui_image_container_flush(void);
+void rtgui_image_container_get_stat(struct rtgui_image_container_stat *stat);
 #endif
 
 #endif
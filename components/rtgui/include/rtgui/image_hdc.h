@@ -28,6 +28,16 @@ struct rtgui_image_hdcmm
 };
 
 void rtgui_image_hdc_init(void);
+
+/* convert image into the pixel format of graphic driver */
+struct rtgui_image *rtgui_image_hdc_convert(struct rtgui_image *image, rtgui_color_t background);
+struct rtgui_image *rtgui_image_hdc_alloc(rt_uint16_t w, rt_uint16_t h);
+rt_uint8_t *rtgui_image_hdc_get_pixels(struct rtgui_image *image, rt_uint16_t *pitch);
+#ifdef RTGUI_USING_DFS_FILERW
+rt_bool_t rtgui_image_hdc_save(struct rtgui_image *image, const char *filename);
+struct rtgui_image *rtgui_image_hdc_create_native(const char *filename, const char *hdc_filename,
+                                                  rtgui_color_t background);
+#endif
 extern const struct rtgui_image_engine rtgui_image_hdcmm_engine;
 
 #define HDC_HEADER_SIZE     (5 * 4)
@@ -5,4 +5,10 @@
 
 void rtgui_image_jpeg_init(void);
 
+#ifdef RTGUI_USING_DFS_FILERW
+/* create a jpeg image scaled down to fit in max_w x max_h */
+struct rtgui_image *rtgui_image_jpeg_create_fit(const char *filename, rt_uint16_t max_w, rt_uint16_t max_h,
+                                                rt_bool_t load);
+#endif
+
 #endif
@@ -79,6 +79,23 @@ rtgui_rect_t *rtgui_region_extents(rtgui_region_t *region);
 rtgui_region_status_t rtgui_region_append(rtgui_region_t *dest, rtgui_region_t *region);
 rtgui_region_status_t rtgui_region_validate(rtgui_region_t *badreg, int *pOverlap);
 
+#ifdef RTGUI_USING_REGION_POOL
+/* statistics of region data pool */
+struct rtgui_region_pool_info
+{
+    rt_uint32_t used[4];        /* blocks in use of the class of 1, 4, 16, 64 rects */
+    rt_uint32_t free[4];        /* blocks in free list of each class */
+    rt_uint32_t slab_size;      /* bytes of slabs allocated from heap */
+    rt_uint32_t heap_used;      /* data bigger than the largest class */
+    rt_uint32_t heap_size;      /* bytes of them */
+    rt_uint32_t scratch_hit;    /* allocations served by scratch arena */
+    rt_uint32_t scratch_miss;   /* allocations fell back to heap */
+    rt_uint32_t scratch_max;    /* maximal bytes used in scratch arena */
+};
+
+void rtgui_region_pool_info(struct rtgui_region_pool_info *info);
+#endif
+
 void rtgui_region_reset(rtgui_region_t *region, rtgui_rect_t *rect);
 void rtgui_region_empty(rtgui_region_t *region);
 void rtgui_region_dump(rtgui_region_t *region);
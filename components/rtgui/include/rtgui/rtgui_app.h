@@ -64,6 +64,20 @@ struct rtgui_app
 
     /* on idle event handler */
     rtgui_idle_func_t on_idle;
+
+    /* the mergeable event at the tail of message queue, see rtgui_send */
+    rt_uint16_t tail_type;
+    struct rtgui_win *tail_wid;
+    /* the latest position of the mouse motion waiting in message queue */
+    rt_bool_t motion_queued;
+    struct rtgui_event_mouse motion;
+
+    /* the statistics of message queue */
+    rt_uint16_t mq_peak;
+    rt_uint32_t event_merged;
+    rt_uint32_t event_dropped;
+
+    rt_list_t list;
 };
 
 /**
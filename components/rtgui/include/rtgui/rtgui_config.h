@@ -35,6 +35,45 @@
 #define RTGUI_SVR_THREAD_STACK_SIZE     2048
 #endif
 
+/* the maximal ticks a screen update could be deferred in server */
+#ifndef RTGUI_SERVER_UPDATE_LATENCY
+#define RTGUI_SERVER_UPDATE_LATENCY     (RT_TICK_PER_SECOND / 60)
+#endif
+/* flush the extents when damage region has more rects */
+#define RTGUI_SERVER_UPDATE_RECTS_MAX   8
+
+/* the memory budget of glyph cache, 0 to disable it */
+#ifndef RTGUI_FONT_CACHE_SIZE
+#define RTGUI_FONT_CACHE_SIZE           (16 * 1024)
+#endif
+
+/* the default number of glyphs cached by each HZ file font */
+#ifndef RTGUI_HZ_FILE_CACHE_MAX
+#define RTGUI_HZ_FILE_CACHE_MAX         64
+#endif
+/* the maximal bytes of one coalesced read of HZ file font */
+#define RTGUI_HZ_FILE_READ_AHEAD        1024
+
+/* the raw flash partition of HZ flash font */
+#ifndef RTGUI_HZ_FLASH_DEVICE
+#define RTGUI_HZ_FLASH_DEVICE           "font0"
+#endif
+/* the maximal glyphs loaded by one batch of HZ flash font */
+#define RTGUI_HZ_FLASH_BATCH            16
+
+/* the bytes of one read when streaming the rows of BMP, in multiple of sector */
+#ifndef RTGUI_IMAGE_BMP_STREAM_SIZE
+#define RTGUI_IMAGE_BMP_STREAM_SIZE     (8 * 1024)
+#endif
+/* read the next chunk of BMP in a thread while drawing the current one, which
+ * helps when the block device reads by DMA */
+// #define RTGUI_IMAGE_BMP_READ_AHEAD
+
+/* the memory budget of decoded images in image container, 0 to keep no idle image */
+#ifndef RTGUI_IMAGE_CONTAINER_SIZE
+#define RTGUI_IMAGE_CONTAINER_SIZE      (128 * 1024)
+#endif
+
 #define RTGUI_APP_THREAD_PRIORITY       25
 #define RTGUI_APP_THREAD_TIMESLICE      5
 #ifdef RTGUI_USING_SMALL_SIZE
@@ -45,6 +84,34 @@
 
 #define RTGUI_USING_CAST_CHECK
 
+/* use word-at-a-time blit line kernels (little endian only) */
+#define RTGUI_BLIT_USING_WORD
+
+/* back buffer of window in the pixel format of screen, see rtgui_win_set_buffered.
+ * A buffer takes the memory of a whole window, so RTGUI_USING_WIN_BUFFER is off
+ * by default. Define RTGUI_WIN_BUFFER_MEMHEAP as the name of a struct rt_memheap
+ * in BSP to take the buffers from it, the AppMgr uses a buffer only then. */
+#ifdef RTGUI_USING_WIN_BUFFER
+#ifdef RTGUI_WIN_BUFFER_MEMHEAP
+#define RTGUI_WIN_BUFFER_MALLOC(size)   rt_memheap_alloc(&RTGUI_WIN_BUFFER_MEMHEAP, size)
+#define RTGUI_WIN_BUFFER_FREE(ptr)      rt_memheap_free(ptr)
+#else
+#define RTGUI_WIN_BUFFER_MALLOC(size)   rtgui_malloc(size)
+#define RTGUI_WIN_BUFFER_FREE(ptr)      rtgui_free(ptr)
+#endif
+#endif
+
+/* allocate region data from size-classed pool instead of heap */
+#define RTGUI_USING_REGION_POOL
+/* the bytes of one slab in region data pool */
+#ifndef RTGUI_REGION_POOL_SLAB_SIZE
+#define RTGUI_REGION_POOL_SLAB_SIZE     512
+#endif
+/* the bytes of scratch arena for temporary data in region operation */
+#ifndef RTGUI_REGION_SCRATCH_SIZE
+#define RTGUI_REGION_SCRATCH_SIZE       512
+#endif
+
 //#define RTGUI_USING_DESKTOP_WINDOW
 //#undef RTGUI_USING_SMALL_SIZE
 
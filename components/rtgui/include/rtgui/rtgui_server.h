@@ -75,6 +75,17 @@ struct rtgui_topwin
 };
 typedef struct rtgui_topwin rtgui_topwin_t;
 
+/* screen update statistics of server */
+struct rtgui_server_update_stat
+{
+    /* the number of flush to driver */
+    rt_uint32_t flush_count;
+    /* the number of rects sent to driver */
+    rt_uint32_t flushed_rects;
+    /* the number of update rects merged into a pending flush */
+    rt_uint32_t coalesced_rects;
+};
+
 /* top win manager init */
 void rtgui_topwin_init(void);
 void rtgui_server_init(void);
@@ -83,5 +94,10 @@ void rtgui_server_init(void);
 void rtgui_server_post_event(struct rtgui_event *event, rt_size_t size);
 rt_err_t rtgui_server_post_event_sync(struct rtgui_event *event, rt_size_t size);
 
+/* screen update coalescing */
+void rtgui_server_update_flush(void);
+void rtgui_server_set_update_latency(rt_tick_t latency);
+void rtgui_server_get_update_stat(struct rtgui_server_update_stat *stat);
+
 #endif
 
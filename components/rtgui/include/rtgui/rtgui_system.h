@@ -74,5 +74,6 @@ rt_err_t rtgui_ack(struct rtgui_event *event, rt_int32_t status);
 rt_err_t rtgui_recv(struct rtgui_event *event, rt_size_t event_size);
 rt_err_t rtgui_recv_nosuspend(struct rtgui_event *event, rt_size_t event_size);
 rt_err_t rtgui_recv_filter(rt_uint32_t type, struct rtgui_event *event, rt_size_t event_size);
+rt_size_t rtgui_recv_batch(struct rtgui_event *events, rt_size_t event_size, rt_size_t count);
 
 #endif
@@ -19,6 +19,11 @@ DECLARE_CLASS_TYPE(notebook);
 #define RTGUI_NOTEBOOK_LEFT         0x03
 #define RTGUI_NOTEBOOK_RIGHT        0x04
 
+/* the tab images can be loaded from files through image container */
+#if defined(RTGUI_USING_NOTEBOOK_IMAGE) && defined(RTGUI_IMAGE_CONTAINER) && defined(RTGUI_USING_DFS_FILERW)
+#define RTGUI_NOTEBOOK_IMAGE_FILE
+#endif
+
 struct rtgui_notebook_tab;
 
 struct rtgui_notebook
@@ -54,6 +59,10 @@ void rtgui_notebook_add(struct rtgui_notebook *notebook, const char *label, stru
 #ifdef RTGUI_USING_NOTEBOOK_IMAGE
 void rtgui_notebook_add_image(struct rtgui_notebook *notebook, const char *label, struct rtgui_widget *child,
                               struct rtgui_image *pressed_image, struct rtgui_image *unpressed_image);
+#ifdef RTGUI_NOTEBOOK_IMAGE_FILE
+void rtgui_notebook_add_image_file(struct rtgui_notebook *notebook, const char *label, struct rtgui_widget *child,
+                                   const char *pressed_file, const char *unpressed_file);
+#endif
 #endif
 void rtgui_notebook_remove(struct rtgui_notebook *notebook, rt_uint16_t index);
 struct rtgui_widget *rtgui_notebook_get_current(struct rtgui_notebook *notebook);
@@ -19,6 +19,7 @@
 #include <rtgui/list.h>
 #include <rtgui/widgets/widget.h>
 #include <rtgui/widgets/box.h>
+#include <rtgui/driver.h>
 
 DECLARE_CLASS_TYPE(win);
 /** Gets the type of a win */
@@ -64,6 +65,22 @@ enum rtgui_win_flag
 struct rtgui_win_title;
 struct rtgui_win_area;
 
+#ifdef RTGUI_USING_WIN_BUFFER
+/* the back buffer of window, in the pixel format of screen */
+struct rtgui_win_buffer
+{
+    rt_uint8_t *pixel;
+    rt_uint16_t width, height;
+    rt_uint16_t pitch;
+
+    /* the damaged rect since last flush, in screen coordinate */
+    rtgui_rect_t dirty;
+
+    /* the framebuffer driver on pixel, see rtgui_win_get_driver */
+    struct rtgui_graphic_driver driver;
+};
+#endif
+
 struct rtgui_win
 {
     /* inherit from container */
@@ -110,6 +127,11 @@ struct rtgui_win
 
     /* reserved user data */
     rt_uint32_t user_data;
+
+#ifdef RTGUI_USING_WIN_BUFFER
+    /* back buffer, RT_NULL if the window draws to screen directly */
+    struct rtgui_win_buffer *buffer;
+#endif
 };
 
 rtgui_win_t *rtgui_win_create(struct rtgui_win *parent_window, const char *title,
@@ -153,4 +175,23 @@ void rtgui_win_event_loop(rtgui_win_t *wnd);
 void rtgui_win_set_title(rtgui_win_t *win, const char *title);
 char *rtgui_win_get_title(rtgui_win_t *win);
 
+#ifdef RTGUI_USING_WIN_BUFFER
+/** Draw window in a back buffer.
+ *
+ * When buffered, all the drawing of window and its children goes to the back
+ * buffer and the damaged part is flushed to screen when the outermost drawing
+ * ends, so the partial painting is never visible.
+ *
+ * @return -RT_ENOMEM if there is no memory for the back buffer.
+ */
+rt_err_t rtgui_win_set_buffered(struct rtgui_win *win, rt_bool_t buffered);
+#endif
+
+/** Get the graphic driver to draw window with.
+ *
+ * It's the driver on the back buffer for a buffered window, and the default
+ * driver of screen otherwise.
+ */
+struct rtgui_graphic_driver *rtgui_win_get_driver(struct rtgui_win *win);
+
 #endif
@@ -13,6 +13,7 @@
  */
 #include <rtthread.h>
 #include <rtgui/driver.h>
+#include <rtgui/blit.h>
 
 struct rtgui_graphic_driver _driver;
 
@@ -92,6 +93,9 @@ void rtgui_graphic_driver_screen_update(const struct rtgui_graphic_driver *drive
 {
     struct rt_device_rect_info rect_info;
 
+    /* the driver on back buffer of window has no device */
+    if (driver->device == RT_NULL) return;
+
     rect_info.x = rect->x1;
     rect_info.y = rect->y1;
     rect_info.width = rect->x2 - rect->x1;
@@ -100,6 +104,55 @@ void rtgui_graphic_driver_screen_update(const struct rtgui_graphic_driver *drive
 }
 RTM_EXPORT(rtgui_graphic_driver_screen_update);
 
+/* draw hline spans, fall back to draw_hline when driver has no batch op */
+void rtgui_graphic_driver_draw_hspans(const struct rtgui_graphic_driver *driver, rtgui_color_t *c,
+                                      const struct rtgui_span *spans, int count)
+{
+    int index;
+
+    if (count <= 0) return;
+
+    if (driver->ops->draw_hspans != RT_NULL)
+    {
+        driver->ops->draw_hspans(c, spans, count);
+        return;
+    }
+
+    for (index = 0; index < count; index ++)
+    {
+        driver->ops->draw_hline(c, spans[index].x1, spans[index].x2, spans[index].y);
+    }
+}
+RTM_EXPORT(rtgui_graphic_driver_draw_hspans);
+
+/*
+ * copy the pixels of rect on screen by (dx, dy), with the block transfer of
+ * graphic device or in framebuffer. The source and destination must be on
+ * screen. -RT_ENOSYS is returned if the device can't, then the caller shall
+ * redraw the destination.
+ */
+rt_err_t rtgui_graphic_driver_copy_rect(const struct rtgui_graphic_driver *driver,
+                                        const rtgui_rect_t *rect, int dx, int dy)
+{
+    if (rect->x1 >= rect->x2 || rect->y1 >= rect->y2) return RT_EOK;
+
+    if (driver->ext_ops != RT_NULL && driver->ext_ops->copy_rect != RT_NULL)
+    {
+        driver->ext_ops->copy_rect(rect->x1, rect->y1, rect->x2 - 1, rect->y2 - 1, dx, dy);
+        return RT_EOK;
+    }
+
+    if (driver->framebuffer != RT_NULL)
+    {
+        rtgui_blit_copy_rect((rt_uint8_t *)driver->framebuffer, driver->pitch,
+                             driver->bits_per_pixel / 8, rect, dx, dy);
+        return RT_EOK;
+    }
+
+    return -RT_ENOSYS;
+}
+RTM_EXPORT(rtgui_graphic_driver_copy_rect);
+
 /* get video frame buffer */
 rt_uint8_t *rtgui_graphic_driver_get_framebuffer(const struct rtgui_graphic_driver *driver)
 {
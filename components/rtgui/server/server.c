@@ -25,15 +25,70 @@
 static struct rtgui_app *rtgui_server_app = RT_NULL;
 static struct rtgui_app *rtgui_wm_application = RT_NULL;
 
-void rtgui_server_handle_update(struct rtgui_event_update_end *event)
+/*
+ * The screen update requests are merged into a damage region and flushed to
+ * the graphic driver once the event queue of server is drained, or when the
+ * oldest pending update is older than the maximal latency.
+ */
+static rtgui_region_t _update_damage;
+static rt_tick_t _update_tick;
+static rt_tick_t _update_latency = RTGUI_SERVER_UPDATE_LATENCY;
+static struct rtgui_server_update_stat _update_stat;
+
+void rtgui_server_update_flush(void)
 {
+    int index, num;
+    rtgui_rect_t *rect;
     struct rtgui_graphic_driver *driver;
 
+    if (!rtgui_region_not_empty(&_update_damage))
+        return;
+
     driver = rtgui_graphic_driver_get_default();
     if (driver != RT_NULL)
     {
-        rtgui_graphic_driver_screen_update(driver, &(event->rect));
+        num  = rtgui_region_num_rects(&_update_damage);
+        rect = rtgui_region_rects(&_update_damage);
+        if (num > RTGUI_SERVER_UPDATE_RECTS_MAX)
+        {
+            /* too fragmented, update the extents */
+            num  = 1;
+            rect = rtgui_region_extents(&_update_damage);
+        }
+
+        for (index = 0; index < num; index ++)
+            rtgui_graphic_driver_screen_update(driver, &rect[index]);
+
+        _update_stat.flushed_rects += num;
+        _update_stat.flush_count ++;
     }
+
+    rtgui_region_empty(&_update_damage);
+}
+
+void rtgui_server_set_update_latency(rt_tick_t latency)
+{
+    _update_latency = latency;
+}
+
+void rtgui_server_get_update_stat(struct rtgui_server_update_stat *stat)
+{
+    RT_ASSERT(stat != RT_NULL);
+
+    *stat = _update_stat;
+}
+
+void rtgui_server_handle_update(struct rtgui_event_update_end *event)
+{
+    if (!rtgui_region_not_empty(&_update_damage))
+        _update_tick = rt_tick_get();
+    else
+        _update_stat.coalesced_rects ++;
+
+    rtgui_region_union_rect(&_update_damage, &_update_damage, &(event->rect));
+
+    if (_update_latency == 0 || rt_tick_get() - _update_tick >= _update_latency)
+        rtgui_server_update_flush();
 }
 
 void rtgui_server_handle_monitor_add(struct rtgui_event_monitor *event)
@@ -337,6 +392,14 @@ static rt_bool_t rtgui_server_event_handler(struct rtgui_object *object,
         return RT_FALSE;
     }
 
+    /* flush the pending screen update when no more event in queue */
+    if (rtgui_region_not_empty(&_update_damage) &&
+            (rtgui_server_app->mq->entry == 0 ||
+             rt_tick_get() - _update_tick >= _update_latency))
+    {
+        rtgui_server_update_flush();
+    }
+
     return RT_TRUE;
 }
 
@@ -361,6 +424,7 @@ static void rtgui_server_entry(void *parameter)
 
     rtgui_object_set_event_handler(RTGUI_OBJECT(rtgui_server_app),
                                    rtgui_server_event_handler);
+    rtgui_region_init(&_update_damage);
     /* init mouse and show */
     rtgui_mouse_init();
 #ifdef RTGUI_USING_MOUSE_CURSOR
@@ -369,6 +433,7 @@ static void rtgui_server_entry(void *parameter)
 
     rtgui_app_run(rtgui_server_app);
 
+    rtgui_region_fini(&_update_damage);
     rtgui_app_destroy(rtgui_server_app);
     rtgui_server_app = RT_NULL;
 }
@@ -416,3 +481,15 @@ void rtgui_server_init(void)
     if (tid != RT_NULL)
         rt_thread_startup(tid);
 }
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+void list_update(void)
+{
+    rt_kprintf("screen update latency: %d ticks\n", _update_latency);
+    rt_kprintf("flush count: %d, flushed rects: %d, coalesced rects: %d\n",
+               _update_stat.flush_count, _update_stat.flushed_rects,
+               _update_stat.coalesced_rects);
+}
+FINSH_FUNCTION_EXPORT(list_update, display screen update statistics);
+#endif
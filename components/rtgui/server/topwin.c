@@ -47,8 +47,20 @@ static struct rtgui_dlist_node _rtgui_topwin_list;
 
 static struct rt_semaphore _rtgui_topwin_lock;
 
-static void rtgui_topwin_update_clip(void);
+/* statistics of clip update */
+static struct
+{
+    rt_uint32_t update;         /* times of clip update */
+    rt_uint32_t clipped;        /* windows re-clipped */
+    rt_uint32_t skipped;        /* windows out of the changed rect */
+    rt_tick_t   tick;           /* ticks spent on clip update */
+} _rtgui_topwin_clip_stat;
+/* set to RT_FALSE to re-clip all the windows on each update */
+static rt_bool_t _rtgui_topwin_clip_incremental = RT_TRUE;
+
+static void rtgui_topwin_update_clip(struct rtgui_rect *rect);
 static void rtgui_topwin_redraw(struct rtgui_rect *rect);
+static void _rtgui_topwin_redraw_below(struct rtgui_topwin *topwin, struct rtgui_rect *rect);
 static void _rtgui_topwin_activate_next(enum rtgui_topwin_flag);
 
 void rtgui_topwin_init(void)
@@ -247,6 +259,21 @@ static void _rtgui_topwin_union_region_tree(struct rtgui_topwin *topwin,
         rtgui_region_union_rect(region, region, &topwin->extent);
 }
 
+/* get the extent of topwin including the title */
+rt_inline struct rtgui_rect *_rtgui_topwin_get_extent(struct rtgui_topwin *topwin)
+{
+    if (topwin->title != RT_NULL)
+        return &RTGUI_WIDGET(topwin->title)->extent;
+    return &topwin->extent;
+}
+
+rt_inline rt_bool_t _rtgui_topwin_rect_overlap(const struct rtgui_rect *rect1,
+                                               const struct rtgui_rect *rect2)
+{
+    return rect1->x1 < rect2->x2 && rect2->x1 < rect1->x2 &&
+           rect1->y1 < rect2->y2 && rect2->y1 < rect1->y2;
+}
+
 /* The return value of this function is the next node in tree.
  *
  * As we freed the node in this function, it would be a null reference error of
@@ -309,11 +336,12 @@ rt_err_t rtgui_topwin_remove(struct rtgui_win *wid)
 
     if (topwin->flag & WINTITLE_SHOWN)
     {
-        rtgui_topwin_update_clip();
-        /* redraw the old rect */
         _rtgui_topwin_union_region_tree(topwin, &region);
+        rtgui_topwin_update_clip(rtgui_region_extents(&region));
+        /* redraw the old rect */
         rtgui_topwin_redraw(rtgui_region_extents(&region));
     }
+    rtgui_region_fini(&region);
 
     _rtgui_topwin_free_tree(topwin);
 
@@ -506,6 +534,17 @@ static void _rtgui_topwin_draw_tree(struct rtgui_topwin *topwin, struct rtgui_ev
     rtgui_send(topwin->app, &(epaint->parent), sizeof(*epaint));
 }
 
+/* update the clip in the area covered by the tree of topwin */
+static void _rtgui_topwin_update_clip_tree(struct rtgui_topwin *topwin)
+{
+    struct rtgui_region region;
+
+    rtgui_region_init(&region);
+    _rtgui_topwin_union_region_tree(topwin, &region);
+    rtgui_topwin_update_clip(rtgui_region_extents(&region));
+    rtgui_region_fini(&region);
+}
+
 rt_err_t rtgui_topwin_activate_topwin(struct rtgui_topwin *topwin)
 {
     struct rtgui_topwin *old_focus_topwin;
@@ -525,7 +564,7 @@ rt_err_t rtgui_topwin_activate_topwin(struct rtgui_topwin *topwin)
          * "raised" but not "activated".
          */
         _rtgui_topwin_raise_tree_from_root(topwin);
-        rtgui_topwin_update_clip();
+        _rtgui_topwin_update_clip_tree(_rtgui_topwin_get_root_win(topwin));
         _rtgui_topwin_draw_tree(
 #ifdef RTGUI_ONLY_ONE_WINDOW_TREE
                 topwin,
@@ -546,7 +585,7 @@ rt_err_t rtgui_topwin_activate_topwin(struct rtgui_topwin *topwin)
 
     _rtgui_topwin_raise_tree_from_root(topwin);
     /* clip before active the window, so we could get right boarder region. */
-    rtgui_topwin_update_clip();
+    _rtgui_topwin_update_clip_tree(_rtgui_topwin_get_root_win(topwin));
 
     if (old_focus_topwin != RT_NULL)
     {
@@ -684,7 +723,7 @@ rt_err_t rtgui_topwin_hide(struct rtgui_event_win *event)
     rtgui_dlist_insert_before(containing_list, &topwin->list);
 
     /* update clip info */
-    rtgui_topwin_update_clip();
+    _rtgui_topwin_update_clip_tree(topwin);
 
     /* redraw the old rect */
     rtgui_topwin_redraw(&(topwin->extent));
@@ -705,6 +744,51 @@ rt_err_t rtgui_topwin_hide(struct rtgui_event_win *event)
     return RT_EOK;
 }
 
+/*
+ * Move the pixels of window on screen instead of repainting it. It's only
+ * possible when the whole window is visible before and after moving, i.e.
+ * it's the top most window without shown child and stays on screen.
+ */
+static rt_err_t _rtgui_topwin_move_pixels(struct rtgui_topwin *topwin,
+                                          struct rtgui_rect *old_rect)
+{
+    rt_err_t result;
+    struct rtgui_rect screen, *rect;
+    struct rtgui_graphic_driver *driver;
+
+    if (get_topwin_from_list(_rtgui_topwin_list.next) != topwin)
+        return -RT_ERROR;
+    if (!rtgui_dlist_isempty(&topwin->child_list) &&
+        (get_topwin_from_list(topwin->child_list.next)->flag & WINTITLE_SHOWN))
+        return -RT_ERROR;
+
+    driver = rtgui_graphic_driver_get_default();
+    rtgui_graphic_driver_get_rect(driver, &screen);
+    rect = _rtgui_topwin_get_extent(topwin);
+    if (old_rect->x1 < screen.x1 || old_rect->y1 < screen.y1 ||
+        old_rect->x2 > screen.x2 || old_rect->y2 > screen.y2 ||
+        rect->x1 < screen.x1 || rect->y1 < screen.y1 ||
+        rect->x2 > screen.x2 || rect->y2 > screen.y2)
+        return -RT_ERROR;
+
+    /* no drawing of application in the middle */
+    rtgui_screen_lock(RT_WAITING_FOREVER);
+#ifdef RTGUI_USING_MOUSE_CURSOR
+    rtgui_mouse_hide_cursor();
+#endif
+    result = rtgui_graphic_driver_copy_rect(driver, old_rect,
+                                            rect->x1 - old_rect->x1,
+                                            rect->y1 - old_rect->y1);
+    if (result == RT_EOK)
+        rtgui_graphic_driver_screen_update(driver, rect);
+#ifdef RTGUI_USING_MOUSE_CURSOR
+    rtgui_mouse_show_cursor();
+#endif
+    rtgui_screen_unlock();
+
+    return result;
+}
+
 /* move top window */
 rt_err_t rtgui_topwin_move(struct rtgui_event_win_move *event)
 {
@@ -745,8 +829,23 @@ rt_err_t rtgui_topwin_move(struct rtgui_event_win_move *event)
         rtgui_rect_moveto(&(monitor->rect), dx, dy);
     }
 
-    /* update windows clip info */
-    rtgui_topwin_update_clip();
+    /* update windows clip info in the old and new coverage area */
+    {
+        rtgui_rect_t rect = *_rtgui_topwin_get_extent(topwin);
+
+        if (old_rect.x1 < rect.x1) rect.x1 = old_rect.x1;
+        if (old_rect.y1 < rect.y1) rect.y1 = old_rect.y1;
+        if (old_rect.x2 > rect.x2) rect.x2 = old_rect.x2;
+        if (old_rect.y2 > rect.y2) rect.y2 = old_rect.y2;
+        rtgui_topwin_update_clip(&rect);
+    }
+
+    /* the moved pixels need no repainting, only the windows below do */
+    if (_rtgui_topwin_move_pixels(topwin, &old_rect) == RT_EOK)
+    {
+        _rtgui_topwin_redraw_below(topwin, &old_rect);
+        return RT_EOK;
+    }
 
     /* update old window coverage area */
     rtgui_topwin_redraw(&old_rect);
@@ -788,6 +887,8 @@ void rtgui_topwin_resize(struct rtgui_win *wid, rtgui_rect_t *rect)
     rtgui_region_init_with_extents(&region, &topwin->extent);
     /* union the new rect so this is the region we should redraw */
     rtgui_region_union_rect(&region, &region, rect);
+    if (topwin->title != RT_NULL)
+        rtgui_region_union_rect(&region, &region, &RTGUI_WIDGET(topwin->title)->extent);
 
     topwin->extent = *rect;
 
@@ -809,11 +910,15 @@ void rtgui_topwin_resize(struct rtgui_win *wid, rtgui_rect_t *rect)
         RTGUI_WIDGET(topwin->title)->extent = rect;
     }
 
+    if (topwin->title != RT_NULL)
+        rtgui_region_union_rect(&region, &region, &RTGUI_WIDGET(topwin->title)->extent);
+
     /* update windows clip info */
-    rtgui_topwin_update_clip();
+    rtgui_topwin_update_clip(rtgui_region_extents(&region));
 
     /* update old window coverage area */
     rtgui_topwin_redraw(rtgui_region_extents(&region));
+    rtgui_region_fini(&region);
 }
 
 static struct rtgui_topwin *_rtgui_topwin_get_focus_from_list(struct rtgui_dlist_node *list)
@@ -915,7 +1020,51 @@ rt_inline void _rtgui_topwin_clip_to_region(
                            region);
 }
 
-static void rtgui_topwin_update_clip(void)
+/* update the part of clip in rect, the clip out of rect is kept */
+static void _rtgui_topwin_clip_in_rect(struct rtgui_region *clip,
+                                       struct rtgui_rect *extent,
+                                       struct rtgui_region *region,
+                                       struct rtgui_rect *rect)
+{
+    struct rtgui_region part;
+
+    rtgui_region_subtract_rect(clip, clip, rect);
+
+    rtgui_region_init_with_extents(&part, extent);
+    rtgui_region_intersect(&part, &part, region);
+    rtgui_region_union(clip, clip, &part);
+    rtgui_region_fini(&part);
+}
+
+/* clip region from topwin, and the windows beneath it, only in rect */
+static void _rtgui_topwin_clip_to_region_in_rect(
+        struct rtgui_topwin *topwin,
+        struct rtgui_region *region,
+        struct rtgui_rect *rect)
+{
+    if (topwin->title != RT_NULL)
+    {
+        _rtgui_topwin_clip_in_rect(&(RTGUI_WIDGET(topwin->title)->clip),
+                                   &(RTGUI_WIDGET(topwin->title)->extent),
+                                   region, rect);
+        rtgui_region_subtract_rect(&(RTGUI_WIDGET(topwin->title)->clip),
+                                   &(RTGUI_WIDGET(topwin->title)->clip),
+                                   &topwin->extent);
+    }
+
+    _rtgui_topwin_clip_in_rect(&RTGUI_WIDGET(topwin->wid)->clip,
+                               &RTGUI_WIDGET(topwin->wid)->extent,
+                               region, rect);
+}
+
+/*
+ * Update the clip of windows after the windows in rect are changed (shown,
+ * hidden, moved, resized or raised). The windows out of rect keep their clip
+ * and the windows overlap rect only update the part of clip in rect, so the
+ * available region is bounded by rect. If rect is RT_NULL, all the windows
+ * are re-clipped on the whole screen.
+ */
+static void rtgui_topwin_update_clip(struct rtgui_rect *rect)
 {
     struct rtgui_topwin *top;
     struct rtgui_event_clip_info eclip;
@@ -923,16 +1072,32 @@ static void rtgui_topwin_update_clip(void)
      * can paint to, not the region covered by others.
      */
     struct rtgui_region region_available;
+    struct rtgui_rect screen, changed;
+    rt_tick_t tick;
 
     if (rtgui_dlist_isempty(&_rtgui_topwin_list) ||
         !(get_topwin_from_list(_rtgui_topwin_list.next)->flag & WINTITLE_SHOWN))
         return;
 
+    tick = rt_tick_get();
     RTGUI_EVENT_CLIP_INFO_INIT(&eclip);
 
-    rtgui_region_init_rect(&region_available, 0, 0,
-                           rtgui_graphic_driver_get_default()->width,
-                           rtgui_graphic_driver_get_default()->height);
+    rtgui_rect_init(&screen, 0, 0,
+                    rtgui_graphic_driver_get_default()->width,
+                    rtgui_graphic_driver_get_default()->height);
+    if (rect != RT_NULL && _rtgui_topwin_clip_incremental == RT_TRUE)
+    {
+        changed = *rect;
+        rtgui_rect_intersect(&screen, &changed);
+        if (changed.x1 >= changed.x2 || changed.y1 >= changed.y2) return;
+        rect = &changed;
+    }
+    else
+    {
+        rect = RT_NULL;
+    }
+
+    rtgui_region_init_with_extents(&region_available, rect != RT_NULL ? rect : &screen);
 
     /* from top to bottom. */
     top = _rtgui_topwin_get_topmost_window_shown(WINTITLE_ONTOP);
@@ -944,8 +1109,21 @@ static void rtgui_topwin_update_clip(void)
 
     while (top != RT_NULL)
     {
-        /* clip the topwin */
-        _rtgui_topwin_clip_to_region(top, &region_available);
+        if (rect == RT_NULL)
+        {
+            /* clip the topwin */
+            _rtgui_topwin_clip_to_region(top, &region_available);
+        }
+        else if (_rtgui_topwin_rect_overlap(rect, _rtgui_topwin_get_extent(top)))
+        {
+            _rtgui_topwin_clip_to_region_in_rect(top, &region_available, rect);
+        }
+        else
+        {
+            /* neither the clip nor the available region in rect is changed */
+            _rtgui_topwin_clip_stat.skipped ++;
+            goto next;
+        }
 #if 0
         /* debug window clipping */
         rt_kprintf("clip %s ", top->wid->title);
@@ -954,14 +1132,14 @@ static void rtgui_topwin_update_clip(void)
 #endif
 
         /* update available region */
-        if (top->title != RT_NULL)
-            rtgui_region_subtract_rect(&region_available, &region_available, &RTGUI_WIDGET(top->title)->extent);
-        else
-            rtgui_region_subtract_rect(&region_available, &region_available, &top->extent);
+        rtgui_region_subtract_rect(&region_available, &region_available, _rtgui_topwin_get_extent(top));
 
         /* send clip event to destination window */
         eclip.wid = top->wid;
         rtgui_send(top->app, &(eclip.parent), sizeof(struct rtgui_event_clip_info));
+        _rtgui_topwin_clip_stat.clipped ++;
+
+next:
 
         /* move to next sibling tree */
         if (top->parent == RT_NULL)
@@ -984,11 +1162,17 @@ static void rtgui_topwin_update_clip(void)
             top = top->parent;
         }
     }
+
+    rtgui_region_fini(&region_available);
+
+    _rtgui_topwin_clip_stat.update ++;
+    _rtgui_topwin_clip_stat.tick += rt_tick_get() - tick;
 }
 
 static void _rtgui_topwin_redraw_tree(struct rtgui_dlist_node *list,
                                       struct rtgui_rect *rect,
-                                      struct rtgui_event_paint *epaint)
+                                      struct rtgui_event_paint *epaint,
+                                      struct rtgui_topwin *skip)
 {
     struct rtgui_dlist_node *node;
 
@@ -1010,7 +1194,7 @@ static void _rtgui_topwin_redraw_tree(struct rtgui_dlist_node *list,
         topwin = get_topwin_from_list(node);
 
         //FIXME: intersect with clip?
-        if (rtgui_rect_is_intersect(rect, &(topwin->extent)) == RT_EOK)
+        if (topwin != skip && rtgui_rect_is_intersect(rect, &(topwin->extent)) == RT_EOK)
         {
             epaint->wid = topwin->wid;
             rtgui_send(topwin->app, &(epaint->parent), sizeof(*epaint));
@@ -1022,7 +1206,7 @@ static void _rtgui_topwin_redraw_tree(struct rtgui_dlist_node *list,
             }
         }
 
-        _rtgui_topwin_redraw_tree(&topwin->child_list, rect, epaint);
+        _rtgui_topwin_redraw_tree(&topwin->child_list, rect, epaint, skip);
     }
 }
 
@@ -1032,7 +1216,17 @@ static void rtgui_topwin_redraw(struct rtgui_rect *rect)
     RTGUI_EVENT_PAINT_INIT(&epaint);
     epaint.wid = RT_NULL;
 
-    _rtgui_topwin_redraw_tree(&_rtgui_topwin_list, rect, &epaint);
+    _rtgui_topwin_redraw_tree(&_rtgui_topwin_list, rect, &epaint, RT_NULL);
+}
+
+/* redraw the windows in rect except the top most one, whose pixels are moved */
+static void _rtgui_topwin_redraw_below(struct rtgui_topwin *topwin, struct rtgui_rect *rect)
+{
+    struct rtgui_event_paint epaint;
+    RTGUI_EVENT_PAINT_INIT(&epaint);
+    epaint.wid = RT_NULL;
+
+    _rtgui_topwin_redraw_tree(&_rtgui_topwin_list, rect, &epaint, topwin);
 }
 
 /* a window enter modal mode will modal all the sibling window and parent
@@ -1264,4 +1458,20 @@ void dump_tree()
     rtgui_topwin_dump_tree();
 }
 FINSH_FUNCTION_EXPORT(dump_tree, dump rtgui topwin tree)
+
+void list_topwin_clip(void)
+{
+    rt_kprintf("clip update: %d, %d ticks\n", _rtgui_topwin_clip_stat.update,
+               _rtgui_topwin_clip_stat.tick);
+    rt_kprintf("windows clipped: %d, skipped: %d\n", _rtgui_topwin_clip_stat.clipped,
+               _rtgui_topwin_clip_stat.skipped);
+}
+FINSH_FUNCTION_EXPORT(list_topwin_clip, display the statistics of window clip update)
+
+void topwin_clip_mode(int incremental)
+{
+    _rtgui_topwin_clip_incremental = incremental ? RT_TRUE : RT_FALSE;
+    rt_memset(&_rtgui_topwin_clip_stat, 0, sizeof(_rtgui_topwin_clip_stat));
+}
+FINSH_FUNCTION_EXPORT(topwin_clip_mode, set incremental or full window clip update)
 #endif
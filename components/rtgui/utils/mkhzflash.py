@@ -0,0 +1,75 @@
+#encoding: utf-8
+#
+# Make the image of font partition for HZ flash font engine (font_hz_flash.c).
+#
+# usage: python mkhzflash.py output.bin 16:hz16font.c 12:/path/to/hzk12.fnt
+#
+# The source of each font is either the C file of HZ bitmap font or the font
+# file used by HZ file font engine, both of which are GB2312 glyphs in 94x94
+# order. The image is written to flash partition with hz_flash_update in finsh.
+
+import struct, sys
+
+HZ_FLASH_MAGIC = 0x30465A48
+HZ_FLASH_FONT_MAX = 8
+# magic, font_size, data_size, first_zone, last_zone, first_pos, last_pos, data_offset
+HEADER_FORMAT = '<IHHBBBBI'
+
+FIRST_ZONE, LAST_ZONE = 0xA1, 0xFE
+FIRST_POS, LAST_POS = 0xA1, 0xFE
+
+def _get_font_lib(fn):
+    if not fn.endswith('.c'):
+        with open(fn, 'rb') as f:
+            return bytearray(f.read())
+
+    reading_data = False
+    data = bytearray()
+    with open(fn, 'r') as f:
+        for i in f.readlines():
+            if i.strip() == 'FONT_BMP_DATA_BEGIN':
+                reading_data = True
+                continue
+            if i.strip() == 'FONT_BMP_DATA_END':
+                break
+            if reading_data:
+                line = [k for k in i.strip().split(',') if k.strip()]
+                data.extend([int(k, 16) for k in line])
+    return data
+
+def make_image(fonts):
+    glyphs = (LAST_ZONE - FIRST_ZONE + 1) * (LAST_POS - FIRST_POS + 1)
+    headers = b''
+    body = b''
+    offset = HZ_FLASH_FONT_MAX * struct.calcsize(HEADER_FORMAT)
+
+    for size, fn in fonts:
+        data_size = (size + 7) // 8 * size
+        lib = _get_font_lib(fn)
+        lib = lib[:glyphs * data_size]
+        # pad the missing glyphs
+        lib.extend(b'\0' * (glyphs * data_size - len(lib)))
+
+        headers += struct.pack(HEADER_FORMAT, HZ_FLASH_MAGIC, size, data_size,
+                               FIRST_ZONE, LAST_ZONE, FIRST_POS, LAST_POS,
+                               offset + len(body))
+        body += bytes(lib)
+
+    # terminate the header table
+    headers += b'\xff' * (offset - len(headers))
+    return headers + body
+
+if __name__ == '__main__':
+    if len(sys.argv) < 3 or len(sys.argv) - 2 > HZ_FLASH_FONT_MAX:
+        print('usage: %s output.bin size:font ...' % sys.argv[0])
+        sys.exit(1)
+
+    fonts = []
+    for arg in sys.argv[2:]:
+        size, fn = arg.split(':', 1)
+        fonts.append((int(size), fn))
+
+    image = make_image(fonts)
+    with open(sys.argv[1], 'wb') as f:
+        f.write(image)
+    print('%s: %d bytes' % (sys.argv[1], len(image)))
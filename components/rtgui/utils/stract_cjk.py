@@ -33,6 +33,8 @@ class font_lib(object):
         self._finished_push = False
 
         self.char_dict = {}
+        # the characters not in the encoding of font
+        self.missing = set()
 
     def get_char_data(self, char):
         #char_gb = char.encode(self.encoding)
@@ -46,13 +48,21 @@ class font_lib(object):
     def push_char(self, c):
         self.char_dict[c] = self.char_dict.get(c, 0) + 1
 
+    def push_string(self, s):
+        'push all the CJK characters in an unicode string'
+        for c in re.findall(match_re, s):
+            try:
+                self.push_char(c.encode(self.encoding))
+            except UnicodeEncodeError:
+                # there is no glyph for it in the font, skip it
+                if c not in self.missing:
+                    self.missing.add(c)
+                    print 'skip %s: not in %s' % (repr(c), self.encoding)
+
     def push_file(self, f):
         try:
             for i in f:
-                t = re.findall(match_re, unicode(i.decode(self.encoding)))
-                if t:
-                    for c in t:
-                        self.push_char(c.encode(self.encoding))
+                self.push_string(unicode(i.decode(self.encoding)))
         except UnicodeDecodeError as e:
             try:
                 print 'error in decoding %s' % f.name
@@ -61,6 +71,28 @@ class font_lib(object):
             # re-raise the exception and terminate the building process
             raise
 
+    def push_dir(self, path, exts=('.c', '.h', '.xml', '.txt')):
+        'push the UI strings in all the source files under path'
+        for root, dirs, files in os.walk(path):
+            for fn in files:
+                if os.path.splitext(fn)[1].lower() not in exts:
+                    continue
+                data = open(os.path.join(root, fn), 'rb').read()
+                # the sources may be in the font encoding or in UTF-8
+                for encoding in ('utf-8', self.encoding):
+                    try:
+                        self.push_string(unicode(data.decode(encoding)))
+                        break
+                    except UnicodeDecodeError:
+                        pass
+                else:
+                    print 'skip %s: unknown encoding' % os.path.join(root, fn)
+
+    def get_size_info(self):
+        'return the number of glyphs, bytes of glyphs and bytes of the full font'
+        self._finish_push()
+        return len(self._char_li), len(self._char_li) * self._bpc, len(self._lib)
+
     def _finish_push(self):
         if self._finished_push:
             return
@@ -89,6 +121,95 @@ class font_lib(object):
     def finish(self):
         return self.get_hash_map(), self.get_new_font_lib()
 
+# The glyphs are coded by a binary range coder, the probability of each pixel
+# is taken from a model trained on the glyphs in the compact font. It should be
+# kept in sync with the decoder in common/font_hz_cmp.c.
+def _glyph_rows(dat, width, height):
+    'split the 1bpp data of glyph into rows, the pixel x is at bit (width-1-x)'
+    bpr = (width+7)//8
+    rows = []
+    for y in range(height):
+        v = 0
+        for b in dat[y*bpr:(y+1)*bpr]:
+            v = (v << 8) | b
+        rows.append(v >> (bpr*8 - width))
+    return rows
+
+def _glyph_walk(rows, width, height, fn):
+    'call fn(context, pixel) on each pixel of glyph in the order of decoding'
+    above = above2 = 0
+    for y in range(height):
+        row = 0
+        for x in range(width):
+            shift = width - 1 - x
+            bit = (rows[y] >> shift) & 0x01
+            context = ((row & 0x03) << 6) | \
+                      ((((above << 2) >> shift) & 0x1F) << 1) | \
+                      ((above2 >> shift) & 0x01)
+            fn(context, bit)
+            row = (row << 1) | bit
+        above2, above = above, row
+
+def _train_model(glyphs, width, height):
+    'return the probability of blank pixel in 1/256 for each context'
+    n = [[0, 0] for i in range(256)]
+    def count(context, bit):
+        n[context][bit] += 1
+    for rows in glyphs:
+        _glyph_walk(rows, width, height, count)
+
+    model = []
+    for n0, n1 in n:
+        p = int(256.0 * (n0 + 0.5) / (n0 + n1 + 1) + 0.5)
+        model.append(min(max(p, 1), 255))
+    return model
+
+def _encode_glyph(rows, width, height, model):
+    st = {'low':0, 'range':0xFFFFFFFF, 'shift':0}
+    def code(context, bit):
+        bound = (st['range'] >> 8) * model[context]
+        if bit == 0:
+            st['range'] = bound
+        else:
+            st['low'] += bound
+            st['range'] -= bound
+        while st['range'] < (1 << 24):
+            st['range'] <<= 8
+            st['low'] <<= 8
+            st['shift'] += 1
+    _glyph_walk(rows, width, height, code)
+
+    # the decoder has read 4 + shift bytes, emit the shortest prefix of them
+    # which keeps the value in [low, low + range) whatever the bytes after it
+    # are, the decoder reads into the next glyph without harm.
+    low, rng, total = st['low'], st['range'], 4 + st['shift']
+    for m in range(1, total + 1):
+        scale = 256 ** (total - m)
+        p = (low + scale - 1) // scale
+        if (p + 1) * scale <= low + rng:
+            return [(p >> (8 * (m - 1 - i))) & 0xFF for i in range(m)]
+    raise ValueError('glyph can not be coded')
+
+def encode_font_lib(dat, width, height):
+    'return the model, offsets and data of the coded glyphs'
+    bpc = (width+7)//8*height
+    glyphs = [_glyph_rows(dat[i:i+bpc], width, height)
+              for i in range(0, len(dat), bpc)]
+    model = _train_model(glyphs, width, height)
+
+    offset = []
+    data = []
+    for rows in glyphs:
+        offset.append(len(data))
+        data.extend(_encode_glyph(rows, width, height, model))
+    offset.append(len(data))
+    if len(data) >= 65536:
+        raise ValueError('compact font is too large for 16 bits offset: %d bytes' % len(data))
+    # padding for the read ahead of decoder
+    data.extend([0] * 4)
+
+    return model, offset, data
+
 class mph_options(object):
     'mock object for options'
     def __init__(self, verbose=4, delimiter=', ', indent=4, width=80):
@@ -104,11 +225,20 @@ def gen_char_mph(font_lib):
     #print 'compact font lib: %d chars included.' % len(hmap)
     #for i in hmap:
         #print i[0], repr(i[0]), i[1]
+    count, size, full_size = font_lib.get_size_info()
+    model, offset, data = encode_font_lib(flib, font_lib.width, font_lib.height)
+    font_lib.coded_size = len(data) - 4
     code = perfect_hash.generate_code(hmap, template, perfect_hash.Hash2, opt,
             extra_subs={
                 'width':str(font_lib.width),
                 'height':str(font_lib.height),
-                'font_data':', '.join([hex(i) for i in flib])})
+                'count':str(count),
+                'size':str(size),
+                'coded_size':str(font_lib.coded_size),
+                'full_size':str(full_size),
+                'font_model':', '.join([str(i) for i in model]),
+                'font_offset':', '.join([str(i) for i in offset]),
+                'font_data':', '.join([hex(i) for i in data])})
 
     return code
 
@@ -142,6 +272,14 @@ def gen_cmp_font_file():
         fl = _font_map[i]['flib']
         if fl is not None:
             code = gen_char_mph(fl)
+            count, size, full_size = fl.get_size_info()
+            # the model and offsets are counted in the size of compact font
+            total = fl.coded_size + 256 + 2 * (count + 1)
+            print 'RTGUI: compact font %s: %d glyphs, %d bytes (%d bytes coded, %d bytes in 1bpp, %d bytes in full font, %.1fx smaller)' % \
+                  (i, count, total, fl.coded_size, size, full_size, float(full_size) / total)
+            if fl.missing:
+                print 'RTGUI: compact font %s: %d characters without glyph are skipped' % \
+                      (i, len(fl.missing))
             with open(os.path.join(cur_dir, '..', 'common', 'font_cmp_%s.c' % i), 'w') as f:
                 f.write(code)
 
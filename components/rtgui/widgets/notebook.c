@@ -4,6 +4,7 @@
 #include <rtgui/widgets/notebook.h>
 #include <rtgui/widgets/window.h>
 #include <rtgui/image.h>
+#include <rtgui/image_container.h>
 
 #define RTGUI_NOTEBOOK_TAB_DEFAULT_WIDTH  80
 #define RTGUI_NOTEBOOK_TAB_DEFAULT_HEIGHT 25
@@ -13,6 +14,13 @@ struct rtgui_notebook_tab
 #ifdef RTGUI_USING_NOTEBOOK_IMAGE
     struct rtgui_image *pressed_image;
     struct rtgui_image *unpressed_image;
+#ifdef RTGUI_NOTEBOOK_IMAGE_FILE
+    /* the images of tab in image container, the pressed one is only taken
+     * when the tab is current */
+    char *pressed_file;
+    rtgui_image_item_t *pressed_item;
+    rtgui_image_item_t *unpressed_item;
+#endif
 #endif
 
     struct rtgui_widget *widget;
@@ -22,6 +30,38 @@ struct rtgui_notebook_tab
 static void _rtgui_notebook_get_bar_rect(struct rtgui_notebook *notebook, struct rtgui_rect *rect);
 static void _rtgui_notebook_get_page_rect(struct rtgui_notebook *notebook, struct rtgui_rect *rect);
 
+#ifdef RTGUI_NOTEBOOK_IMAGE_FILE
+static void _rtgui_notebook_tab_take_image(struct rtgui_notebook_tab *tab)
+{
+    if (tab->pressed_file == RT_NULL || tab->pressed_item != RT_NULL)
+        return;
+
+    tab->pressed_item = rtgui_image_container_get(tab->pressed_file);
+    if (tab->pressed_item != RT_NULL)
+        tab->pressed_image = tab->pressed_item->image;
+}
+
+/* the image is kept in container as an idle one, to switch back at once */
+static void _rtgui_notebook_tab_release_image(struct rtgui_notebook_tab *tab)
+{
+    if (tab->pressed_item == RT_NULL)
+        return;
+
+    rtgui_image_container_put(tab->pressed_item);
+    tab->pressed_item = RT_NULL;
+    tab->pressed_image = RT_NULL;
+}
+
+static void _rtgui_notebook_tab_fini(struct rtgui_notebook_tab *tab)
+{
+    _rtgui_notebook_tab_release_image(tab);
+    if (tab->unpressed_item != RT_NULL)
+        rtgui_image_container_put(tab->unpressed_item);
+    if (tab->pressed_file != RT_NULL)
+        rt_free(tab->pressed_file);
+}
+#endif
+
 static void _rtgui_notebook_constructor(struct rtgui_notebook *notebook)
 {
     notebook->flag    = 0;
@@ -46,6 +86,9 @@ static void _rtgui_notebook_destructor(struct rtgui_notebook *notebook)
         {
             rtgui_widget_destroy(notebook->childs[index].widget);
             rt_free(notebook->childs[index].title);
+#ifdef RTGUI_NOTEBOOK_IMAGE_FILE
+            _rtgui_notebook_tab_fini(&notebook->childs[index]);
+#endif
         }
 
         rtgui_free(notebook->childs);
@@ -370,6 +413,11 @@ void rtgui_notebook_add(struct rtgui_notebook *notebook, const char *label, stru
 #ifdef RTGUI_USING_NOTEBOOK_IMAGE
     notebook->childs[notebook->count - 1].pressed_image = RT_NULL;
     notebook->childs[notebook->count - 1].unpressed_image = RT_NULL;
+#ifdef RTGUI_NOTEBOOK_IMAGE_FILE
+    notebook->childs[notebook->count - 1].pressed_file = RT_NULL;
+    notebook->childs[notebook->count - 1].pressed_item = RT_NULL;
+    notebook->childs[notebook->count - 1].unpressed_item = RT_NULL;
+#endif
 #endif
 
     /* set parent */
@@ -409,6 +457,11 @@ void rtgui_notebook_add_image(struct rtgui_notebook *notebook, const char *label
     notebook->childs[notebook->count - 1].widget = child;
     notebook->childs[notebook->count - 1].pressed_image = pressed_image;
     notebook->childs[notebook->count - 1].unpressed_image = unpressed_image;
+#ifdef RTGUI_NOTEBOOK_IMAGE_FILE
+    notebook->childs[notebook->count - 1].pressed_file = RT_NULL;
+    notebook->childs[notebook->count - 1].pressed_item = RT_NULL;
+    notebook->childs[notebook->count - 1].unpressed_item = RT_NULL;
+#endif
 
     /* set parent */
     rtgui_widget_set_parent(child, RTGUI_WIDGET(notebook));
@@ -432,6 +485,33 @@ void rtgui_notebook_add_image(struct rtgui_notebook *notebook, const char *label
 
     return;
 }
+
+#ifdef RTGUI_NOTEBOOK_IMAGE_FILE
+/*
+ * add a tab with the images in files, which are loaded through image
+ * container. The unpressed image is held by the tab, the pressed one is held
+ * only when the tab is current, and the pressed image of next tab is
+ * prefetched on switching, so the idle images make tab switch at once.
+ */
+void rtgui_notebook_add_image_file(struct rtgui_notebook *notebook, const char *label, struct rtgui_widget *child,
+                                   const char *pressed_file, const char *unpressed_file)
+{
+    struct rtgui_notebook_tab *tab;
+    rtgui_image_item_t *unpressed_item;
+
+    RT_ASSERT(notebook != RT_NULL);
+
+    unpressed_item = rtgui_image_container_get(unpressed_file);
+    rtgui_notebook_add_image(notebook, label, child, RT_NULL,
+                             unpressed_item != RT_NULL ? unpressed_item->image : RT_NULL);
+
+    tab = &notebook->childs[notebook->count - 1];
+    tab->unpressed_item = unpressed_item;
+    tab->pressed_file = rt_strdup(pressed_file);
+    if (notebook->count - 1 == notebook->current)
+        _rtgui_notebook_tab_take_image(tab);
+}
+#endif
 #endif
 
 void rtgui_notebook_remove(struct rtgui_notebook *notebook, rt_uint16_t index)
@@ -467,11 +547,17 @@ void rtgui_notebook_remove(struct rtgui_notebook *notebook, rt_uint16_t index)
         }
 
         rt_free(tab.title);
+#ifdef RTGUI_NOTEBOOK_IMAGE_FILE
+        _rtgui_notebook_tab_fini(&tab);
+#endif
 
         if (need_update)
         {
             if (notebook->current > notebook->count - 1)
                 notebook->current = notebook->count - 1;
+#ifdef RTGUI_NOTEBOOK_IMAGE_FILE
+            _rtgui_notebook_tab_take_image(&notebook->childs[notebook->current]);
+#endif
 
             rtgui_widget_hide(tab.widget);
             rtgui_widget_show(notebook->childs[notebook->current].widget);
@@ -533,15 +619,29 @@ void rtgui_notebook_set_current_by_index(struct rtgui_notebook *notebook, rt_uin
         struct rtgui_widget *widget;
 
         if (notebook->current != RTGUI_NOT_FOUND)
+        {
             rtgui_widget_hide(notebook->childs[notebook->current].widget);
+#ifdef RTGUI_NOTEBOOK_IMAGE_FILE
+            _rtgui_notebook_tab_release_image(&notebook->childs[notebook->current]);
+#endif
+        }
 
         notebook->current = index;
+#ifdef RTGUI_NOTEBOOK_IMAGE_FILE
+        _rtgui_notebook_tab_take_image(&notebook->childs[index]);
+#endif
         widget = notebook->childs[notebook->current].widget;
         rtgui_widget_show(widget);
         rtgui_widget_update_clip(widget);
         /* the whole notebook need an update */
         rtgui_widget_update(RTGUI_WIDGET(notebook));
         rtgui_widget_focus(widget);
+
+#ifdef RTGUI_NOTEBOOK_IMAGE_FILE
+        /* decode the image of next tab after this one is drawn */
+        if (index + 1 < notebook->count && notebook->childs[index + 1].pressed_file != RT_NULL)
+            rtgui_image_container_prefetch(notebook->childs[index + 1].pressed_file);
+#endif
     }
 }
 
@@ -221,6 +221,55 @@ static void _draw_textview(rtgui_textview_t *textview)
     rtgui_dc_end_drawing(dc);
 }
 
+/* scroll from line_old to line_current, and draw the lines exposed */
+static void _scroll_textview(rtgui_textview_t *textview, rt_int16_t line_old)
+{
+    struct rtgui_dc *dc;
+    struct rtgui_rect rect, area, font_rect, line_rect;
+    struct rtgui_region exposed;
+    rtgui_rect_t *extents;
+    char *line;
+    rt_base_t line_index, item_height;
+
+    rtgui_font_get_metrics(RTGUI_WIDGET_FONT(textview), "W", &font_rect);
+    item_height = rtgui_rect_height(font_rect) + 3;
+
+    dc = rtgui_dc_begin_drawing(RTGUI_WIDGET(textview));
+    if (dc == RT_NULL) return ;
+
+    /* the area of lines, the rest of widget is kept blank */
+    rtgui_widget_get_rect(RTGUI_WIDGET(textview), &rect);
+    area = rect;
+    if (area.y1 + textview->line_page_count * item_height < area.y2)
+        area.y2 = area.y1 + textview->line_page_count * item_height;
+
+    rtgui_region_init(&exposed);
+    rtgui_dc_scroll(dc, &area, 0, (line_old - textview->line_current) * item_height, &exposed);
+
+    extents = rtgui_region_extents(&exposed);
+    if (extents->x1 < extents->x2 && extents->y1 < extents->y2)
+    {
+        rtgui_dc_fill_rect(dc, extents);
+
+        line_rect = rect;
+        line_rect.x1 += 3;
+        line_rect.x2 -= 3;
+        for (line_index = 0; line_index < textview->line_page_count; line_index ++)
+        {
+            line_rect.y1 = area.y1 + line_index * item_height;
+            if (line_rect.y1 >= extents->y2) break;
+            if (line_rect.y1 + item_height <= extents->y1) continue;
+
+            line = (char *)_get_line_text(textview, textview->line_current + line_index);
+            if (line == RT_NULL) break;
+            rtgui_dc_draw_text(dc, line, &line_rect);
+        }
+    }
+    rtgui_region_fini(&exposed);
+
+    rtgui_dc_end_drawing(dc);
+}
+
 static void _rtgui_textview_constructor(rtgui_textview_t *textview)
 {
     /* init widget and set event handler */
@@ -302,8 +351,16 @@ rt_bool_t rtgui_textview_event_handler(struct rtgui_object *object, struct rtgui
 
             if (textview->line_current != line_current_update)
             {
+                rt_int16_t line_old = textview->line_current;
+
                 textview->line_current = line_current_update;
-                rtgui_widget_update(widget);
+                /* move the lines still on page instead of redrawing them */
+                if (line_old >= 0 &&
+                    line_current_update - line_old < textview->line_page_count &&
+                    line_old - line_current_update < textview->line_page_count)
+                    _scroll_textview(textview, line_old);
+                else
+                    rtgui_widget_update(widget);
                 return RT_TRUE;
             }
         }
@@ -13,6 +13,7 @@
  */
 #include <rtgui/dc.h>
 #include <rtgui/color.h>
+#include <rtgui/driver.h>
 #include <rtgui/image.h>
 #include <rtgui/rtgui_system.h>
 #include <rtgui/rtgui_server.h>
@@ -59,6 +60,10 @@ static void _rtgui_win_constructor(rtgui_win_t *win)
 
     /* init user data */
     win->user_data = 0;
+
+#ifdef RTGUI_USING_WIN_BUFFER
+    win->buffer = RT_NULL;
+#endif
 }
 
 static void _rtgui_win_destructor(rtgui_win_t *win)
@@ -81,6 +86,9 @@ static void _rtgui_win_destructor(rtgui_win_t *win)
     /* release field */
     if (win->title != RT_NULL)
         rt_free(win->title);
+#ifdef RTGUI_USING_WIN_BUFFER
+    rtgui_win_set_buffered(win, RT_FALSE);
+#endif
     /* release external clip info */
     win->drawing = 0;
 }
@@ -654,6 +662,15 @@ void rtgui_win_set_rect(rtgui_win_t *win, rtgui_rect_t *rect)
 
     RTGUI_WIDGET(win)->extent = *rect;
 
+#ifdef RTGUI_USING_WIN_BUFFER
+    /* re-create the back buffer in new size */
+    if (win->buffer != RT_NULL)
+    {
+        rtgui_win_set_buffered(win, RT_FALSE);
+        rtgui_win_set_buffered(win, RT_TRUE);
+    }
+#endif
+
     if (win->flag & RTGUI_WIN_FLAG_CONNECTED)
     {
         /* set window resize event to server */
@@ -731,3 +748,107 @@ char *rtgui_win_get_title(rtgui_win_t *win)
 }
 RTM_EXPORT(rtgui_win_get_title);
 
+#ifdef RTGUI_USING_WIN_BUFFER
+#ifdef RTGUI_WIN_BUFFER_MEMHEAP
+extern struct rt_memheap RTGUI_WIN_BUFFER_MEMHEAP;
+#endif
+extern const struct rtgui_graphic_driver_ops *rtgui_framebuffer_get_ops(int pixel_format);
+
+rt_err_t rtgui_win_set_buffered(struct rtgui_win *win, rt_bool_t buffered)
+{
+    rt_uint16_t width, height, pitch;
+    struct rtgui_win_buffer *buffer;
+    struct rtgui_graphic_driver *driver;
+    const struct rtgui_graphic_driver_ops *ops;
+
+    RT_ASSERT(win != RT_NULL);
+
+    if (buffered == RT_FALSE)
+    {
+        buffer = win->buffer;
+        if (buffer != RT_NULL)
+        {
+            /* make sure it's not in drawing */
+            rtgui_screen_lock(RT_WAITING_FOREVER);
+            win->buffer = RT_NULL;
+            rtgui_screen_unlock();
+
+            RTGUI_WIN_BUFFER_FREE(buffer->pixel);
+            rtgui_free(buffer);
+        }
+
+        return RT_EOK;
+    }
+
+    if (win->buffer != RT_NULL) return RT_EOK;
+
+    driver = rtgui_graphic_driver_get_default();
+    width  = rtgui_rect_width(RTGUI_WIDGET(win)->extent);
+    height = rtgui_rect_height(RTGUI_WIDGET(win)->extent);
+    pitch  = width * driver->bits_per_pixel / 8;
+    if (pitch == 0 || height == 0) return -RT_ERROR;
+    ops = rtgui_framebuffer_get_ops(driver->pixel_format);
+    if (ops == RT_NULL) return -RT_ERROR;
+
+    buffer = (struct rtgui_win_buffer *)rtgui_malloc(sizeof(struct rtgui_win_buffer));
+    if (buffer == RT_NULL) return -RT_ENOMEM;
+
+    buffer->pixel = (rt_uint8_t *)RTGUI_WIN_BUFFER_MALLOC(pitch * height);
+    if (buffer->pixel == RT_NULL)
+    {
+        rtgui_free(buffer);
+        return -RT_ENOMEM;
+    }
+    buffer->width  = width;
+    buffer->height = height;
+    buffer->pitch  = pitch;
+    buffer->dirty  = rtgui_empty_rect;
+
+    /* the framebuffer ops on pixel, without device and hardware acceleration */
+    buffer->driver = *driver;
+    buffer->driver.pitch = pitch;
+    buffer->driver.device = RT_NULL;
+    buffer->driver.ops = ops;
+    buffer->driver.ext_ops = RT_NULL;
+
+    /* make sure it's not in drawing */
+    rtgui_screen_lock(RT_WAITING_FOREVER);
+    win->buffer = buffer;
+    rtgui_screen_unlock();
+
+    return RT_EOK;
+}
+RTM_EXPORT(rtgui_win_set_buffered);
+#endif
+
+struct rtgui_graphic_driver *rtgui_win_get_driver(struct rtgui_win *win)
+{
+#ifdef RTGUI_USING_WIN_BUFFER
+    struct rtgui_win_buffer *buffer;
+    const rtgui_rect_t *extent;
+
+    RT_ASSERT(win != RT_NULL);
+
+    buffer = win->buffer;
+    extent = &(RTGUI_WIDGET(win)->extent);
+    /* the buffer is re-created when resizing, draw to screen until then */
+    if (buffer != RT_NULL &&
+            buffer->width == rtgui_rect_width(*extent) &&
+            buffer->height == rtgui_rect_height(*extent))
+    {
+        /*
+         * The framebuffer ops address pixel in screen coordinate, so set the
+         * base to where the screen origin would be, which follows the window
+         * when it moves. Only the pixels inside window are touched since the
+         * drawing is clipped by widget.
+         */
+        buffer->driver.framebuffer = buffer->pixel - extent->y1 * buffer->pitch -
+                                     extent->x1 * buffer->driver.bits_per_pixel / 8;
+        return &(buffer->driver);
+    }
+#endif
+
+    return rtgui_graphic_driver_get_default();
+}
+RTM_EXPORT(rtgui_win_get_driver);
+
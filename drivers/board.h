@@ -34,6 +34,15 @@
 //	<o>End Address of External SRAM
 //		<i>Default: 0x600FFFFF
 #define STM32_EXT_SRAM_END      0x600FFFFF /* the end address of external SRAM */
+//	<o>Size of window back buffer in External SRAM[Kbytes]
+//		<i>Default: 676, an 800x430 window in RGB565 with memheap headers
+#ifdef RTGUI_USING_WIN_BUFFER
+#define STM32_EXT_SRAM_WIN_BUFFER_SIZE  (676 * 1024)
+#else
+#define STM32_EXT_SRAM_WIN_BUFFER_SIZE  0
+#endif
+/* the system heap takes the rest of external SRAM */
+#define STM32_EXT_SRAM_HEAP_END (STM32_EXT_SRAM_END + 1 - STM32_EXT_SRAM_WIN_BUFFER_SIZE)
 // </e>
 
 // <o> Internal SRAM memory size[Kbytes] <8-64>
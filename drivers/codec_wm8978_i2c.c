@@ -33,22 +33,31 @@
 void vol(uint16_t v);
 static void codec_send(rt_uint16_t s_data);
 
-#define DATA_NODE_MAX 5
-/* data node for Tx Mode */
-struct codec_data_node
-{
-    rt_uint16_t *data_ptr;
-    rt_size_t  data_size;
-};
-
 struct codec_device
 {
     /* inherit from rt_device */
     struct rt_device parent;
 
-    /* pcm data list */
-    struct codec_data_node data_list[DATA_NODE_MAX];
-    rt_uint16_t read_index, put_index;
+    /* PCM ring, the DMA plays it slot by slot in double buffer mode. The
+     * slot being played belongs to DMA, the writer owns the rest of free
+     * space. A played slot is cleared, so a slot plays silence if nothing
+     * is written into it in time. A guard slot follows the ring, the data
+     * written over the end of ring is moved to the head on commit. */
+    rt_uint8_t *ring;
+    rt_size_t size;
+    rt_uint16_t slots, slots_cfg;
+    /* fill is the bytes from read_pos (the slot being played) to write_pos */
+    rt_size_t read_pos, write_pos, reserve_pos, fill;
+    rt_bool_t running, draining, drained;
+
+    /* writer waits for the free space */
+    rt_bool_t waiting;
+    struct rt_semaphore tx_sem;
+
+    /* statistics */
+    rt_uint32_t underruns;
+    rt_size_t fill_min;
+    rt_uint32_t fill_sum, fill_samples;
 
     /* i2c mode */
     struct rt_i2c_bus_device * i2c_device;
@@ -102,7 +111,8 @@ static void GPIO_Configuration(void)
     GPIO_Init(GPIOB, &GPIO_InitStructure);
 }
 
-static void DMA_Configuration(rt_uint32_t addr, rt_size_t size)
+/* play the buffer at addr0 and then addr1, they are switched by hardware */
+static void DMA_Configuration(rt_uint32_t addr0, rt_uint32_t addr1, rt_size_t size)
 {
     DMA_InitTypeDef DMA_InitStructure;
 
@@ -113,14 +123,14 @@ static void DMA_Configuration(rt_uint32_t addr, rt_size_t size)
     /* Set the parameters to be configured */
     DMA_InitStructure.DMA_Channel = AUDIO_I2S_DMA_CHANNEL;
     DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)(&CODEC_I2S_PORT->DR);
-    DMA_InitStructure.DMA_Memory0BaseAddr = (uint32_t)addr;      /* This field will be configured in play function */
+    DMA_InitStructure.DMA_Memory0BaseAddr = (uint32_t)addr0;
     DMA_InitStructure.DMA_DIR = DMA_DIR_MemoryToPeripheral;
-    DMA_InitStructure.DMA_BufferSize = (uint32_t)size;      /* This field will be configured in play function */
+    DMA_InitStructure.DMA_BufferSize = (uint32_t)size;
     DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
     DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
     DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_HalfWord;
     DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_HalfWord;
-    DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
     DMA_InitStructure.DMA_Priority = DMA_Priority_High;
     DMA_InitStructure.DMA_FIFOMode = DMA_FIFOMode_Disable;
     DMA_InitStructure.DMA_FIFOThreshold = DMA_FIFOThreshold_1QuarterFull;
@@ -128,6 +138,10 @@ static void DMA_Configuration(rt_uint32_t addr, rt_size_t size)
     DMA_InitStructure.DMA_PeripheralBurst = DMA_PeripheralBurst_Single;
     DMA_Init(AUDIO_I2S_DMA_STREAM, &DMA_InitStructure);
 
+    /* double buffer mode, memory 0 is played first */
+    DMA_DoubleBufferModeConfig(AUDIO_I2S_DMA_STREAM, (uint32_t)addr1, DMA_Memory_0);
+    DMA_DoubleBufferModeCmd(AUDIO_I2S_DMA_STREAM, ENABLE);
+
     /* Enable SPI DMA Tx request */
     SPI_I2S_DMACmd(CODEC_I2S_PORT, SPI_I2S_DMAReq_Tx, ENABLE);
 
@@ -405,58 +419,212 @@ FINSH_FUNCTION_EXPORT(eq3d, Set 3D(Depth));
 FINSH_FUNCTION_EXPORT(sample_rate, Set sample rate);
 #endif
 
-static rt_err_t codec_open(rt_device_t dev, rt_uint16_t oflag)
+static void codec_pcm_reset(struct codec_device* device)
 {
-#if !CODEC_MASTER_MODE
-    /* enable I2S */
-    I2S_Cmd(CODEC_I2S_PORT, ENABLE);
+    device->read_pos = device->write_pos = device->reserve_pos = 0;
+    device->fill = 0;
+    device->draining = device->drained = RT_FALSE;
+    rt_memset(device->ring, 0, device->size);
+}
+
+/* start DMA, the first two slots must be filled */
+static void codec_pcm_start(struct codec_device* device)
+{
+#if CODEC_MASTER_MODE
+    codec_send(r06 & ~MS);
+    I2S_Cmd(CODEC_I2S_PORT, DISABLE);
 #endif
 
-    return RT_EOK;
+    device->running = RT_TRUE;
+    NVIC_EnableIRQ(AUDIO_I2S_DMA_IRQ);
+    DMA_Configuration((rt_uint32_t)(device->ring + device->read_pos),
+                      (rt_uint32_t)(device->ring + device->read_pos + CODEC_PCM_SLOT_SIZE),
+                      CODEC_PCM_SLOT_SIZE >> 1);
+
+#if CODEC_MASTER_MODE
+    if ((r06 & MS) == 0)
+    {
+        I2S_Cmd(CODEC_I2S_PORT, ENABLE);
+        r06 |= MS;
+        codec_send(r06);
+    }
+#endif
 }
 
-static rt_err_t codec_close(rt_device_t dev)
+static void codec_pcm_stop(struct codec_device* device)
 {
-#if CODEC_MASTER_MODE
-    if (r06 & MS)
+    if (device->running == RT_TRUE)
     {
         NVIC_DisableIRQ(AUDIO_I2S_DMA_IRQ);
         DMA_Cmd(AUDIO_I2S_DMA_STREAM, DISABLE);
         /* Clear DMA Stream Transfer Complete interrupt pending bit */
         DMA_ClearITPendingBit(AUDIO_I2S_DMA_STREAM, AUDIO_I2S_DMA_IT_TC);
 
-        while ((CODEC_I2S_PORT->SR & SPI_I2S_FLAG_TXE) == 0);
-        while ((CODEC_I2S_PORT->SR & SPI_I2S_FLAG_BSY) != 0);
-        I2S_Cmd(CODEC_I2S_PORT, DISABLE);
+#if CODEC_MASTER_MODE
+        if (r06 & MS)
+        {
+            while ((CODEC_I2S_PORT->SR & SPI_I2S_FLAG_TXE) == 0);
+            while ((CODEC_I2S_PORT->SR & SPI_I2S_FLAG_BSY) != 0);
+            I2S_Cmd(CODEC_I2S_PORT, DISABLE);
+
+            r06 &= ~MS;
+            codec_send(r06);
+        }
+#endif
+    }
 
-        r06 &= ~MS;
-        codec_send(r06);
+    device->running = RT_FALSE;
+    codec_pcm_reset(device);
+}
+
+/*
+ * reserve slot->size bytes of contiguous space in PCM ring, at most one
+ * slot. It may run over the end of ring into the guard slot. There is only
+ * one writer of the ring.
+ */
+static rt_err_t codec_pcm_reserve(struct codec_device* device, struct codec_pcm_slot* slot)
+{
+    rt_base_t level;
+
+    if (device->ring == RT_NULL || slot->size == 0 || slot->size > CODEC_PCM_SLOT_SIZE)
+        return -RT_ERROR;
 
-        /* remove all data node */
-        if (codec.parent.tx_complete != RT_NULL)
+    while (1)
+    {
+        level = rt_hw_interrupt_disable();
+        if (device->fill + slot->size <= device->size)
         {
-            rt_base_t level = rt_hw_interrupt_disable();
-
-            while (codec.read_index != codec.put_index)
-            {
-                codec.parent.tx_complete(&codec.parent, codec.data_list[codec.read_index].data_ptr);
-                codec.read_index++;
-                if (codec.read_index >= DATA_NODE_MAX)
-                {
-                    codec.read_index = 0;
-                }
-            }
+            device->reserve_pos = device->write_pos;
+            slot->data = (rt_uint16_t*)(device->ring + device->write_pos);
+            rt_hw_interrupt_enable(level);
 
+            return RT_EOK;
+        }
+
+        /* wait for a slot to be played */
+        device->waiting = RT_TRUE;
+        rt_hw_interrupt_enable(level);
+
+        if (rt_sem_take(&device->tx_sem, slot->timeout) != RT_EOK)
+            return -RT_ETIMEOUT;
+    }
+}
+
+static void codec_pcm_commit(struct codec_device* device, rt_size_t size)
+{
+    rt_base_t level;
+    rt_bool_t start = RT_FALSE;
+
+    /* move the data in guard slot to the head of ring */
+    if (device->reserve_pos + size > device->size)
+        rt_memcpy(device->ring, device->ring + device->size,
+                  device->reserve_pos + size - device->size);
+
+    level = rt_hw_interrupt_disable();
+    /* the reserved space is taken by DMA on underrun, drop the data */
+    if (device->write_pos == device->reserve_pos)
+    {
+        device->write_pos += size;
+        if (device->write_pos >= device->size)
+            device->write_pos -= device->size;
+        device->fill += size;
+
+        if (device->running == RT_FALSE && device->fill >= 2 * CODEC_PCM_SLOT_SIZE)
+            start = RT_TRUE;
+    }
+    rt_hw_interrupt_enable(level);
+
+    if (start == RT_TRUE)
+        codec_pcm_start(device);
+}
+
+/* play out the data in PCM ring */
+static void codec_pcm_drain(struct codec_device* device)
+{
+    rt_base_t level;
+    rt_size_t pad;
+    int timeout;
+
+    /* pad the data to the end of slot */
+    pad = device->write_pos % CODEC_PCM_SLOT_SIZE;
+    if (pad != 0)
+    {
+        pad = CODEC_PCM_SLOT_SIZE - pad;
+        rt_memset(device->ring + device->write_pos, 0, pad);
+        device->reserve_pos = device->write_pos;
+        codec_pcm_commit(device, pad);
+    }
+
+    level = rt_hw_interrupt_disable();
+    device->draining = RT_TRUE;
+    rt_hw_interrupt_enable(level);
+
+    /* a short stream is not started yet */
+    if (device->running == RT_FALSE && device->fill > 0)
+        codec_pcm_start(device);
+
+    /* wait for all the slots to be played */
+    for (timeout = device->slots + 2; timeout > 0; timeout --)
+    {
+        level = rt_hw_interrupt_disable();
+        if (device->running == RT_FALSE || device->drained == RT_TRUE)
+        {
             rt_hw_interrupt_enable(level);
+            break;
         }
+        device->waiting = RT_TRUE;
+        rt_hw_interrupt_enable(level);
+
+        rt_sem_take(&device->tx_sem, RT_TICK_PER_SECOND / 5);
     }
+}
+
+static rt_err_t codec_open(rt_device_t dev, rt_uint16_t oflag)
+{
+    struct codec_device* device = (struct codec_device*) dev;
+
+    /* allocate PCM ring and the guard slot */
+    device->slots = device->slots_cfg;
+    device->size = device->slots * CODEC_PCM_SLOT_SIZE;
+    device->ring = (rt_uint8_t*) rt_malloc(device->size + CODEC_PCM_SLOT_SIZE);
+    if (device->ring == RT_NULL)
+    {
+        rt_kprintf("no memory for %d slots of PCM ring\n", device->slots);
+        return -RT_ENOMEM;
+    }
+    codec_pcm_reset(device);
+
+    device->underruns = 0;
+    device->fill_min = device->size;
+    device->fill_sum = device->fill_samples = 0;
+
+#if !CODEC_MASTER_MODE
+    /* enable I2S */
+    I2S_Cmd(CODEC_I2S_PORT, ENABLE);
 #endif
 
     return RT_EOK;
 }
 
+static rt_err_t codec_close(rt_device_t dev)
+{
+    struct codec_device* device = (struct codec_device*) dev;
+
+    if (device->ring == RT_NULL)
+        return RT_EOK;
+
+    codec_pcm_drain(device);
+    codec_pcm_stop(device);
+
+    rt_free(device->ring);
+    device->ring = RT_NULL;
+
+    return RT_EOK;
+}
+
 static rt_err_t codec_control(rt_device_t dev, rt_uint8_t cmd, void *args)
 {
+    struct codec_device* device = (struct codec_device*) dev;
     rt_err_t result = RT_EOK;
 
     switch (cmd)
@@ -481,69 +649,81 @@ static rt_err_t codec_control(rt_device_t dev, rt_uint8_t cmd, void *args)
         eq3d(*((uint8_t*) args));
         break;
 
+    case CODEC_CMD_PCM_SLOTS:
+        device->slots_cfg = *((rt_uint16_t*) args);
+        if (device->slots_cfg < CODEC_PCM_SLOTS_MIN)
+            device->slots_cfg = CODEC_PCM_SLOTS_MIN;
+        break;
+
+    case CODEC_CMD_PCM_RESERVE:
+        result = codec_pcm_reserve(device, (struct codec_pcm_slot*) args);
+        break;
+
+    case CODEC_CMD_PCM_COMMIT:
+        codec_pcm_commit(device, ((struct codec_pcm_slot*) args)->size);
+        break;
+
+    case CODEC_CMD_PCM_DRAIN:
+        if (device->ring != RT_NULL)
+        {
+            codec_pcm_drain(device);
+            codec_pcm_stop(device);
+        }
+        break;
+
+    case CODEC_CMD_PCM_STAT:
+    {
+        struct codec_pcm_stat* stat = (struct codec_pcm_stat*) args;
+
+        stat->slots = device->slots;
+        stat->running = device->running;
+        stat->fill = device->fill;
+        stat->fill_min = device->fill_samples ? device->fill_min : 0;
+        stat->fill_avg = device->fill_samples ? device->fill_sum / device->fill_samples : 0;
+        stat->underruns = device->underruns;
+    }
+    break;
+
     default:
         result = RT_ERROR;
     }
     return result;
 }
 
+/* copy the data into PCM ring, the buffer is given back at once */
 static rt_size_t codec_write(rt_device_t dev, rt_off_t pos,
                              const void* buffer, rt_size_t size)
 {
     struct codec_device* device;
-    struct codec_data_node* node;
-    rt_uint32_t level;
-    rt_uint16_t next_index;
+    struct codec_pcm_slot slot;
+    const rt_uint8_t *ptr;
+    rt_size_t left;
 
     device = (struct codec_device*) dev;
     RT_ASSERT(device != RT_NULL);
 
-    next_index = device->put_index + 1;
-    if (next_index >= DATA_NODE_MAX)
-        next_index = 0;
-
-    /* check data_list full */
-    if (next_index == device->read_index)
+    ptr = (const rt_uint8_t*) buffer;
+    left = size & ~0x01;
+    while (left > 0)
     {
-        rt_set_errno(-RT_EFULL);
-        return 0;
-    }
+        slot.size = CODEC_PCM_SLOT_SIZE;
+        if (slot.size > left) slot.size = left;
+        slot.timeout = RT_WAITING_FOREVER;
 
-    level = rt_hw_interrupt_disable();
-    node = &device->data_list[device->put_index];
-    device->put_index = next_index;
-
-    /* set node attribute */
-    node->data_ptr = (rt_uint16_t*) buffer;
-    node->data_size = size >> 1; /* size is byte unit, convert to half word unit */
+        if (codec_pcm_reserve(device, &slot) != RT_EOK)
+            break;
 
-    next_index = device->read_index + 1;
-    if (next_index >= DATA_NODE_MAX)
-        next_index = 0;
+        rt_memcpy(slot.data, ptr, slot.size);
+        codec_pcm_commit(device, slot.size);
 
-    /* check data list whether is empty */
-    if (next_index == device->put_index)
-    {
-#if CODEC_MASTER_MODE
-        codec_send(r06 & ~MS);
-        I2S_Cmd(CODEC_I2S_PORT, DISABLE);
-#endif
-
-        NVIC_EnableIRQ(AUDIO_I2S_DMA_IRQ);
-        DMA_Configuration((rt_uint32_t) node->data_ptr, node->data_size);
-
-#if CODEC_MASTER_MODE
-        if ((r06 & MS) == 0)
-        {
-            I2S_Cmd(CODEC_I2S_PORT, ENABLE);
-            r06 |= MS;
-            codec_send(r06);
-        }
-#endif
+        ptr += slot.size;
+        left -= slot.size;
     }
-    rt_hw_interrupt_enable(level);
 
-    return size;
+    if (device->parent.tx_complete != RT_NULL)
+        device->parent.tx_complete(&device->parent, (void*)buffer);
+
+    return size - left;
 }
 
 rt_err_t codec_hw_init(const char * i2c_bus_device_name)
@@ -585,9 +765,12 @@ rt_err_t codec_hw_init(const char * i2c_bus_device_name)
     codec.parent.read    = RT_NULL;
     codec.parent.write   = codec_write;
 
-    /* set read_index and put index to 0 */
-    codec.read_index = 0;
-    codec.put_index = 0;
+    /* the PCM ring is allocated on open */
+    codec.ring = RT_NULL;
+    codec.slots_cfg = CODEC_PCM_SLOTS_DEFAULT;
+    codec.running = RT_FALSE;
+    codec.waiting = RT_FALSE;
+    rt_sem_init(&codec.tx_sem, "snd", 0, RT_IPC_FLAG_FIFO);
 
     /* register the device */
     return rt_device_register(&codec.parent, "snd", RT_DEVICE_FLAG_WRONLY | RT_DEVICE_FLAG_DMA_TX);
@@ -595,20 +778,12 @@ rt_err_t codec_hw_init(const char * i2c_bus_device_name)
 
 static void codec_dma_isr(void)
 {
-    /* switch to next buffer */
-    rt_uint16_t next_index;
-    void* data_ptr;
+    struct codec_device* device = &codec;
+    rt_size_t armed;
 
     /* enter interrupt */
     rt_interrupt_enter();
 
-    next_index = codec.read_index + 1;
-    if (next_index >= DATA_NODE_MAX)
-        next_index = 0;
-
-    /* save current data pointer */
-    data_ptr = codec.data_list[codec.read_index].data_ptr;
-
 #if !CODEC_MASTER_MODE
     if (codec_sr_new)
     {
@@ -618,45 +793,54 @@ static void codec_dma_isr(void)
     }
 #endif
 
-    codec.read_index = next_index;
-    if (next_index != codec.put_index)
-    {
-        /* enable next dma request */
-        DMA_Configuration((rt_uint32_t)codec.data_list[codec.read_index].data_ptr,
-                          codec.data_list[codec.read_index].data_size);
+    /* the slot is played, DMA switches to the next one */
+    rt_memset(device->ring + device->read_pos, 0, CODEC_PCM_SLOT_SIZE);
+    device->read_pos += CODEC_PCM_SLOT_SIZE;
+    if (device->read_pos >= device->size)
+        device->read_pos = 0;
+    device->fill -= CODEC_PCM_SLOT_SIZE;
 
-#if CODEC_MASTER_MODE
-        if ((r06 & MS) == 0)
-        {
-//            CODEC_I2S_PORT->I2SCFGR |= SPI_I2SCFGR_I2SE;
-            r06 |= MS;
-//            codec_send(r06);
-        }
-#endif
-    }
-    else /* codec tx done. */
+    if (device->draining == RT_FALSE)
     {
-#if CODEC_MASTER_MODE
-        if (r06 & MS)
+        if (device->fill < device->fill_min)
+            device->fill_min = device->fill;
+        device->fill_sum += device->fill;
+        if (++device->fill_samples == 0x1000)
         {
-            DMA_Cmd(AUDIO_I2S_DMA_STREAM, DISABLE);
-
-            while ((CODEC_I2S_PORT->SR & SPI_I2S_FLAG_TXE) == 0);
-            while ((CODEC_I2S_PORT->SR & SPI_I2S_FLAG_BSY) != 0);
-            I2S_Cmd(CODEC_I2S_PORT, DISABLE);
-
-            r06 &= ~MS;
-//            codec_send(r06);
+            /* keep a moving average */
+            device->fill_sum >>= 1;
+            device->fill_samples >>= 1;
         }
-#endif
+    }
 
-        rt_kprintf("*\n");
-    } /* codec tx done. */
+    /* the slot being played is not filled, it's owned by DMA anyway */
+    if (device->fill < CODEC_PCM_SLOT_SIZE)
+    {
+        if (device->draining == RT_TRUE && device->fill == 0)
+            device->drained = RT_TRUE;
+        else if (device->draining == RT_FALSE)
+            device->underruns ++;
+
+        device->write_pos = device->read_pos + CODEC_PCM_SLOT_SIZE;
+        if (device->write_pos >= device->size)
+            device->write_pos = 0;
+        device->fill = CODEC_PCM_SLOT_SIZE;
+    }
 
-    /* notify transmitted complete. */
-    if (codec.parent.tx_complete != RT_NULL)
+    /* set the next slot to the idle memory of DMA */
+    armed = device->read_pos + CODEC_PCM_SLOT_SIZE;
+    if (armed >= device->size)
+        armed = 0;
+    if (DMA_GetCurrentMemoryTarget(AUDIO_I2S_DMA_STREAM) == 0)
+        DMA_MemoryTargetConfig(AUDIO_I2S_DMA_STREAM, (uint32_t)(device->ring + armed), DMA_Memory_1);
+    else
+        DMA_MemoryTargetConfig(AUDIO_I2S_DMA_STREAM, (uint32_t)(device->ring + armed), DMA_Memory_0);
+
+    /* wake up the writer */
+    if (device->waiting == RT_TRUE)
     {
-        codec.parent.tx_complete(&codec.parent, data_ptr);
+        device->waiting = RT_FALSE;
+        rt_sem_release(&device->tx_sem);
     }
 
     /* leave interrupt */
@@ -675,3 +859,17 @@ void DMA1_Stream7_IRQHandler(void)
         codec_dma_isr();
     }
 }
+
+#ifdef RT_USING_FINSH
+void list_snd(void)
+{
+    struct codec_pcm_stat stat;
+
+    codec_control(&codec.parent, CODEC_CMD_PCM_STAT, &stat);
+    rt_kprintf("slots: %d x %d bytes, %s\n", stat.slots, CODEC_PCM_SLOT_SIZE,
+               stat.running ? "running" : "stopped");
+    rt_kprintf("fill: %d, min: %d, average: %d\n", stat.fill, stat.fill_min, stat.fill_avg);
+    rt_kprintf("underruns: %d\n", stat.underruns);
+}
+FINSH_FUNCTION_EXPORT(list_snd, display the statistics of sound PCM ring);
+#endif
@@ -632,9 +632,38 @@
 #define CODEC_CMD_SAMPLERATE	2
 #define CODEC_CMD_EQ			3
 #define CODEC_CMD_3D			4
+#define CODEC_CMD_PCM_SLOTS		5	/* set the slots of PCM ring, before open */
+#define CODEC_CMD_PCM_RESERVE	6	/* get a write slot in PCM ring */
+#define CODEC_CMD_PCM_COMMIT	7	/* commit the bytes written in the slot */
+#define CODEC_CMD_PCM_STAT		8	/* get the statistics of PCM ring */
+#define CODEC_CMD_PCM_DRAIN		9	/* play out PCM ring and stop */
 
 #define CODEC_VOLUME_MAX		(63)
 
+/* PCM ring: the DMA plays one slot after another, a slot is one MPEG-1 frame */
+#define CODEC_PCM_SLOT_SIZE		(1152 * 2 * sizeof(rt_uint16_t))
+#define CODEC_PCM_SLOTS_MIN		4
+#define CODEC_PCM_SLOTS_DEFAULT	8
+
+/* args of CODEC_CMD_PCM_RESERVE and CODEC_CMD_PCM_COMMIT */
+struct codec_pcm_slot
+{
+    rt_uint16_t *data;
+    rt_size_t size;				/* in bytes */
+    rt_int32_t timeout;			/* ticks to wait for free space */
+};
+
+/* args of CODEC_CMD_PCM_STAT */
+struct codec_pcm_stat
+{
+    rt_uint16_t slots;
+    rt_uint16_t running;
+    rt_size_t fill;				/* bytes committed and not played */
+    rt_size_t fill_min;			/* the minimal fill when a slot is played */
+    rt_size_t fill_avg;
+    rt_uint32_t underruns;
+};
+
 struct codec_eq_args
 {
     uint8_t channel;
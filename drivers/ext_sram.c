@@ -1,6 +1,11 @@
 #include "rtthread.h"
 #include "board.h"
 
+#ifdef RTGUI_USING_WIN_BUFFER
+/* the back buffer of windows, at the end of external SRAM */
+struct rt_memheap ext_sram_win_buffer;
+#endif
+
 int ext_sram_init(void)
 {
     FSMC_NORSRAMInitTypeDef  FSMC_NORSRAMInitStructure;
@@ -65,6 +70,11 @@ int ext_sram_init(void)
     FSMC_NORSRAMInit(&FSMC_NORSRAMInitStructure);
     FSMC_NORSRAMCmd(FSMC_NORSRAMInitStructure.FSMC_Bank, ENABLE);
 
+#ifdef RTGUI_USING_WIN_BUFFER
+    rt_memheap_init(&ext_sram_win_buffer, "winbuf",
+                    (void*)STM32_EXT_SRAM_HEAP_END, STM32_EXT_SRAM_WIN_BUFFER_SIZE);
+#endif
+
 	return 0;
 }
 INIT_BOARD_EXPORT(ext_sram_init);
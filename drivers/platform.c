@@ -10,6 +10,36 @@
 #include "stm32f20x_40x_spi.h"
 #include "spi_flash_w25qxx.h"
 
+#if defined(RT_USING_DFS) && defined(RTGUI_USING_HZ_FLASH)
+#include <dfs_fs.h>
+
+/* the bytes of raw partition of Chinese fonts at the top of SPI flash */
+#define FONT_PARTITION_SIZE     (1024 * 1024)
+
+/*
+ * make room for the font partition on a flash formatted as a whole FAT: the
+ * FAT is formatted again below the partition and the files in it are lost.
+ */
+void font_partition_create(void)
+{
+    dfs_unmount("/");
+
+    if (w25qxx_raw_init("font0", FONT_PARTITION_SIZE, RT_TRUE) != RT_EOK ||
+            dfs_mkfs("elm", "flash0") != 0 ||
+            dfs_mount("flash0", "/", "elm", 0, 0) != 0)
+    {
+        rt_kprintf("create font partition failed\n");
+        return;
+    }
+
+    rt_kprintf("font partition is created, write fonts with hz_flash_update and reboot\n");
+}
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+FINSH_FUNCTION_EXPORT(font_partition_create, format flash0 to make room for font partition);
+#endif
+#endif
+
 /*
 SPI2_MOSI: PB15
 SPI2_MISO: PB14
@@ -127,6 +157,11 @@ void rt_platform_init(void)
 #ifdef RT_USING_SPI
 #ifdef RT_USING_DFS
     w25qxx_init("flash0", "spi20");
+#ifdef RTGUI_USING_HZ_FLASH
+    /* the top 1MB of flash is the raw partition of Chinese fonts, if the FAT
+     * doesn't span it. Otherwise run font_partition_create once */
+    w25qxx_raw_init("font0", FONT_PARTITION_SIZE, RT_FALSE);
+#endif /* RTGUI_USING_HZ_FLASH */
 #endif /* RT_USING_DFS */
 
 #ifdef RT_USING_RTGUI
@@ -40,6 +40,17 @@ rt_inline void _wait_lcd_ready(void)
     while(status & (1<<7)); // [7] 0-ready 1- busy
 }
 
+rt_inline void _wait_bte_ready(void)
+{
+    uint16_t status;
+    do
+    {
+        _wait_bus_ready();
+        status = LCD_CMD;
+    }
+    while(status & STSR_BTE_BUSY); // [6] 0-ready 1- busy
+}
+
 rt_inline void LCD_CmdWrite(uint8_t reg)
 {
     _wait_bus_ready();
@@ -292,6 +303,30 @@ static void _set_draw_radius_ellipse(uint32_t X, uint32_t Y)
     LCD_write_reg(ELL_B0, Y);
 }
 
+static void _set_bte_source(uint32_t X, uint32_t Y)
+{
+    LCD_write_reg(HSBE1, X>>8);
+    LCD_write_reg(HSBE0, X);
+    LCD_write_reg(VSBE1, (Y>>8) & 0x01); /* layer 1 */
+    LCD_write_reg(VSBE0, Y);
+}
+
+static void _set_bte_dest(uint32_t X, uint32_t Y)
+{
+    LCD_write_reg(HDBE1, X>>8);
+    LCD_write_reg(HDBE0, X);
+    LCD_write_reg(VDBE1, (Y>>8) & 0x01); /* layer 1 */
+    LCD_write_reg(VDBE0, Y);
+}
+
+static void _set_bte_size(uint32_t width, uint32_t height)
+{
+    LCD_write_reg(BEWR1, width>>8);
+    LCD_write_reg(BEWR0, width);
+    LCD_write_reg(BEHR1, height>>8);
+    LCD_write_reg(BEHR0, height);
+}
+
 static void _set_fore_color(uint16_t pixel)
 {
     /* REG 565 */
@@ -751,6 +786,60 @@ static void fill_ellipse(rtgui_color_t *c, int x, int y, int rx, int ry)
                   | DECR_DRAW3_FILL | DECR_DRAW4_ELLIPSE_CIRCLE_SQUARE);
 }
 
+/* move the pixels in (x1, y1) - (x2, y2) by (dx, dy) with BTE */
+static void copy_rect(int x1, int y1, int x2, int y2, int dx, int dy)
+{
+    rt_err_t result;
+    rt_uint32_t e;
+    uint8_t op;
+
+    if(ra8875_is_ready())
+    {
+        /* if RA8875 is ready, clear ready flag. */
+        rt_event_recv(&ra8875_event,
+                      RA8875_EVENT_READY,
+                      RT_EVENT_FLAG_OR | RT_EVENT_FLAG_CLEAR,
+                      RT_WAITING_NO,
+                      &e);
+    }
+    else
+    {
+        /* if RA8875 is busy, wait it. */
+        result = rt_event_recv(&ra8875_event,
+                               RA8875_EVENT_READY,
+                               RT_EVENT_FLAG_OR | RT_EVENT_FLAG_CLEAR,
+                               2,
+                               &e);
+        if (result != RT_EOK)
+        {
+            return;
+        }
+    }
+
+    _set_bte_size(x2 - x1 + 1, y2 - y1 + 1);
+    if (dy > 0 || (dy == 0 && dx > 0))
+    {
+        /* the destination is after the source, move from the bottom right
+         * corner so that the overlapped source is read before written. */
+        _set_bte_source(x2, y2);
+        _set_bte_dest(x2 + dx, y2 + dy);
+        op = BECR1_BTE_MOVE_NEGATIVE;
+    }
+    else
+    {
+        _set_bte_source(x1, y1);
+        _set_bte_dest(x1 + dx, y1 + dy);
+        op = BECR1_BTE_MOVE_POSITIVE;
+    }
+
+    LCD_write_reg(BECR1, BECR1_ROP_SOURCE | op);
+    LCD_write_reg(BECR0, BECR0_BTE_ENABLE);
+
+    /* the exposed part is drawn right after scrolling, so wait the moving */
+    _wait_bte_ready();
+    rt_event_send(&ra8875_event, RA8875_EVENT_READY);
+}
+
 /* graphic extension operations */
 static const struct rtgui_graphic_ext_ops ra8875_ext_ops =
 {
@@ -764,6 +853,8 @@ static const struct rtgui_graphic_ext_ops ra8875_ext_ops =
 
     draw_ellipse,
     fill_ellipse,
+
+    copy_rect,
 };
 #endif /* USE_DRAW_FUNCTION */
 
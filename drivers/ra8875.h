@@ -29,6 +29,22 @@
 #define RCURV0          0x4C    /* Memory read Cursor Vertical Position Register 0 */
 #define RCURV1          0x4D    /* Memory read Cursor Vertical Position Register 1 */
 
+#define BECR0           0x50    /* BTE Function Control Register 0 */
+#define BECR1           0x51    /* BTE Function Control Register 1 */
+
+#define HSBE0           0x54    /* Horizontal Source Point 0 of BTE */
+#define HSBE1           0x55    /* Horizontal Source Point 1 of BTE */
+#define VSBE0           0x56    /* Vertical Source Point 0 of BTE */
+#define VSBE1           0x57    /* Vertical Source Point 1 of BTE */
+#define HDBE0           0x58    /* Horizontal Destination Point 0 of BTE */
+#define HDBE1           0x59    /* Horizontal Destination Point 1 of BTE */
+#define VDBE0           0x5A    /* Vertical Destination Point 0 of BTE */
+#define VDBE1           0x5B    /* Vertical Destination Point 1 of BTE */
+#define BEWR0           0x5C    /* BTE Width Register 0 */
+#define BEWR1           0x5D    /* BTE Width Register 1 */
+#define BEHR0           0x5E    /* BTE Height Register 0 */
+#define BEHR1           0x5F    /* BTE Height Register 1 */
+
 #define FGCR0           0x63    /* Foreground Color Register 0 : red */
 #define FGCR1           0x64    /* Foreground Color Register 1 : green */
 #define FGCR2           0x65    /* Foreground Color Register 2 : blue */
@@ -98,6 +114,13 @@
 #define DECR_DRAW3_FILL                         (1<<6)
 #define DECR_DRAW4_ELLIPSE_CIRCLE_SQUARE        (1<<7)
 
+#define BECR0_BTE_ENABLE                        (1<<7)
+#define BECR1_BTE_MOVE_POSITIVE                 (0x02<<0)
+#define BECR1_BTE_MOVE_NEGATIVE                 (0x03<<0)
+#define BECR1_ROP_SOURCE                        (0x0C<<4)
+
+#define STSR_BTE_BUSY                           (1<<6)
+
 #define TEST            0x00    /*  */
 
 #endif // RA8875_H_INCLUDED
@@ -57,6 +57,11 @@
 
 static struct spi_flash_device  spi_flash_device;
 
+/* raw partition at the top of flash, which is not used by file system */
+static struct rt_device raw_device;
+static uint32_t raw_offset;
+static uint32_t raw_size;
+
 static void flash_lock(struct spi_flash_device * flash_device)
 {
     rt_mutex_take(&flash_device->lock, RT_WAITING_FOREVER);
@@ -356,3 +361,141 @@ rt_err_t w25qxx_init(const char * flash_device_name, const char * spi_device_nam
     return RT_EOK;
 }
 
+
+/* RT-Thread device interface of raw partition, the pos is in byte */
+static rt_size_t w25qxx_raw_read(rt_device_t dev,
+                                 rt_off_t pos,
+                                 void* buffer,
+                                 rt_size_t size)
+{
+    if (pos >= raw_size) return 0;
+    if (size > raw_size - pos) size = raw_size - pos;
+
+    flash_lock(&spi_flash_device);
+
+    w25qxx_read(raw_offset + pos, buffer, size);
+
+    flash_unlock(&spi_flash_device);
+
+    return size;
+}
+
+/* the pos and size should be aligned to sector */
+static rt_size_t w25qxx_raw_write(rt_device_t dev,
+                                  rt_off_t pos,
+                                  const void* buffer,
+                                  rt_size_t size)
+{
+    uint32_t sector_size = spi_flash_device.geometry.bytes_per_sector;
+
+    if ((pos % sector_size) != 0 || (size % sector_size) != 0) return 0;
+    if (pos >= raw_size) return 0;
+    if (size > raw_size - pos) size = raw_size - pos;
+
+    flash_lock(&spi_flash_device);
+
+    w25qxx_page_write(raw_offset + pos, buffer, size);
+
+    flash_unlock(&spi_flash_device);
+
+    return size;
+}
+
+static rt_err_t w25qxx_raw_control(rt_device_t dev, rt_uint8_t cmd, void *args)
+{
+    RT_ASSERT(dev != RT_NULL);
+
+    if (cmd == RT_DEVICE_CTRL_BLK_GETGEOME)
+    {
+        struct rt_device_blk_geometry *geometry;
+
+        geometry = (struct rt_device_blk_geometry *)args;
+        if (geometry == RT_NULL) return -RT_ERROR;
+
+        geometry->bytes_per_sector = spi_flash_device.geometry.bytes_per_sector;
+        geometry->sector_count = raw_size / spi_flash_device.geometry.bytes_per_sector;
+        geometry->block_size = spi_flash_device.geometry.block_size;
+    }
+
+    return RT_EOK;
+}
+
+/* the total sectors in BPB of the FAT in sector 0, or 0 if there is no FAT */
+static uint32_t w25qxx_fat_sectors(void)
+{
+    uint8_t bpb[40], signature[2];
+    uint32_t sectors;
+
+    flash_lock(&spi_flash_device);
+    w25qxx_read(0, bpb, sizeof(bpb));
+    w25qxx_read(510, signature, sizeof(signature));
+    flash_unlock(&spi_flash_device);
+
+    /* a FAT formatted on this device, without partition table */
+    if (signature[0] != 0x55 || signature[1] != 0xAA) return 0;
+    if ((bpb[11] | (bpb[12] << 8)) != spi_flash_device.geometry.bytes_per_sector) return 0;
+
+    sectors = bpb[19] | (bpb[20] << 8);
+    if (sectors == 0)
+        sectors = bpb[32] | (bpb[33] << 8) | (bpb[34] << 16) | ((uint32_t)bpb[35] << 24);
+
+    return sectors;
+}
+
+/** \brief reserve the top [size] bytes of flash as a raw partition
+ *
+ * The raw partition is read in byte without file system, and the sectors
+ * of block device are reduced. It should be invoked after w25qxx_init and
+ * before the block device is mounted.
+ *
+ * A FAT formatted over the whole flash spans the partition, then it's not
+ * reserved and the FAT is kept, unless format is RT_TRUE. In that case the
+ * caller should format the block device, the files in it are lost.
+ *
+ * \param raw_device_name const char* name of the raw partition device
+ * \param size rt_uint32_t unit : byte, rounded up to sector
+ * \param format rt_bool_t reserve it even if the FAT spans it
+ * \return rt_err_t -RT_EBUSY if the FAT spans the partition
+ *
+ */
+rt_err_t w25qxx_raw_init(const char * raw_device_name, rt_uint32_t size, rt_bool_t format)
+{
+    uint32_t sector_size = spi_flash_device.geometry.bytes_per_sector;
+    uint32_t sectors;
+
+    if (spi_flash_device.rt_spi_device == RT_NULL || sector_size == 0)
+        return -RT_ENOSYS;
+    /* reserved already */
+    if (raw_size != 0) return RT_EOK;
+
+    sectors = (size + sector_size - 1) / sector_size;
+    if (sectors == 0 || sectors >= spi_flash_device.geometry.sector_count)
+        return -RT_ERROR;
+
+    if (format == RT_FALSE &&
+            w25qxx_fat_sectors() > spi_flash_device.geometry.sector_count - sectors)
+    {
+        FLASH_TRACE("the FAT spans raw partition %s, it's not reserved\r\n", raw_device_name);
+        return -RT_EBUSY;
+    }
+
+    spi_flash_device.geometry.sector_count -= sectors;
+    raw_offset = spi_flash_device.geometry.sector_count * sector_size;
+    raw_size = sectors * sector_size;
+
+    FLASH_TRACE("raw partition %s: 0x%08X, %d bytes\r\n", raw_device_name, raw_offset, raw_size);
+
+    /* register device */
+    raw_device.type    = RT_Device_Class_Char;
+    raw_device.init    = RT_NULL;
+    raw_device.open    = RT_NULL;
+    raw_device.close   = RT_NULL;
+    raw_device.read    = w25qxx_raw_read;
+    raw_device.write   = w25qxx_raw_write;
+    raw_device.control = w25qxx_raw_control;
+    /* no private */
+    raw_device.user_data = RT_NULL;
+
+    /* shared by the fonts, so it's not a stand alone device */
+    return rt_device_register(&raw_device, raw_device_name, RT_DEVICE_FLAG_RDWR);
+}
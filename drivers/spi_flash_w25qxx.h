@@ -30,5 +30,10 @@ struct spi_flash_device
 extern rt_err_t w25qxx_init(const char * flash_device_name,
                             const char * spi_device_name);
 
+/* reserve the top [size] bytes of flash as a byte addressed raw partition */
+extern rt_err_t w25qxx_raw_init(const char * raw_device_name,
+                                rt_uint32_t size,
+                                rt_bool_t format);
+
 
 #endif // SPI_FLASH_W25QXX_H_INCLUDED
@@ -194,6 +194,8 @@
 #define RTGUI_USING_HZ_FILE
 // <bool name="RTGUI_USING_HZ_BMP" description="Using Chinese bitmap font" default="false" />
 //#define RTGUI_USING_HZ_BMP
+// <bool name="RTGUI_USING_HZ_FLASH" description="Using Chinese font in raw partition of SPI flash" default="false" />
+//#define RTGUI_USING_HZ_FLASH
 // <bool name="RTGUI_USING_SMALL_SIZE" description="Using small size in RTGUI" default="false" />
 // #define RTGUI_USING_SMALL_SIZE
 // <bool name="RTGUI_USING_MOUSE_CURSOR" description="Using mouse cursor in RTGUI" default="false" />
@@ -208,6 +210,11 @@
 #define RTGUI_IMAGE_BMP
 // <bool name="RTGUI_USING_NOTEBOOK_IMAGE" description="Using notebook image in RTGUI" default="true" />
 #define RTGUI_USING_NOTEBOOK_IMAGE
+// <bool name="RTGUI_IMAGE_CONTAINER" description="Using image container to cache decoded images" default="false" />
+#define RTGUI_IMAGE_CONTAINER
+// <bool name="RTGUI_USING_WIN_BUFFER" description="Using back buffer of window, from the memheap RTGUI_WIN_BUFFER_MEMHEAP" default="false" />
+#define RTGUI_USING_WIN_BUFFER
+#define RTGUI_WIN_BUFFER_MEMHEAP	ext_sram_win_buffer
 // <bool name="RTGUI_USING_HW_CURSOR" description="Using hardware cursor in RTGUI" default="true" />
 #define RTGUI_USING_HW_CURSOR
 // </section>